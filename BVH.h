@@ -0,0 +1,1227 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "LMath_Core.h"
+#include "Utility.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Collision.h"
+#include "Parallel.h"
+#include "Ray.h"
+
+#include "SIMD_Core.h"
+
+namespace math
+{
+	inline constexpr unsigned int BVH_INVALID_INDEX = static_cast<unsigned int>(-1);
+
+	/// <summary>
+	/// Max primitive count of leaf
+	/// </summary>
+	inline constexpr unsigned int BVH_MAX_LEAF_PRIMITIVE_COUNT = 4;
+
+	/// <summary>
+	/// Bin count of binned SAH
+	/// </summary>
+	inline constexpr unsigned int BVH_BIN_COUNT = 16;
+
+	/// <summary>
+	/// After this depth, primitives are split at median to keep tree depth bounded
+	/// </summary>
+	inline constexpr unsigned int BVH_MAX_SAH_DEPTH = 32;
+
+	inline constexpr unsigned int BVH_TRAVERSAL_STACK_SIZE = 256;
+
+	/// <summary>
+	/// Relative costs used for SAH cost of tree
+	/// </summary>
+	inline constexpr float BVH_TRAVERSAL_COST = 1.0f;
+	inline constexpr float BVH_INTERSECTION_COST = 1.0f;
+
+	/// <summary>
+	/// Refit rebuilds tree when SAH cost becomes larger than SAH cost at build * this ratio
+	/// </summary>
+	inline constexpr float BVH_DEFAULT_REBUILD_SAH_RATIO = 1.5f;
+
+	/// <summary>
+	/// 4 wide BVH node ( QBVH )
+	/// Bounds of 4 children are stored as SoA, so 4 children are tested with one SIMD operation
+	///
+	/// child[i] is index of child node when primitiveCount[i] is 0,
+	/// otherwise child i is leaf and child[i] is first index of BVH primitive indices
+	/// Only child 0 ~ childCount - 1 are valid
+	/// </summary>
+	struct alignas(16) BVHNode
+	{
+		float minX[4];
+		float minY[4];
+		float minZ[4];
+		float maxX[4];
+		float maxY[4];
+		float maxZ[4];
+		unsigned int child[4];
+		unsigned int primitiveCount[4];
+		unsigned int childCount;
+
+		[[nodiscard]] FORCE_INLINE bool IsLeaf(unsigned int childIndex) const noexcept
+		{
+			return primitiveCount[childIndex] > 0;
+		}
+
+		[[nodiscard]] FORCE_INLINE unsigned int GetValidChildMask() const noexcept
+		{
+			return (1u << childCount) - 1;
+		}
+
+		[[nodiscard]] FORCE_INLINE AABB GetChildBounds(unsigned int childIndex) const noexcept
+		{
+			return AABB{ math::Vector<3, float>{ minX[childIndex], minY[childIndex], minZ[childIndex] }, math::Vector<3, float>{ maxX[childIndex], maxY[childIndex], maxZ[childIndex] } };
+		}
+
+		FORCE_INLINE void SetChildBounds(unsigned int childIndex, const AABB& bounds) noexcept
+		{
+			minX[childIndex] = bounds.minimum.x;
+			minY[childIndex] = bounds.minimum.y;
+			minZ[childIndex] = bounds.minimum.z;
+			maxX[childIndex] = bounds.maximum.x;
+			maxY[childIndex] = bounds.maximum.y;
+			maxZ[childIndex] = bounds.maximum.z;
+		}
+	};
+
+	/// <summary>
+	/// Bounding volume hierarchy of AABBs
+	///
+	/// Built with binned SAH. Each node has up to 4 children ( QBVH ),
+	/// made by splitting primitives of node twice
+	/// Top of tree is built on calling thread and large subtrees are built in parallel
+	///
+	/// For moving primitives, Refit recomputes only bounds of dirty nodes and optionally rotates them.
+	/// When SAH cost drifts too much from SAH cost at build, tree is rebuilt
+	///
+	/// Queries write index of primitive passed to Build
+	///
+	/// references :
+	/// On fast Construction of SAH-based Bounding Volume Hierarchies, Ingo Wald
+	/// Shallow Bounding Volume Hierarchies for Fast SIMD Ray Tracing of Incoherent Rays, Dammertz et al.
+	/// Fast, Effective BVH Updates for Animated Scenes, Kopta et al.
+	/// </summary>
+	class BVH
+	{
+	public:
+
+		BVH() = default;
+
+		void Build(const AABB* primitiveBounds, size_t primitiveCount, unsigned int threadCount = 1)
+		{
+			mPrimitiveBounds.assign(primitiveBounds, primitiveBounds + primitiveCount);
+			BuildTree(threadCount);
+		}
+
+		/// <summary>
+		/// Update bounds of every primitive and refit tree
+		/// Only nodes containing changed primitives are recomputed
+		/// </summary>
+		/// <param name="primitiveBounds">bounds of every primitive. primitiveCount should be same with Build</param>
+		/// <param name="rotate">apply tree rotations to dirty nodes to limit quality decay</param>
+		/// <returns>true if tree is rebuilt because SAH cost drifted</returns>
+		bool Refit(const AABB* primitiveBounds, size_t primitiveCount, bool rotate = true)
+		{
+			assert(primitiveCount == mPrimitiveBounds.size());
+
+			for (size_t primitiveIndex = 0; primitiveIndex < primitiveCount; ++primitiveIndex)
+			{
+				const AABB& bounds = primitiveBounds[primitiveIndex];
+				const AABB& oldBounds = mPrimitiveBounds[primitiveIndex];
+				if (
+					bounds.minimum.x != oldBounds.minimum.x || bounds.minimum.y != oldBounds.minimum.y || bounds.minimum.z != oldBounds.minimum.z ||
+					bounds.maximum.x != oldBounds.maximum.x || bounds.maximum.y != oldBounds.maximum.y || bounds.maximum.z != oldBounds.maximum.z
+					)
+				{
+					UpdatePrimitiveBounds(static_cast<unsigned int>(primitiveIndex), bounds);
+				}
+			}
+
+			return Refit(rotate);
+		}
+
+		/// <summary>
+		/// Update bounds of a primitive. Tree isn't changed until Refit is called
+		/// </summary>
+		void UpdatePrimitiveBounds(unsigned int primitiveIndex, const AABB& bounds)
+		{
+			mPrimitiveBounds[primitiveIndex] = bounds;
+
+			// mark leaf node and its ancestors dirty
+			unsigned int nodeIndex = mPrimitiveLeafNodeIndices[primitiveIndex];
+			while (nodeIndex != BVH_INVALID_INDEX && mNodeDirtyFlags[nodeIndex] == 0)
+			{
+				mNodeDirtyFlags[nodeIndex] = 1;
+				nodeIndex = mNodeLinks[nodeIndex].parentNodeIndex;
+			}
+		}
+
+		/// <summary>
+		/// Recompute bounds of dirty nodes bottom up
+		/// After refit, full rebuild is done when SAH cost of tree is larger than SAH cost at build * rebuild SAH ratio
+		/// </summary>
+		/// <param name="rotate">apply tree rotations to dirty nodes to limit quality decay</param>
+		/// <returns>true if tree is rebuilt</returns>
+		bool Refit(bool rotate = true)
+		{
+			if (mNodes.empty() == true || mNodeDirtyFlags[0] == 0)
+			{
+				return false;
+			}
+
+			RefitNode(0, rotate);
+
+			if (GetSAHCost() > mBuildSAHCost * mRebuildSAHRatio)
+			{
+				BuildTree(mBuildThreadCount);
+				return true;
+			}
+			return false;
+		}
+
+		/// <summary>
+		/// Refit rebuilds tree when SAH cost becomes larger than SAH cost at build * ratio
+		/// </summary>
+		FORCE_INLINE void SetRebuildSAHRatio(float ratio) noexcept
+		{
+			mRebuildSAHRatio = ratio;
+		}
+
+		[[nodiscard]] FORCE_INLINE float GetRebuildSAHRatio() const noexcept
+		{
+			return mRebuildSAHRatio;
+		}
+
+		/// <summary>
+		/// SAH cost of tree at last build
+		/// </summary>
+		[[nodiscard]] FORCE_INLINE float GetBuildSAHCost() const noexcept
+		{
+			return mBuildSAHCost;
+		}
+
+		/// <summary>
+		/// Expected cost of a query with random ray
+		/// Sum of surface area of each child weighted by traversal or intersection cost, divided by surface area of root
+		/// </summary>
+		[[nodiscard]] float GetSAHCost() const noexcept
+		{
+			if (mNodes.empty() == true)
+			{
+				return 0.0f;
+			}
+
+			const float rootSurfaceArea = GetBounds().surfaceArea();
+			if (rootSurfaceArea <= 0.0f)
+			{
+				return BVH_TRAVERSAL_COST;
+			}
+
+			float cost = 0.0f;
+			for (const BVHNode& node : mNodes)
+			{
+				for (unsigned int childIndex = 0; childIndex < node.childCount; ++childIndex)
+				{
+					const float childCost = (node.IsLeaf(childIndex) == true) ? BVH_INTERSECTION_COST * node.primitiveCount[childIndex] : BVH_TRAVERSAL_COST;
+					cost += node.GetChildBounds(childIndex).surfaceArea() * childCost;
+				}
+			}
+			return BVH_TRAVERSAL_COST + cost / rootSurfaceArea;
+		}
+
+		[[nodiscard]] FORCE_INLINE bool IsEmpty() const noexcept
+		{
+			return mNodes.empty();
+		}
+
+		[[nodiscard]] FORCE_INLINE const std::vector<BVHNode>& GetNodes() const noexcept
+		{
+			return mNodes;
+		}
+
+		[[nodiscard]] FORCE_INLINE const std::vector<unsigned int>& GetPrimitiveIndices() const noexcept
+		{
+			return mPrimitiveIndices;
+		}
+
+		[[nodiscard]] FORCE_INLINE const AABB& GetPrimitiveBounds(unsigned int primitiveIndex) const noexcept
+		{
+			return mPrimitiveBounds[primitiveIndex];
+		}
+
+		/// <summary>
+		/// Bounds of every primitives
+		/// </summary>
+		[[nodiscard]] AABB GetBounds() const noexcept
+		{
+			AABB bounds{ math::Vector<3, float>{ math::infinity<float>() }, math::Vector<3, float>{ math::negativeInfinity<float>() } };
+			if (mNodes.empty() == false)
+			{
+				for (unsigned int childIndex = 0; childIndex < mNodes[0].childCount; ++childIndex)
+				{
+					bounds.Merge(mNodes[0].GetChildBounds(childIndex));
+				}
+			}
+			return bounds;
+		}
+
+		/// <summary>
+		/// Find primitives overlapped with aabb
+		/// </summary>
+		/// <returns>count of found primitives. When it's larger than maxPrimitiveCount, only maxPrimitiveCount indices are written</returns>
+		size_t QueryAABB(const AABB& aabb, unsigned int* outPrimitiveIndices, size_t maxPrimitiveCount) const
+		{
+			size_t primitiveCount = 0;
+			Traverse(
+				[&](const BVHNode& node) { return TestChildrenWithAABB(node, aabb); },
+				[&](unsigned int primitiveIndex)
+				{
+					if (math::IsAABBOverlap(mPrimitiveBounds[primitiveIndex], aabb))
+					{
+						PushPrimitiveIndex(outPrimitiveIndices, maxPrimitiveCount, primitiveCount, primitiveIndex);
+					}
+				});
+			return primitiveCount;
+		}
+
+		/// <summary>
+		/// Find primitives overlapped with sphere
+		/// </summary>
+		/// <returns>count of found primitives. When it's larger than maxPrimitiveCount, only maxPrimitiveCount indices are written</returns>
+		size_t QuerySphere(const math::Vector<3, float>& center, float radius, unsigned int* outPrimitiveIndices, size_t maxPrimitiveCount) const
+		{
+			size_t primitiveCount = 0;
+			Traverse(
+				[&](const BVHNode& node) { return TestChildrenWithSphere(node, center, radius); },
+				[&](unsigned int primitiveIndex)
+				{
+					if (IsAABBOverlapWithSphere(mPrimitiveBounds[primitiveIndex], center, radius))
+					{
+						PushPrimitiveIndex(outPrimitiveIndices, maxPrimitiveCount, primitiveCount, primitiveIndex);
+					}
+				});
+			return primitiveCount;
+		}
+
+		/// <summary>
+		/// Find primitives inside of or intersecting frustum
+		/// </summary>
+		/// <param name="eightPlanes">planes from ExtractSIMDPlanesFromViewProjectionMatrix</param>
+		/// <returns>count of found primitives. When it's larger than maxPrimitiveCount, only maxPrimitiveCount indices are written</returns>
+		size_t QueryFrustum(const math::Vector<4, float>* eightPlanes, unsigned int* outPrimitiveIndices, size_t maxPrimitiveCount) const
+		{
+			math::Vector<4, float> sixPlanes[6];
+			for (unsigned int planeIndex = 0; planeIndex < 4; ++planeIndex)
+			{
+				sixPlanes[planeIndex] = math::Vector<4, float>{ eightPlanes[0][planeIndex], eightPlanes[1][planeIndex], eightPlanes[2][planeIndex], eightPlanes[3][planeIndex] };
+			}
+			for (unsigned int planeIndex = 4; planeIndex < 6; ++planeIndex)
+			{
+				sixPlanes[planeIndex] = math::Vector<4, float>{ eightPlanes[4][planeIndex - 4], eightPlanes[5][planeIndex - 4], eightPlanes[6][planeIndex - 4], eightPlanes[7][planeIndex - 4] };
+			}
+
+			size_t primitiveCount = 0;
+			Traverse(
+				[&](const BVHNode& node) { return TestChildrenWithFrustum(node, sixPlanes); },
+				[&](unsigned int primitiveIndex)
+				{
+					if (IsAABBInFrustum(mPrimitiveBounds[primitiveIndex], sixPlanes))
+					{
+						PushPrimitiveIndex(outPrimitiveIndices, maxPrimitiveCount, primitiveCount, primitiveIndex);
+					}
+				});
+			return primitiveCount;
+		}
+
+		/// <summary>
+		/// Find primitives whose AABB is hit by ray
+		/// </summary>
+		/// <param name="direction">doesn't need to be normalized. Hit distance is measured in length of direction</param>
+		/// <returns>count of found primitives. When it's larger than maxPrimitiveCount, only maxPrimitiveCount indices are written</returns>
+		size_t QueryRay(const math::Vector<3, float>& origin, const math::Vector<3, float>& direction, float maxDistance, unsigned int* outPrimitiveIndices, size_t maxPrimitiveCount) const
+		{
+			return QueryRay(Ray{ origin, direction }, maxDistance, outPrimitiveIndices, maxPrimitiveCount);
+		}
+
+		/// <summary>
+		/// Find primitives whose AABB is hit by ray
+		/// </summary>
+		/// <returns>count of found primitives. When it's larger than maxPrimitiveCount, only maxPrimitiveCount indices are written</returns>
+		size_t QueryRay(const Ray& ray, float maxDistance, unsigned int* outPrimitiveIndices, size_t maxPrimitiveCount) const
+		{
+			size_t primitiveCount = 0;
+			Traverse(
+				[&](const BVHNode& node) { return TestChildrenWithRay(node, ray, maxDistance); },
+				[&](unsigned int primitiveIndex)
+				{
+					if (IsRayHitAABB(ray, maxDistance, mPrimitiveBounds[primitiveIndex]) == true)
+					{
+						PushPrimitiveIndex(outPrimitiveIndices, maxPrimitiveCount, primitiveCount, primitiveIndex);
+					}
+				});
+			return primitiveCount;
+		}
+
+		/// <summary>
+		/// Find primitive whose AABB entry point is closest to ray origin
+		/// Search range shrinks to closest hit so far
+		/// </summary>
+		/// <returns>index of closest primitive. BVH_INVALID_INDEX if no primitive is hit</returns>
+		unsigned int QueryClosestRay(const Ray& ray, float maxDistance, float* outDistance = nullptr) const
+		{
+			float closestDistance = maxDistance;
+			unsigned int closestPrimitiveIndex = BVH_INVALID_INDEX;
+			Traverse(
+				[&](const BVHNode& node) { return TestChildrenWithRay(node, ray, closestDistance); },
+				[&](unsigned int primitiveIndex)
+				{
+					float distance;
+					if (IsRayHitAABB(ray, closestDistance, mPrimitiveBounds[primitiveIndex], &distance) == true && (closestPrimitiveIndex == BVH_INVALID_INDEX || distance < closestDistance))
+					{
+						closestDistance = distance;
+						closestPrimitiveIndex = primitiveIndex;
+					}
+				});
+
+			if (outDistance != nullptr && closestPrimitiveIndex != BVH_INVALID_INDEX)
+			{
+				*outDistance = closestDistance;
+			}
+			return closestPrimitiveIndex;
+		}
+
+		/// <summary>
+		/// Traverse tree with 8 coherent rays together
+		/// A node is visited once if any ray of packet hits it, and its children are tested with only those rays
+		/// </summary>
+		/// <param name="outPairs">indexA is lane of ray in packet, indexB is index of primitive</param>
+		/// <returns>count of found pairs. When it's larger than maxPairCount, only maxPairCount pairs are written</returns>
+		size_t QueryRayPacket(const RayPacket8& rayPacket, OverlapPair* outPairs, size_t maxPairCount) const
+		{
+			size_t pairCount = 0;
+			TraverseRayPacket(rayPacket, [&](unsigned int primitiveIndex, unsigned int rayMask)
+			{
+				rayMask &= TestRayPacketWithAABB(rayPacket, mPrimitiveBounds[primitiveIndex]);
+				while (rayMask != 0)
+				{
+					const unsigned int lane = math::countTrailingZero(rayMask);
+					rayMask &= rayMask - 1;
+					detail::PushOverlapPair(outPairs, maxPairCount, pairCount, lane, primitiveIndex);
+				}
+			});
+			return pairCount;
+		}
+
+		/// <summary>
+		/// Depth first traversal with ray packet
+		/// </summary>
+		/// <param name="visitPrimitive">void(unsigned int primitiveIndex, unsigned int rayMask). rayMask is bit mask of rays hitting leaf containing primitive</param>
+		template <typename VisitPrimitiveFunction>
+		void TraverseRayPacket(const RayPacket8& rayPacket, const VisitPrimitiveFunction& visitPrimitive) const
+		{
+			const unsigned int activeRayMask = rayPacket.GetActiveMask();
+			if (mNodes.empty() == true || activeRayMask == 0)
+			{
+				return;
+			}
+
+			unsigned int nodeStack[BVH_TRAVERSAL_STACK_SIZE];
+			unsigned int rayMaskStack[BVH_TRAVERSAL_STACK_SIZE];
+			unsigned int stackSize = 0;
+			nodeStack[stackSize] = 0;
+			rayMaskStack[stackSize++] = activeRayMask;
+
+			while (stackSize > 0)
+			{
+				--stackSize;
+				const BVHNode& node = mNodes[nodeStack[stackSize]];
+				const unsigned int nodeRayMask = rayMaskStack[stackSize];
+
+				for (unsigned int childIndex = 0; childIndex < node.childCount; ++childIndex)
+				{
+					const unsigned int childRayMask = TestRayPacketWithAABB(rayPacket, node.GetChildBounds(childIndex)) & nodeRayMask;
+					if (childRayMask == 0)
+					{
+						continue;
+					}
+
+					if (node.IsLeaf(childIndex) == true)
+					{
+						const unsigned int primitiveEnd = node.child[childIndex] + node.primitiveCount[childIndex];
+						for (unsigned int i = node.child[childIndex]; i < primitiveEnd; ++i)
+						{
+							visitPrimitive(mPrimitiveIndices[i], childRayMask);
+						}
+					}
+					else
+					{
+						assert(stackSize < BVH_TRAVERSAL_STACK_SIZE);
+						nodeStack[stackSize] = node.child[childIndex];
+						rayMaskStack[stackSize++] = childRayMask;
+					}
+				}
+			}
+		}
+
+		/// <summary>
+		/// Depth first traversal
+		/// </summary>
+		/// <param name="testChildren">unsigned int(const BVHNode&). return bit mask of children to visit</param>
+		/// <param name="visitPrimitive">void(unsigned int primitiveIndex)</param>
+		template <typename TestChildrenFunction, typename VisitPrimitiveFunction>
+		void Traverse(const TestChildrenFunction& testChildren, const VisitPrimitiveFunction& visitPrimitive) const
+		{
+			if (mNodes.empty() == true)
+			{
+				return;
+			}
+
+			unsigned int stack[BVH_TRAVERSAL_STACK_SIZE];
+			unsigned int stackSize = 0;
+			stack[stackSize++] = 0;
+
+			while (stackSize > 0)
+			{
+				const BVHNode& node = mNodes[stack[--stackSize]];
+
+				unsigned int childMask = testChildren(node) & node.GetValidChildMask();
+				while (childMask != 0)
+				{
+					const unsigned int childIndex = math::countTrailingZero(childMask);
+					childMask &= childMask - 1;
+
+					if (node.IsLeaf(childIndex) == true)
+					{
+						const unsigned int primitiveEnd = node.child[childIndex] + node.primitiveCount[childIndex];
+						for (unsigned int i = node.child[childIndex]; i < primitiveEnd; ++i)
+						{
+							visitPrimitive(mPrimitiveIndices[i]);
+						}
+					}
+					else
+					{
+						assert(stackSize < BVH_TRAVERSAL_STACK_SIZE);
+						stack[stackSize++] = node.child[childIndex];
+					}
+				}
+			}
+		}
+
+		/// <returns>bit mask of children overlapped with aabb</returns>
+		[[nodiscard]] static unsigned int TestChildrenWithAABB(const BVHNode& node, const AABB& aabb) noexcept
+		{
+#ifdef SIMD_ENABLED
+			M128F isOverlap = _mm_cmple_ps(_mm_load_ps(node.minX), _mm_set1_ps(aabb.maximum.x));
+			isOverlap = _mm_and_ps(isOverlap, _mm_cmple_ps(_mm_load_ps(node.minY), _mm_set1_ps(aabb.maximum.y)));
+			isOverlap = _mm_and_ps(isOverlap, _mm_cmple_ps(_mm_load_ps(node.minZ), _mm_set1_ps(aabb.maximum.z)));
+			isOverlap = _mm_and_ps(isOverlap, _mm_cmpge_ps(_mm_load_ps(node.maxX), _mm_set1_ps(aabb.minimum.x)));
+			isOverlap = _mm_and_ps(isOverlap, _mm_cmpge_ps(_mm_load_ps(node.maxY), _mm_set1_ps(aabb.minimum.y)));
+			isOverlap = _mm_and_ps(isOverlap, _mm_cmpge_ps(_mm_load_ps(node.maxZ), _mm_set1_ps(aabb.minimum.z)));
+			return static_cast<unsigned int>(_mm_movemask_ps(isOverlap));
+#else
+			unsigned int mask = 0;
+			for (unsigned int childIndex = 0; childIndex < 4; ++childIndex)
+			{
+				if (math::IsAABBOverlap(node.GetChildBounds(childIndex), aabb))
+				{
+					mask |= 1u << childIndex;
+				}
+			}
+			return mask;
+#endif
+		}
+
+		/// <returns>bit mask of children overlapped with sphere</returns>
+		[[nodiscard]] static unsigned int TestChildrenWithSphere(const BVHNode& node, const math::Vector<3, float>& center, float radius) noexcept
+		{
+#ifdef SIMD_ENABLED
+			const M128F centerX = _mm_set1_ps(center.x);
+			const M128F centerY = _mm_set1_ps(center.y);
+			const M128F centerZ = _mm_set1_ps(center.z);
+
+			// distance from center to closest point of box
+			const M128F dx = _mm_max_ps(_mm_max_ps(M128F_SUB(_mm_load_ps(node.minX), centerX), M128F_SUB(centerX, _mm_load_ps(node.maxX))), M128F_Zero);
+			const M128F dy = _mm_max_ps(_mm_max_ps(M128F_SUB(_mm_load_ps(node.minY), centerY), M128F_SUB(centerY, _mm_load_ps(node.maxY))), M128F_Zero);
+			const M128F dz = _mm_max_ps(_mm_max_ps(M128F_SUB(_mm_load_ps(node.minZ), centerZ), M128F_SUB(centerZ, _mm_load_ps(node.maxZ))), M128F_Zero);
+
+			M128F sqrDistance = M128F_MUL(dx, dx);
+			sqrDistance = M128F_MUL_AND_ADD(dy, dy, sqrDistance);
+			sqrDistance = M128F_MUL_AND_ADD(dz, dz, sqrDistance);
+
+			return static_cast<unsigned int>(_mm_movemask_ps(_mm_cmple_ps(sqrDistance, _mm_set1_ps(radius * radius))));
+#else
+			unsigned int mask = 0;
+			for (unsigned int childIndex = 0; childIndex < 4; ++childIndex)
+			{
+				if (IsAABBOverlapWithSphere(node.GetChildBounds(childIndex), center, radius))
+				{
+					mask |= 1u << childIndex;
+				}
+			}
+			return mask;
+#endif
+		}
+
+		/// <summary>
+		/// Box is culled only when it's completely outside of a plane
+		/// Test positive vertex of box with each plane
+		/// </summary>
+		/// <param name="sixPlanes">x, y, z, w of each plane</param>
+		/// <returns>bit mask of children inside of or intersecting frustum</returns>
+		[[nodiscard]] static unsigned int TestChildrenWithFrustum(const BVHNode& node, const math::Vector<4, float>* sixPlanes) noexcept
+		{
+#ifdef SIMD_ENABLED
+			const M128F half = _mm_set1_ps(0.5f);
+			const M128F centerX = M128F_MUL(M128F_ADD(_mm_load_ps(node.minX), _mm_load_ps(node.maxX)), half);
+			const M128F centerY = M128F_MUL(M128F_ADD(_mm_load_ps(node.minY), _mm_load_ps(node.maxY)), half);
+			const M128F centerZ = M128F_MUL(M128F_ADD(_mm_load_ps(node.minZ), _mm_load_ps(node.maxZ)), half);
+			const M128F extentX = M128F_MUL(M128F_SUB(_mm_load_ps(node.maxX), _mm_load_ps(node.minX)), half);
+			const M128F extentY = M128F_MUL(M128F_SUB(_mm_load_ps(node.maxY), _mm_load_ps(node.minY)), half);
+			const M128F extentZ = M128F_MUL(M128F_SUB(_mm_load_ps(node.maxZ), _mm_load_ps(node.minZ)), half);
+
+			M128F isInside = M128F_EVERY_BITS_ONE;
+			for (unsigned int planeIndex = 0; planeIndex < 6; ++planeIndex)
+			{
+				const math::Vector<4, float>& plane = sixPlanes[planeIndex];
+
+				// dot(center, plane) + w + dot(extent, abs(plane))
+				M128F distance = M128F_MUL_AND_ADD(centerX, _mm_set1_ps(plane.x), _mm_set1_ps(plane.w));
+				distance = M128F_MUL_AND_ADD(centerY, _mm_set1_ps(plane.y), distance);
+				distance = M128F_MUL_AND_ADD(centerZ, _mm_set1_ps(plane.z), distance);
+				distance = M128F_MUL_AND_ADD(extentX, _mm_set1_ps(math::abs(plane.x)), distance);
+				distance = M128F_MUL_AND_ADD(extentY, _mm_set1_ps(math::abs(plane.y)), distance);
+				distance = M128F_MUL_AND_ADD(extentZ, _mm_set1_ps(math::abs(plane.z)), distance);
+
+				isInside = _mm_and_ps(isInside, _mm_cmpge_ps(distance, M128F_Zero));
+			}
+			return static_cast<unsigned int>(_mm_movemask_ps(isInside));
+#else
+			unsigned int mask = 0;
+			for (unsigned int childIndex = 0; childIndex < 4; ++childIndex)
+			{
+				if (IsAABBInFrustum(node.GetChildBounds(childIndex), sixPlanes))
+				{
+					mask |= 1u << childIndex;
+				}
+			}
+			return mask;
+#endif
+		}
+
+		/// <summary>
+		/// Slab test. Same with IsRayHitAABB of each child
+		/// </summary>
+		/// <returns>bit mask of children hit by ray</returns>
+		[[nodiscard]] static unsigned int TestChildrenWithRay(const BVHNode& node, const Ray& ray, float maxDistance) noexcept
+		{
+#ifdef SIMD_ENABLED
+			const M128F originX = _mm_set1_ps(ray.origin.x);
+			const M128F originY = _mm_set1_ps(ray.origin.y);
+			const M128F originZ = _mm_set1_ps(ray.origin.z);
+			const M128F inverseDirectionX = _mm_set1_ps(ray.inverseDirection.x);
+			const M128F inverseDirectionY = _mm_set1_ps(ray.inverseDirection.y);
+			const M128F inverseDirectionZ = _mm_set1_ps(ray.inverseDirection.z);
+
+			const M128F t1X = M128F_MUL(M128F_SUB(_mm_load_ps(node.minX), originX), inverseDirectionX);
+			const M128F t2X = M128F_MUL(M128F_SUB(_mm_load_ps(node.maxX), originX), inverseDirectionX);
+			const M128F t1Y = M128F_MUL(M128F_SUB(_mm_load_ps(node.minY), originY), inverseDirectionY);
+			const M128F t2Y = M128F_MUL(M128F_SUB(_mm_load_ps(node.maxY), originY), inverseDirectionY);
+			const M128F t1Z = M128F_MUL(M128F_SUB(_mm_load_ps(node.minZ), originZ), inverseDirectionZ);
+			const M128F t2Z = M128F_MUL(M128F_SUB(_mm_load_ps(node.maxZ), originZ), inverseDirectionZ);
+
+			M128F tMin = _mm_max_ps(_mm_min_ps(t1X, t2X), M128F_Zero);
+			tMin = _mm_max_ps(tMin, _mm_min_ps(t1Y, t2Y));
+			tMin = _mm_max_ps(tMin, _mm_min_ps(t1Z, t2Z));
+
+			M128F tMax = _mm_min_ps(_mm_max_ps(t1X, t2X), _mm_set1_ps(maxDistance));
+			tMax = _mm_min_ps(tMax, _mm_max_ps(t1Y, t2Y));
+			tMax = _mm_min_ps(tMax, _mm_max_ps(t1Z, t2Z));
+
+			return static_cast<unsigned int>(_mm_movemask_ps(_mm_cmple_ps(tMin, tMax)));
+#else
+			unsigned int mask = 0;
+			for (unsigned int childIndex = 0; childIndex < 4; ++childIndex)
+			{
+				if (IsRayHitAABB(ray, maxDistance, node.GetChildBounds(childIndex)) == true)
+				{
+					mask |= 1u << childIndex;
+				}
+			}
+			return mask;
+#endif
+		}
+
+		[[nodiscard]] static bool IsAABBOverlapWithSphere(const AABB& aabb, const math::Vector<3, float>& center, float radius) noexcept
+		{
+			const math::Vector<3, float> closestPoint = math::Min(math::Max(center, aabb.minimum), aabb.maximum);
+			return (closestPoint - center).sqrMagnitude() <= radius * radius;
+		}
+
+		[[nodiscard]] static bool IsAABBInFrustum(const AABB& aabb, const math::Vector<4, float>* sixPlanes) noexcept
+		{
+			const math::Vector<3, float> center = aabb.center();
+			const math::Vector<3, float> extents = aabb.extents();
+			for (unsigned int planeIndex = 0; planeIndex < 6; ++planeIndex)
+			{
+				const math::Vector<4, float>& plane = sixPlanes[planeIndex];
+				const float distance =
+					center.x * plane.x + center.y * plane.y + center.z * plane.z + plane.w +
+					extents.x * math::abs(plane.x) + extents.y * math::abs(plane.y) + extents.z * math::abs(plane.z);
+				if (distance < 0.0f)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+	private:
+
+		struct SubtreeBuildTask
+		{
+			unsigned int parentNodeIndex;
+			unsigned int childIndex;
+			unsigned int begin;
+			unsigned int end;
+			unsigned int depth;
+		};
+
+		struct NodeLink
+		{
+			unsigned int parentNodeIndex;
+
+			/// <summary>
+			/// Upper bound of height of subtree. Leaf child has height 0
+			/// </summary>
+			unsigned int height;
+		};
+
+		/// <summary>
+		/// Build tree from mPrimitiveBounds
+		/// </summary>
+		void BuildTree(unsigned int threadCount)
+		{
+			const size_t primitiveCount = mPrimitiveBounds.size();
+
+			mNodes.clear();
+			mBuildThreadCount = threadCount;
+			mPrimitiveCentroids.resize(primitiveCount);
+			mPrimitiveIndices.resize(primitiveCount);
+
+			for (size_t primitiveIndex = 0; primitiveIndex < primitiveCount; ++primitiveIndex)
+			{
+				mPrimitiveCentroids[primitiveIndex] = mPrimitiveBounds[primitiveIndex].center();
+				mPrimitiveIndices[primitiveIndex] = static_cast<unsigned int>(primitiveIndex);
+			}
+
+			if (primitiveCount > 0 && threadCount <= 1)
+			{
+				BuildNode(mNodes, 0, static_cast<unsigned int>(primitiveCount), 0, nullptr, 0);
+			}
+			else if (primitiveCount > 0)
+			{
+				// Build top of tree and defer large subtrees
+				std::vector<SubtreeBuildTask> subtreeBuildTasks;
+				const unsigned int deferPrimitiveCount = math::Max(static_cast<unsigned int>(primitiveCount / (threadCount * 4)), BVH_MAX_LEAF_PRIMITIVE_COUNT * 4);
+				BuildNode(mNodes, 0, static_cast<unsigned int>(primitiveCount), 0, &subtreeBuildTasks, deferPrimitiveCount);
+
+				// Subtrees own disjoint ranges of primitive indices, so they can be built in parallel
+				std::vector<std::vector<BVHNode>> subtreeNodes(subtreeBuildTasks.size());
+				math::ParallelFor(subtreeBuildTasks.size(), threadCount, [&](size_t begin, size_t end, unsigned int)
+				{
+					for (size_t taskIndex = begin; taskIndex < end; ++taskIndex)
+					{
+						const SubtreeBuildTask& task = subtreeBuildTasks[taskIndex];
+						BuildNode(subtreeNodes[taskIndex], task.begin, task.end, task.depth, nullptr, 0);
+					}
+				});
+
+				// Merge subtrees in task order
+				for (size_t taskIndex = 0; taskIndex < subtreeBuildTasks.size(); ++taskIndex)
+				{
+					const unsigned int nodeOffset = static_cast<unsigned int>(mNodes.size());
+					for (BVHNode& node : subtreeNodes[taskIndex])
+					{
+						for (unsigned int childIndex = 0; childIndex < node.childCount; ++childIndex)
+						{
+							if (node.IsLeaf(childIndex) == false)
+							{
+								node.child[childIndex] += nodeOffset;
+							}
+						}
+						mNodes.push_back(node);
+					}
+
+					const SubtreeBuildTask& task = subtreeBuildTasks[taskIndex];
+					mNodes[task.parentNodeIndex].child[task.childIndex] = nodeOffset;
+				}
+			}
+
+			BuildNodeLinks();
+			mBuildSAHCost = GetSAHCost();
+		}
+
+		/// <summary>
+		/// Compute parent, height of nodes and leaf node of primitives
+		/// Right after build, child node always has larger index than its parent
+		/// </summary>
+		void BuildNodeLinks()
+		{
+			mNodeLinks.resize(mNodes.size());
+			mNodeDirtyFlags.assign(mNodes.size(), 0);
+			mPrimitiveLeafNodeIndices.resize(mPrimitiveBounds.size());
+
+			if (mNodes.empty() == false)
+			{
+				mNodeLinks[0].parentNodeIndex = BVH_INVALID_INDEX;
+			}
+
+			for (size_t nodeIndex = mNodes.size(); nodeIndex-- > 0;)
+			{
+				const BVHNode& node = mNodes[nodeIndex];
+				unsigned int height = 0;
+				for (unsigned int childIndex = 0; childIndex < node.childCount; ++childIndex)
+				{
+					UpdateChildLink(static_cast<unsigned int>(nodeIndex), childIndex);
+					height = math::Max(height, GetChildHeight(node, childIndex));
+				}
+				mNodeLinks[nodeIndex].height = height + 1;
+			}
+		}
+
+		/// <summary>
+		/// Point child of node back to node
+		/// </summary>
+		void UpdateChildLink(unsigned int nodeIndex, unsigned int childIndex)
+		{
+			const BVHNode& node = mNodes[nodeIndex];
+			if (node.IsLeaf(childIndex) == true)
+			{
+				const unsigned int primitiveEnd = node.child[childIndex] + node.primitiveCount[childIndex];
+				for (unsigned int i = node.child[childIndex]; i < primitiveEnd; ++i)
+				{
+					mPrimitiveLeafNodeIndices[mPrimitiveIndices[i]] = nodeIndex;
+				}
+			}
+			else
+			{
+				mNodeLinks[node.child[childIndex]].parentNodeIndex = nodeIndex;
+			}
+		}
+
+		[[nodiscard]] FORCE_INLINE unsigned int GetChildHeight(const BVHNode& node, unsigned int childIndex) const noexcept
+		{
+			return (node.IsLeaf(childIndex) == true) ? 0 : mNodeLinks[node.child[childIndex]].height;
+		}
+
+		/// <summary>
+		/// Bounds of every children of node
+		/// Empty children have inverted bounds, so they don't affect min, max
+		/// </summary>
+		[[nodiscard]] static AABB ComputeNodeBounds(const BVHNode& node) noexcept
+		{
+#ifdef SIMD_ENABLED
+			// minX, minY in lane 0, 1 and minZ in lane 0
+			M128F minimumXY = _mm_min_ps(_mm_unpacklo_ps(_mm_load_ps(node.minX), _mm_load_ps(node.minY)), _mm_unpackhi_ps(_mm_load_ps(node.minX), _mm_load_ps(node.minY)));
+			minimumXY = _mm_min_ps(minimumXY, _mm_movehl_ps(minimumXY, minimumXY));
+			M128F minimumZ = _mm_min_ps(_mm_load_ps(node.minZ), _mm_movehl_ps(_mm_load_ps(node.minZ), _mm_load_ps(node.minZ)));
+			minimumZ = _mm_min_ps(minimumZ, M128F_REPLICATE(minimumZ, 1));
+
+			M128F maximumXY = _mm_max_ps(_mm_unpacklo_ps(_mm_load_ps(node.maxX), _mm_load_ps(node.maxY)), _mm_unpackhi_ps(_mm_load_ps(node.maxX), _mm_load_ps(node.maxY)));
+			maximumXY = _mm_max_ps(maximumXY, _mm_movehl_ps(maximumXY, maximumXY));
+			M128F maximumZ = _mm_max_ps(_mm_load_ps(node.maxZ), _mm_movehl_ps(_mm_load_ps(node.maxZ), _mm_load_ps(node.maxZ)));
+			maximumZ = _mm_max_ps(maximumZ, M128F_REPLICATE(maximumZ, 1));
+
+			return AABB
+			{
+				math::Vector<3, float>{ _mm_cvtss_f32(minimumXY), _mm_cvtss_f32(M128F_REPLICATE(minimumXY, 1)), _mm_cvtss_f32(minimumZ) },
+				math::Vector<3, float>{ _mm_cvtss_f32(maximumXY), _mm_cvtss_f32(M128F_REPLICATE(maximumXY, 1)), _mm_cvtss_f32(maximumZ) }
+			};
+#else
+			AABB bounds = node.GetChildBounds(0);
+			for (unsigned int childIndex = 1; childIndex < 4; ++childIndex)
+			{
+				bounds.Merge(node.GetChildBounds(childIndex));
+			}
+			return bounds;
+#endif
+		}
+
+		/// <summary>
+		/// Recompute bounds of children of dirty node in post order
+		/// </summary>
+		void RefitNode(unsigned int nodeIndex, bool rotate)
+		{
+			BVHNode& node = mNodes[nodeIndex];
+			for (unsigned int childIndex = 0; childIndex < node.childCount; ++childIndex)
+			{
+				if (node.IsLeaf(childIndex) == true)
+				{
+					node.SetChildBounds(childIndex, ComputeRangeBounds(node.child[childIndex], node.child[childIndex] + node.primitiveCount[childIndex]));
+				}
+				else if (mNodeDirtyFlags[node.child[childIndex]] != 0)
+				{
+					RefitNode(node.child[childIndex], rotate);
+					node.SetChildBounds(childIndex, ComputeNodeBounds(mNodes[node.child[childIndex]]));
+				}
+			}
+
+			if (rotate == true)
+			{
+				RotateNode(nodeIndex);
+			}
+
+			mNodeDirtyFlags[nodeIndex] = 0;
+		}
+
+		/// <summary>
+		/// Find swap between a child and a grandchild of node, which reduces surface area of the other child most
+		/// Bounds of node itself isn't changed by swap
+		///
+		/// Child is swapped only with grandchild of same or larger height,
+		/// so height of tree never grows and traversal stack is bounded
+		///
+		/// reference : Fast, Effective BVH Updates for Animated Scenes, Kopta et al.
+		/// </summary>
+		void RotateNode(unsigned int nodeIndex)
+		{
+			BVHNode& node = mNodes[nodeIndex];
+
+			float bestSurfaceAreaDelta = 0.0f;
+			unsigned int bestChildIndex = BVH_INVALID_INDEX;
+			unsigned int bestInnerChildIndex = 0;
+			unsigned int bestGrandchildIndex = 0;
+
+			for (unsigned int innerChildIndex = 0; innerChildIndex < node.childCount; ++innerChildIndex)
+			{
+				if (node.IsLeaf(innerChildIndex) == true)
+				{
+					continue;
+				}
+
+				const BVHNode& innerNode = mNodes[node.child[innerChildIndex]];
+				const float oldSurfaceArea = node.GetChildBounds(innerChildIndex).surfaceArea();
+
+				for (unsigned int grandchildIndex = 0; grandchildIndex < innerNode.childCount; ++grandchildIndex)
+				{
+					// bounds of inner node without the grandchild
+					AABB remainedBounds{ math::Vector<3, float>{ math::infinity<float>() }, math::Vector<3, float>{ math::negativeInfinity<float>() } };
+					for (unsigned int i = 0; i < innerNode.childCount; ++i)
+					{
+						if (i != grandchildIndex)
+						{
+							remainedBounds.Merge(innerNode.GetChildBounds(i));
+						}
+					}
+
+					for (unsigned int childIndex = 0; childIndex < node.childCount; ++childIndex)
+					{
+						if (childIndex == innerChildIndex || GetChildHeight(node, childIndex) > GetChildHeight(innerNode, grandchildIndex))
+						{
+							continue;
+						}
+
+						AABB newBounds = remainedBounds;
+						newBounds.Merge(node.GetChildBounds(childIndex));
+
+						const float surfaceAreaDelta = newBounds.surfaceArea() - oldSurfaceArea;
+						if (surfaceAreaDelta < bestSurfaceAreaDelta)
+						{
+							bestSurfaceAreaDelta = surfaceAreaDelta;
+							bestChildIndex = childIndex;
+							bestInnerChildIndex = innerChildIndex;
+							bestGrandchildIndex = grandchildIndex;
+						}
+					}
+				}
+			}
+
+			if (bestChildIndex == BVH_INVALID_INDEX)
+			{
+				return;
+			}
+
+			const unsigned int innerNodeIndex = node.child[bestInnerChildIndex];
+			BVHNode& innerNode = mNodes[innerNodeIndex];
+
+			const AABB childBounds = node.GetChildBounds(bestChildIndex);
+			node.SetChildBounds(bestChildIndex, innerNode.GetChildBounds(bestGrandchildIndex));
+			innerNode.SetChildBounds(bestGrandchildIndex, childBounds);
+			std::swap(node.child[bestChildIndex], innerNode.child[bestGrandchildIndex]);
+			std::swap(node.primitiveCount[bestChildIndex], innerNode.primitiveCount[bestGrandchildIndex]);
+
+			UpdateChildLink(nodeIndex, bestChildIndex);
+			UpdateChildLink(innerNodeIndex, bestGrandchildIndex);
+
+			node.SetChildBounds(bestInnerChildIndex, ComputeNodeBounds(innerNode));
+
+			unsigned int innerHeight = 0;
+			for (unsigned int i = 0; i < innerNode.childCount; ++i)
+			{
+				innerHeight = math::Max(innerHeight, GetChildHeight(innerNode, i));
+			}
+			mNodeLinks[innerNodeIndex].height = innerHeight + 1;
+		}
+
+		FORCE_INLINE static void PushPrimitiveIndex(unsigned int* outPrimitiveIndices, size_t maxPrimitiveCount, size_t& primitiveCount, unsigned int primitiveIndex) noexcept
+		{
+			if (primitiveCount < maxPrimitiveCount)
+			{
+				outPrimitiveIndices[primitiveCount] = primitiveIndex;
+			}
+			++primitiveCount;
+		}
+
+		[[nodiscard]] AABB ComputeRangeBounds(unsigned int begin, unsigned int end) const noexcept
+		{
+			AABB bounds = mPrimitiveBounds[mPrimitiveIndices[begin]];
+			for (unsigned int i = begin + 1; i < end; ++i)
+			{
+				bounds.Merge(mPrimitiveBounds[mPrimitiveIndices[i]]);
+			}
+			return bounds;
+		}
+
+		/// <summary>
+		/// Partition primitive indices of [begin, end) to two non empty ranges
+		/// </summary>
+		/// <returns>first index of second range</returns>
+		unsigned int SplitPrimitives(unsigned int begin, unsigned int end, unsigned int depth)
+		{
+			assert(end - begin >= 2);
+
+			AABB centroidBounds{ mPrimitiveCentroids[mPrimitiveIndices[begin]], mPrimitiveCentroids[mPrimitiveIndices[begin]] };
+			for (unsigned int i = begin + 1; i < end; ++i)
+			{
+				const math::Vector<3, float>& centroid = mPrimitiveCentroids[mPrimitiveIndices[i]];
+				centroidBounds.minimum = math::Min(centroidBounds.minimum, centroid);
+				centroidBounds.maximum = math::Max(centroidBounds.maximum, centroid);
+			}
+			const math::Vector<3, float> centroidExtents = centroidBounds.maximum - centroidBounds.minimum;
+
+			if (depth < BVH_MAX_SAH_DEPTH)
+			{
+				float bestCost = math::infinity<float>();
+				unsigned int bestAxis = 3;
+				unsigned int bestBin = 0;
+
+				for (unsigned int axis = 0; axis < 3; ++axis)
+				{
+					if (centroidExtents[axis] <= 0.0f)
+					{
+						continue;
+					}
+
+					AABB binBounds[BVH_BIN_COUNT];
+					unsigned int binPrimitiveCount[BVH_BIN_COUNT]{};
+
+					const float binScale = BVH_BIN_COUNT * (1.0f - math::epsilon<float>()) / centroidExtents[axis];
+					for (unsigned int i = begin; i < end; ++i)
+					{
+						const unsigned int primitiveIndex = mPrimitiveIndices[i];
+						const unsigned int bin = math::Min(static_cast<unsigned int>((mPrimitiveCentroids[primitiveIndex][axis] - centroidBounds.minimum[axis]) * binScale), BVH_BIN_COUNT - 1);
+						if (binPrimitiveCount[bin] == 0)
+						{
+							binBounds[bin] = mPrimitiveBounds[primitiveIndex];
+						}
+						else
+						{
+							binBounds[bin].Merge(mPrimitiveBounds[primitiveIndex]);
+						}
+						++binPrimitiveCount[bin];
+					}
+
+					// rightCost[i] : cost of bin i ~ BVH_BIN_COUNT - 1
+					float rightCost[BVH_BIN_COUNT];
+					{
+						AABB rightBounds;
+						unsigned int rightCount = 0;
+						for (unsigned int bin = BVH_BIN_COUNT - 1; bin > 0; --bin)
+						{
+							if (binPrimitiveCount[bin] > 0)
+							{
+								if (rightCount == 0)
+								{
+									rightBounds = binBounds[bin];
+								}
+								else
+								{
+									rightBounds.Merge(binBounds[bin]);
+								}
+								rightCount += binPrimitiveCount[bin];
+							}
+							rightCost[bin] = (rightCount > 0) ? rightBounds.surfaceArea() * rightCount : 0.0f;
+						}
+					}
+
+					AABB leftBounds;
+					unsigned int leftCount = 0;
+					for (unsigned int bin = 0; bin < BVH_BIN_COUNT - 1; ++bin)
+					{
+						if (binPrimitiveCount[bin] > 0)
+						{
+							if (leftCount == 0)
+							{
+								leftBounds = binBounds[bin];
+							}
+							else
+							{
+								leftBounds.Merge(binBounds[bin]);
+							}
+							leftCount += binPrimitiveCount[bin];
+						}
+
+						if (leftCount == 0 || leftCount == end - begin)
+						{
+							continue;
+						}
+
+						const float cost = leftBounds.surfaceArea() * leftCount + rightCost[bin + 1];
+						if (cost < bestCost)
+						{
+							bestCost = cost;
+							bestAxis = axis;
+							bestBin = bin;
+						}
+					}
+				}
+
+				if (bestAxis < 3)
+				{
+					const float binScale = BVH_BIN_COUNT * (1.0f - math::epsilon<float>()) / centroidExtents[bestAxis];
+					const float centroidMinimum = centroidBounds.minimum[bestAxis];
+					unsigned int* const middle = std::partition(mPrimitiveIndices.data() + begin, mPrimitiveIndices.data() + end, [&](unsigned int primitiveIndex)
+					{
+						return math::Min(static_cast<unsigned int>((mPrimitiveCentroids[primitiveIndex][bestAxis] - centroidMinimum) * binScale), BVH_BIN_COUNT - 1) <= bestBin;
+					});
+
+					const unsigned int mid = static_cast<unsigned int>(middle - mPrimitiveIndices.data());
+					if (mid > begin && mid < end)
+					{
+						return mid;
+					}
+				}
+			}
+
+			// median split on longest axis
+			unsigned int longestAxis = 0;
+			if (centroidExtents.y > centroidExtents[longestAxis])
+			{
+				longestAxis = 1;
+			}
+			if (centroidExtents.z > centroidExtents[longestAxis])
+			{
+				longestAxis = 2;
+			}
+
+			const unsigned int mid = begin + (end - begin) / 2;
+			std::nth_element(mPrimitiveIndices.data() + begin, mPrimitiveIndices.data() + mid, mPrimitiveIndices.data() + end, [&](unsigned int a, unsigned int b)
+			{
+				return mPrimitiveCentroids[a][longestAxis] < mPrimitiveCentroids[b][longestAxis];
+			});
+			return mid;
+		}
+
+		/// <summary>
+		/// Build node of primitives [begin, end) and its descendants to nodes
+		/// </summary>
+		/// <param name="subtreeBuildTasks">when not nullptr, children having more than deferPrimitiveCount primitives are deferred to here</param>
+		/// <returns>index of built node in nodes</returns>
+		unsigned int BuildNode(std::vector<BVHNode>& nodes, unsigned int begin, unsigned int end, unsigned int depth, std::vector<SubtreeBuildTask>* subtreeBuildTasks, unsigned int deferPrimitiveCount)
+		{
+			const unsigned int nodeIndex = static_cast<unsigned int>(nodes.size());
+			nodes.emplace_back();
+
+			// split twice to make 4 children
+			unsigned int childBegin[4];
+			unsigned int childEnd[4];
+			unsigned int childCount = 0;
+
+			if (end - begin <= BVH_MAX_LEAF_PRIMITIVE_COUNT)
+			{
+				childBegin[0] = begin;
+				childEnd[0] = end;
+				childCount = 1;
+			}
+			else
+			{
+				const unsigned int mid = SplitPrimitives(begin, end, depth);
+				const unsigned int halfBegin[2]{ begin, mid };
+				const unsigned int halfEnd[2]{ mid, end };
+				for (unsigned int half = 0; half < 2; ++half)
+				{
+					if (halfEnd[half] - halfBegin[half] > BVH_MAX_LEAF_PRIMITIVE_COUNT)
+					{
+						const unsigned int quarterMid = SplitPrimitives(halfBegin[half], halfEnd[half], depth);
+						childBegin[childCount] = halfBegin[half];
+						childEnd[childCount++] = quarterMid;
+						childBegin[childCount] = quarterMid;
+						childEnd[childCount++] = halfEnd[half];
+					}
+					else
+					{
+						childBegin[childCount] = halfBegin[half];
+						childEnd[childCount++] = halfEnd[half];
+					}
+				}
+			}
+
+			for (unsigned int childIndex = 0; childIndex < 4; ++childIndex)
+			{
+				nodes[nodeIndex].child[childIndex] = BVH_INVALID_INDEX;
+				nodes[nodeIndex].primitiveCount[childIndex] = 0;
+				nodes[nodeIndex].SetChildBounds(childIndex, AABB{ math::Vector<3, float>{ math::infinity<float>() }, math::Vector<3, float>{ math::negativeInfinity<float>() } });
+			}
+			nodes[nodeIndex].childCount = childCount;
+
+			for (unsigned int childIndex = 0; childIndex < childCount; ++childIndex)
+			{
+				const unsigned int childPrimitiveCount = childEnd[childIndex] - childBegin[childIndex];
+				nodes[nodeIndex].SetChildBounds(childIndex, ComputeRangeBounds(childBegin[childIndex], childEnd[childIndex]));
+
+				if (childPrimitiveCount <= BVH_MAX_LEAF_PRIMITIVE_COUNT)
+				{
+					nodes[nodeIndex].child[childIndex] = childBegin[childIndex];
+					nodes[nodeIndex].primitiveCount[childIndex] = childPrimitiveCount;
+				}
+				else if (subtreeBuildTasks != nullptr && childPrimitiveCount > deferPrimitiveCount)
+				{
+					// keep splitting on calling thread until subtree is small enough
+					const unsigned int childNodeIndex = BuildNode(nodes, childBegin[childIndex], childEnd[childIndex], depth + 1, subtreeBuildTasks, deferPrimitiveCount);
+					nodes[nodeIndex].child[childIndex] = childNodeIndex;
+				}
+				else if (subtreeBuildTasks != nullptr)
+				{
+					subtreeBuildTasks->push_back(SubtreeBuildTask{ nodeIndex, childIndex, childBegin[childIndex], childEnd[childIndex], depth + 1 });
+				}
+				else
+				{
+					const unsigned int childNodeIndex = BuildNode(nodes, childBegin[childIndex], childEnd[childIndex], depth + 1, nullptr, 0);
+					nodes[nodeIndex].child[childIndex] = childNodeIndex;
+				}
+			}
+
+			return nodeIndex;
+		}
+
+		std::vector<BVHNode> mNodes;
+		std::vector<AABB> mPrimitiveBounds;
+		std::vector<math::Vector<3, float>> mPrimitiveCentroids;
+		std::vector<unsigned int> mPrimitiveIndices;
+
+		std::vector<NodeLink> mNodeLinks;
+		std::vector<unsigned char> mNodeDirtyFlags;
+		std::vector<unsigned int> mPrimitiveLeafNodeIndices;
+
+		unsigned int mBuildThreadCount = 1;
+		float mBuildSAHCost = 0.0f;
+		float mRebuildSAHRatio = BVH_DEFAULT_REBUILD_SAH_RATIO;
+	};
+}
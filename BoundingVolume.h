@@ -0,0 +1,692 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "LMath_Core.h"
+#include "Utility.h"
+#include "Vector3.h"
+#include "Matrix3x3.h"
+#include "Collision.h"
+#include "OBB.h"
+#include "Parallel.h"
+
+#include "SIMD_Core.h"
+
+namespace math
+{
+	/// <summary>
+	/// Point index is stored as float in SIMD lanes. Points are processed in blocks of this size so index is exact
+	/// </summary>
+	inline constexpr size_t BOUNDING_VOLUME_INDEX_BLOCK_SIZE = static_cast<size_t>(1) << 23;
+
+	/// <summary>
+	/// Sums are accumulated in float lanes for this many points and then flushed to double
+	/// </summary>
+	inline constexpr size_t BOUNDING_VOLUME_SUM_BLOCK_SIZE = 1024;
+
+	inline constexpr size_t BOUNDING_SPHERE_MAX_GROW_ITERATION_COUNT = 16;
+	inline constexpr size_t PCA_JACOBI_MAX_ITERATION_COUNT = 32;
+
+	struct BoundingSphere
+	{
+		math::Vector<3, float> center;
+		float radius;
+	};
+
+	namespace detail
+	{
+		static_assert(sizeof(math::Vector<3, float>) == sizeof(float) * 3, "points are read as packed float array");
+
+		/// <summary>
+		/// Largest value and index of point having it. When values are same, smaller index is kept
+		/// </summary>
+		struct IndexedMaximum
+		{
+			float value = math::negativeInfinity<float>();
+			size_t index = 0;
+
+			FORCE_INLINE void Merge(float otherValue, size_t otherIndex) noexcept
+			{
+				if (otherValue > value || (otherValue == value && otherIndex < index))
+				{
+					value = otherValue;
+					index = otherIndex;
+				}
+			}
+		};
+
+		/// <summary>
+		/// Find maximum of ValueCount values evaluated from each point
+		/// </summary>
+		/// <param name="evaluate8">void(M256F x, M256F y, M256F z, M256F* outValues)</param>
+		/// <param name="evaluate">void(const Vector3& point, float* outValues)</param>
+		/// <param name="indexOffset">added to found index</param>
+		template <size_t ValueCount, typename Evaluate8, typename Evaluate>
+		inline void FindIndexedMaxima(const math::Vector<3, float>* points, size_t pointCount, size_t indexOffset, const Evaluate8& evaluate8, const Evaluate& evaluate, IndexedMaximum* outMaxima)
+		{
+			size_t pointIndex = 0;
+
+#ifdef SIMD_ENABLED
+			const M256F laneOffset = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+
+			while (pointIndex + 8 <= pointCount)
+			{
+				const size_t blockBegin = pointIndex;
+				const size_t blockEnd = math::Min(pointCount, blockBegin + BOUNDING_VOLUME_INDEX_BLOCK_SIZE);
+
+				M256F bestValues[ValueCount];
+				M256F bestIndices[ValueCount];
+				for (size_t valueIndex = 0; valueIndex < ValueCount; ++valueIndex)
+				{
+					bestValues[valueIndex] = _mm256_set1_ps(math::negativeInfinity<float>());
+					bestIndices[valueIndex] = _mm256_setzero_ps();
+				}
+
+				for (; pointIndex + 8 <= blockEnd; pointIndex += 8)
+				{
+					M256F x, y, z;
+					LoadPoints8(points + pointIndex, x, y, z);
+
+					M256F values[ValueCount];
+					evaluate8(x, y, z, values);
+
+					const M256F indices = M256F_ADD(_mm256_set1_ps(static_cast<float>(pointIndex - blockBegin)), laneOffset);
+					for (size_t valueIndex = 0; valueIndex < ValueCount; ++valueIndex)
+					{
+						// strict comparison keeps first found point of each lane
+						const M256F isBetter = _mm256_cmp_ps(values[valueIndex], bestValues[valueIndex], _CMP_GT_OQ);
+						bestValues[valueIndex] = _mm256_blendv_ps(bestValues[valueIndex], values[valueIndex], isBetter);
+						bestIndices[valueIndex] = _mm256_blendv_ps(bestIndices[valueIndex], indices, isBetter);
+					}
+				}
+
+				for (size_t valueIndex = 0; valueIndex < ValueCount; ++valueIndex)
+				{
+					alignas(32) float laneValues[8];
+					alignas(32) float laneIndices[8];
+					_mm256_store_ps(laneValues, bestValues[valueIndex]);
+					_mm256_store_ps(laneIndices, bestIndices[valueIndex]);
+					for (size_t lane = 0; lane < 8; ++lane)
+					{
+						outMaxima[valueIndex].Merge(laneValues[lane], indexOffset + blockBegin + static_cast<size_t>(laneIndices[lane]));
+					}
+				}
+			}
+#endif
+
+			for (; pointIndex < pointCount; ++pointIndex)
+			{
+				float values[ValueCount];
+				evaluate(points[pointIndex], values);
+				for (size_t valueIndex = 0; valueIndex < ValueCount; ++valueIndex)
+				{
+					outMaxima[valueIndex].Merge(values[valueIndex], indexOffset + pointIndex);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Run FindIndexedMaxima in parallel and merge ranges in order
+		/// Result doesn't depend on threadCount
+		/// </summary>
+		template <size_t ValueCount, typename Evaluate8, typename Evaluate>
+		inline void FindIndexedMaxima(const math::Vector<3, float>* points, size_t pointCount, unsigned int threadCount, const Evaluate8& evaluate8, const Evaluate& evaluate, IndexedMaximum* outMaxima)
+		{
+			const unsigned int rangeCount = math::Max(threadCount, 1u);
+			std::vector<IndexedMaximum> rangeMaxima(static_cast<size_t>(rangeCount) * ValueCount);
+
+			math::ParallelFor(pointCount, rangeCount, [&](size_t begin, size_t end, unsigned int rangeIndex)
+			{
+				FindIndexedMaxima<ValueCount>(points + begin, end - begin, begin, evaluate8, evaluate, rangeMaxima.data() + static_cast<size_t>(rangeIndex) * ValueCount);
+			});
+
+			for (size_t valueIndex = 0; valueIndex < ValueCount; ++valueIndex)
+			{
+				outMaxima[valueIndex] = IndexedMaximum{};
+				for (unsigned int rangeIndex = 0; rangeIndex < rangeCount; ++rangeIndex)
+				{
+					const IndexedMaximum& rangeMaximum = rangeMaxima[static_cast<size_t>(rangeIndex) * ValueCount + valueIndex];
+					outMaxima[valueIndex].Merge(rangeMaximum.value, rangeMaximum.index);
+				}
+			}
+		}
+
+		inline AABB ComputePointBounds(const math::Vector<3, float>* points, size_t pointCount) noexcept
+		{
+			math::Vector<3, float> minimum{ math::infinity<float>(), math::infinity<float>(), math::infinity<float>() };
+			math::Vector<3, float> maximum{ math::negativeInfinity<float>(), math::negativeInfinity<float>(), math::negativeInfinity<float>() };
+			size_t pointIndex = 0;
+
+#ifdef SIMD_ENABLED
+			if (pointCount >= 8)
+			{
+				M256F minimumX = _mm256_set1_ps(math::infinity<float>());
+				M256F minimumY = minimumX;
+				M256F minimumZ = minimumX;
+				M256F maximumX = _mm256_set1_ps(math::negativeInfinity<float>());
+				M256F maximumY = maximumX;
+				M256F maximumZ = maximumX;
+
+				for (; pointIndex + 8 <= pointCount; pointIndex += 8)
+				{
+					M256F x, y, z;
+					LoadPoints8(points + pointIndex, x, y, z);
+					minimumX = _mm256_min_ps(minimumX, x);
+					minimumY = _mm256_min_ps(minimumY, y);
+					minimumZ = _mm256_min_ps(minimumZ, z);
+					maximumX = _mm256_max_ps(maximumX, x);
+					maximumY = _mm256_max_ps(maximumY, y);
+					maximumZ = _mm256_max_ps(maximumZ, z);
+				}
+
+				alignas(32) float laneValues[6][8];
+				_mm256_store_ps(laneValues[0], minimumX);
+				_mm256_store_ps(laneValues[1], minimumY);
+				_mm256_store_ps(laneValues[2], minimumZ);
+				_mm256_store_ps(laneValues[3], maximumX);
+				_mm256_store_ps(laneValues[4], maximumY);
+				_mm256_store_ps(laneValues[5], maximumZ);
+				for (size_t lane = 0; lane < 8; ++lane)
+				{
+					minimum = math::Min(minimum, math::Vector<3, float>{ laneValues[0][lane], laneValues[1][lane], laneValues[2][lane] });
+					maximum = math::Max(maximum, math::Vector<3, float>{ laneValues[3][lane], laneValues[4][lane], laneValues[5][lane] });
+				}
+			}
+#endif
+
+			for (; pointIndex < pointCount; ++pointIndex)
+			{
+				minimum = math::Min(minimum, points[pointIndex]);
+				maximum = math::Max(maximum, points[pointIndex]);
+			}
+
+			return AABB{ minimum, maximum };
+		}
+
+		/// <summary>
+		/// Bounds of points projected to axes. axes should be orthonormal
+		/// minimum and maximum of returned box are in space of axes with origin
+		/// </summary>
+		inline AABB ComputeProjectedBounds(const math::Vector<3, float>* points, size_t pointCount, const math::Vector<3, float>& origin, const math::Vector<3, float>* axes) noexcept
+		{
+			math::Vector<3, float> minimum{ math::infinity<float>(), math::infinity<float>(), math::infinity<float>() };
+			math::Vector<3, float> maximum{ math::negativeInfinity<float>(), math::negativeInfinity<float>(), math::negativeInfinity<float>() };
+			size_t pointIndex = 0;
+
+#ifdef SIMD_ENABLED
+			if (pointCount >= 8)
+			{
+				M256F minimums[3];
+				M256F maximums[3];
+				M256F axisX[3];
+				M256F axisY[3];
+				M256F axisZ[3];
+				for (size_t axisIndex = 0; axisIndex < 3; ++axisIndex)
+				{
+					minimums[axisIndex] = _mm256_set1_ps(math::infinity<float>());
+					maximums[axisIndex] = _mm256_set1_ps(math::negativeInfinity<float>());
+					axisX[axisIndex] = _mm256_set1_ps(axes[axisIndex].x);
+					axisY[axisIndex] = _mm256_set1_ps(axes[axisIndex].y);
+					axisZ[axisIndex] = _mm256_set1_ps(axes[axisIndex].z);
+				}
+				const M256F originX = _mm256_set1_ps(origin.x);
+				const M256F originY = _mm256_set1_ps(origin.y);
+				const M256F originZ = _mm256_set1_ps(origin.z);
+
+				for (; pointIndex + 8 <= pointCount; pointIndex += 8)
+				{
+					M256F x, y, z;
+					LoadPoints8(points + pointIndex, x, y, z);
+					x = M256F_SUB(x, originX);
+					y = M256F_SUB(y, originY);
+					z = M256F_SUB(z, originZ);
+
+					for (size_t axisIndex = 0; axisIndex < 3; ++axisIndex)
+					{
+						const M256F projection = M256F_MUL_AND_ADD(z, axisZ[axisIndex], M256F_MUL_AND_ADD(y, axisY[axisIndex], M256F_MUL(x, axisX[axisIndex])));
+						minimums[axisIndex] = _mm256_min_ps(minimums[axisIndex], projection);
+						maximums[axisIndex] = _mm256_max_ps(maximums[axisIndex], projection);
+					}
+				}
+
+				for (size_t axisIndex = 0; axisIndex < 3; ++axisIndex)
+				{
+					alignas(32) float laneMinimums[8];
+					alignas(32) float laneMaximums[8];
+					_mm256_store_ps(laneMinimums, minimums[axisIndex]);
+					_mm256_store_ps(laneMaximums, maximums[axisIndex]);
+					for (size_t lane = 0; lane < 8; ++lane)
+					{
+						minimum[axisIndex] = math::Min(minimum[axisIndex], laneMinimums[lane]);
+						maximum[axisIndex] = math::Max(maximum[axisIndex], laneMaximums[lane]);
+					}
+				}
+			}
+#endif
+
+			for (; pointIndex < pointCount; ++pointIndex)
+			{
+				const math::Vector<3, float> point = points[pointIndex] - origin;
+				for (size_t axisIndex = 0; axisIndex < 3; ++axisIndex)
+				{
+					const float projection = math::dot(point, axes[axisIndex]);
+					minimum[axisIndex] = math::Min(minimum[axisIndex], projection);
+					maximum[axisIndex] = math::Max(maximum[axisIndex], projection);
+				}
+			}
+
+			return AABB{ minimum, maximum };
+		}
+
+		/// <summary>
+		/// Sum of points, or sum of products of centered points
+		/// </summary>
+		/// <param name="outSums">isCovariance == false : x, y, z. isCovariance == true : xx, xy, xz, yy, yz, zz</param>
+		template <bool IsCovariance>
+		inline void SumPoints(const math::Vector<3, float>* points, size_t pointCount, const math::Vector<3, float>& origin, double* outSums) noexcept
+		{
+			constexpr size_t SUM_COUNT = (IsCovariance == true) ? 6 : 3;
+			for (size_t sumIndex = 0; sumIndex < SUM_COUNT; ++sumIndex)
+			{
+				outSums[sumIndex] = 0.0;
+			}
+
+			size_t pointIndex = 0;
+
+#ifdef SIMD_ENABLED
+			const M256F originX = _mm256_set1_ps(origin.x);
+			const M256F originY = _mm256_set1_ps(origin.y);
+			const M256F originZ = _mm256_set1_ps(origin.z);
+
+			while (pointIndex + 8 <= pointCount)
+			{
+				const size_t blockEnd = math::Min(pointCount, pointIndex + BOUNDING_VOLUME_SUM_BLOCK_SIZE);
+
+				M256F sums[SUM_COUNT];
+				for (size_t sumIndex = 0; sumIndex < SUM_COUNT; ++sumIndex)
+				{
+					sums[sumIndex] = _mm256_setzero_ps();
+				}
+
+				for (; pointIndex + 8 <= blockEnd; pointIndex += 8)
+				{
+					M256F x, y, z;
+					LoadPoints8(points + pointIndex, x, y, z);
+					x = M256F_SUB(x, originX);
+					y = M256F_SUB(y, originY);
+					z = M256F_SUB(z, originZ);
+
+					if constexpr (IsCovariance == true)
+					{
+						sums[0] = M256F_MUL_AND_ADD(x, x, sums[0]);
+						sums[1] = M256F_MUL_AND_ADD(x, y, sums[1]);
+						sums[2] = M256F_MUL_AND_ADD(x, z, sums[2]);
+						sums[3] = M256F_MUL_AND_ADD(y, y, sums[3]);
+						sums[4] = M256F_MUL_AND_ADD(y, z, sums[4]);
+						sums[5] = M256F_MUL_AND_ADD(z, z, sums[5]);
+					}
+					else
+					{
+						sums[0] = M256F_ADD(sums[0], x);
+						sums[1] = M256F_ADD(sums[1], y);
+						sums[2] = M256F_ADD(sums[2], z);
+					}
+				}
+
+				for (size_t sumIndex = 0; sumIndex < SUM_COUNT; ++sumIndex)
+				{
+					alignas(32) float laneSums[8];
+					_mm256_store_ps(laneSums, sums[sumIndex]);
+					for (size_t lane = 0; lane < 8; ++lane)
+					{
+						outSums[sumIndex] += static_cast<double>(laneSums[lane]);
+					}
+				}
+			}
+#endif
+
+			for (; pointIndex < pointCount; ++pointIndex)
+			{
+				const math::Vector<3, float> point = points[pointIndex] - origin;
+				if constexpr (IsCovariance == true)
+				{
+					outSums[0] += static_cast<double>(point.x * point.x);
+					outSums[1] += static_cast<double>(point.x * point.y);
+					outSums[2] += static_cast<double>(point.x * point.z);
+					outSums[3] += static_cast<double>(point.y * point.y);
+					outSums[4] += static_cast<double>(point.y * point.z);
+					outSums[5] += static_cast<double>(point.z * point.z);
+				}
+				else
+				{
+					outSums[0] += static_cast<double>(point.x);
+					outSums[1] += static_cast<double>(point.y);
+					outSums[2] += static_cast<double>(point.z);
+				}
+			}
+		}
+
+		template <bool IsCovariance>
+		inline void SumPoints(const math::Vector<3, float>* points, size_t pointCount, unsigned int threadCount, const math::Vector<3, float>& origin, double* outSums)
+		{
+			constexpr size_t SUM_COUNT = (IsCovariance == true) ? 6 : 3;
+			const unsigned int rangeCount = math::Max(threadCount, 1u);
+			std::vector<double> rangeSums(static_cast<size_t>(rangeCount) * SUM_COUNT, 0.0);
+
+			math::ParallelFor(pointCount, rangeCount, [&](size_t begin, size_t end, unsigned int rangeIndex)
+			{
+				SumPoints<IsCovariance>(points + begin, end - begin, origin, rangeSums.data() + static_cast<size_t>(rangeIndex) * SUM_COUNT);
+			});
+
+			for (size_t sumIndex = 0; sumIndex < SUM_COUNT; ++sumIndex)
+			{
+				outSums[sumIndex] = 0.0;
+				for (unsigned int rangeIndex = 0; rangeIndex < rangeCount; ++rangeIndex)
+				{
+					outSums[sumIndex] += rangeSums[static_cast<size_t>(rangeIndex) * SUM_COUNT + sumIndex];
+				}
+			}
+		}
+
+		/// <summary>
+		/// Eigenvectors of symmetric 3x3 matrix with classical Jacobi method. Each iteration rotates away largest off diagonal element
+		/// matrix is diagonalized in place
+		///
+		/// reference : Real-Time Collision Detection, Christer Ericson, 4.3.3
+		/// </summary>
+		/// <param name="outEigenVectors">outEigenVectors[column][row]. each column is a eigenvector</param>
+		inline void ComputeSymmetricEigenVectors(double matrix[3][3], double outEigenVectors[3][3]) noexcept
+		{
+			for (size_t column = 0; column < 3; ++column)
+			{
+				for (size_t row = 0; row < 3; ++row)
+				{
+					outEigenVectors[column][row] = (column == row) ? 1.0 : 0.0;
+				}
+			}
+
+			for (size_t iteration = 0; iteration < PCA_JACOBI_MAX_ITERATION_COUNT; ++iteration)
+			{
+				// largest off diagonal element
+				size_t p = 0;
+				size_t q = 1;
+				if (std::abs(matrix[0][2]) > std::abs(matrix[p][q]))
+				{
+					p = 0;
+					q = 2;
+				}
+				if (std::abs(matrix[1][2]) > std::abs(matrix[p][q]))
+				{
+					p = 1;
+					q = 2;
+				}
+
+				const double diagonalScale = std::abs(matrix[0][0]) + std::abs(matrix[1][1]) + std::abs(matrix[2][2]);
+				if (std::abs(matrix[p][q]) <= diagonalScale * 1e-12)
+				{
+					break;
+				}
+
+				const double theta = (matrix[q][q] - matrix[p][p]) / (2.0 * matrix[p][q]);
+				const double t = ((theta >= 0.0) ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+				const double c = 1.0 / std::sqrt(t * t + 1.0);
+				const double s = t * c;
+
+				// matrix = J^T * matrix * J
+				for (size_t k = 0; k < 3; ++k)
+				{
+					const double kp = matrix[k][p];
+					const double kq = matrix[k][q];
+					matrix[k][p] = c * kp - s * kq;
+					matrix[k][q] = s * kp + c * kq;
+				}
+				for (size_t k = 0; k < 3; ++k)
+				{
+					const double pk = matrix[p][k];
+					const double qk = matrix[q][k];
+					matrix[p][k] = c * pk - s * qk;
+					matrix[q][k] = s * pk + c * qk;
+				}
+
+				// eigenVectors = eigenVectors * J
+				for (size_t row = 0; row < 3; ++row)
+				{
+					const double rp = outEigenVectors[p][row];
+					const double rq = outEigenVectors[q][row];
+					outEigenVectors[p][row] = c * rp - s * rq;
+					outEigenVectors[q][row] = s * rp + c * rq;
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// Smallest AABB containing points
+	/// Points are read 8 at a time and split to threadCount ranges
+	/// </summary>
+	/// <returns>box with minimum = +infinity and maximum = -infinity when pointCount is 0</returns>
+	[[nodiscard]] inline AABB ComputeAABB(const math::Vector<3, float>* points, size_t pointCount, unsigned int threadCount = 1)
+	{
+		const unsigned int rangeCount = math::Max(threadCount, 1u);
+		std::vector<AABB> rangeAABBs(rangeCount, detail::ComputePointBounds(nullptr, 0));
+
+		math::ParallelFor(pointCount, rangeCount, [&](size_t begin, size_t end, unsigned int rangeIndex)
+		{
+			rangeAABBs[rangeIndex] = detail::ComputePointBounds(points + begin, end - begin);
+		});
+
+		AABB aabb = rangeAABBs[0];
+		for (unsigned int rangeIndex = 1; rangeIndex < rangeCount; ++rangeIndex)
+		{
+			aabb.Merge(rangeAABBs[rangeIndex]);
+		}
+		return aabb;
+	}
+
+	/// <summary>
+	/// Near optimal sphere containing points
+	///
+	/// Initial sphere is made from extreme points along 7 directions ( EPOS-14 )
+	/// Then sphere grows to farthest point outside until every point is inside ( Ritter )
+	/// Each pass reads points 8 at a time and is split to threadCount ranges
+	/// Ties are broken by smaller point index, so result doesn't depend on threadCount
+	///
+	/// references :
+	/// An Efficient Bounding Sphere, Jack Ritter, Graphics Gems
+	/// Fast and Tight Fitting Bounding Spheres, Thomas Larsson
+	/// </summary>
+	/// <returns>radius is 0 when pointCount is 0</returns>
+	[[nodiscard]] inline BoundingSphere ComputeBoundingSphere(const math::Vector<3, float>* points, size_t pointCount, unsigned int threadCount = 1)
+	{
+		if (pointCount == 0)
+		{
+			return BoundingSphere{ math::Vector<3, float>{ 0.0f, 0.0f, 0.0f }, 0.0f };
+		}
+
+		// maximum and minimum of x, y, z, x + y + z, x + y - z, x - y + z, x - y - z
+		constexpr size_t EXTREME_VALUE_COUNT = 14;
+		detail::IndexedMaximum extremes[EXTREME_VALUE_COUNT];
+		detail::FindIndexedMaxima<EXTREME_VALUE_COUNT>(points, pointCount, threadCount,
+#ifdef SIMD_ENABLED
+			[](const M256F& x, const M256F& y, const M256F& z, M256F* outValues)
+			{
+				const M256F zero = _mm256_setzero_ps();
+				const M256F xPlusY = M256F_ADD(x, y);
+				const M256F xMinusY = M256F_SUB(x, y);
+				outValues[0] = x;
+				outValues[1] = y;
+				outValues[2] = z;
+				outValues[3] = M256F_ADD(xPlusY, z);
+				outValues[4] = M256F_SUB(xPlusY, z);
+				outValues[5] = M256F_ADD(xMinusY, z);
+				outValues[6] = M256F_SUB(xMinusY, z);
+				for (size_t valueIndex = 0; valueIndex < 7; ++valueIndex)
+				{
+					outValues[valueIndex + 7] = M256F_SUB(zero, outValues[valueIndex]);
+				}
+			},
+#else
+			nullptr,
+#endif
+			[](const math::Vector<3, float>& point, float* outValues)
+			{
+				outValues[0] = point.x;
+				outValues[1] = point.y;
+				outValues[2] = point.z;
+				outValues[3] = (point.x + point.y) + point.z;
+				outValues[4] = (point.x + point.y) - point.z;
+				outValues[5] = (point.x - point.y) + point.z;
+				outValues[6] = (point.x - point.y) - point.z;
+				for (size_t valueIndex = 0; valueIndex < 7; ++valueIndex)
+				{
+					outValues[valueIndex + 7] = -outValues[valueIndex];
+				}
+			},
+			extremes);
+
+		// most distant pair of extreme points
+		size_t farthestPairIndex = 0;
+		float farthestPairSqrDistance = -1.0f;
+		for (size_t directionIndex = 0; directionIndex < 7; ++directionIndex)
+		{
+			const math::Vector<3, float> difference = points[extremes[directionIndex].index] - points[extremes[directionIndex + 7].index];
+			const float sqrDistance = math::dot(difference, difference);
+			if (sqrDistance > farthestPairSqrDistance)
+			{
+				farthestPairSqrDistance = sqrDistance;
+				farthestPairIndex = directionIndex;
+			}
+		}
+
+		BoundingSphere sphere
+		{
+			(points[extremes[farthestPairIndex].index] + points[extremes[farthestPairIndex + 7].index]) * 0.5f,
+			std::sqrt(farthestPairSqrDistance) * 0.5f
+		};
+
+		const auto growSphere = [&sphere](const math::Vector<3, float>& point)
+		{
+			const math::Vector<3, float> difference = point - sphere.center;
+			const float sqrDistance = math::dot(difference, difference);
+			if (sqrDistance > sphere.radius * sphere.radius)
+			{
+				const float distance = std::sqrt(sqrDistance);
+				const float newRadius = (sphere.radius + distance) * 0.5f;
+				sphere.center += difference * ((newRadius - sphere.radius) / distance);
+				sphere.radius = newRadius;
+			}
+		};
+
+		for (size_t extremeIndex = 0; extremeIndex < EXTREME_VALUE_COUNT; ++extremeIndex)
+		{
+			growSphere(points[extremes[extremeIndex].index]);
+		}
+
+		for (size_t iteration = 0; ; ++iteration)
+		{
+			detail::IndexedMaximum farthest;
+			const math::Vector<3, float> center = sphere.center;
+			detail::FindIndexedMaxima<1>(points, pointCount, threadCount,
+#ifdef SIMD_ENABLED
+				[centerX = _mm256_set1_ps(center.x), centerY = _mm256_set1_ps(center.y), centerZ = _mm256_set1_ps(center.z)](const M256F& x, const M256F& y, const M256F& z, M256F* outValues)
+				{
+					const M256F dx = M256F_SUB(x, centerX);
+					const M256F dy = M256F_SUB(y, centerY);
+					const M256F dz = M256F_SUB(z, centerZ);
+					outValues[0] = M256F_MUL_AND_ADD(dz, dz, M256F_MUL_AND_ADD(dy, dy, M256F_MUL(dx, dx)));
+				},
+#else
+				nullptr,
+#endif
+				[center](const math::Vector<3, float>& point, float* outValues)
+				{
+					const math::Vector<3, float> difference = point - center;
+					outValues[0] = math::dot(difference, difference);
+				},
+				&farthest);
+
+			if (farthest.value <= sphere.radius * sphere.radius)
+			{
+				break;
+			}
+			if (iteration + 1 >= BOUNDING_SPHERE_MAX_GROW_ITERATION_COUNT)
+			{
+				// keep center and contain every point
+				sphere.radius = std::sqrt(farthest.value);
+				break;
+			}
+			growSphere(points[farthest.index]);
+		}
+
+		return sphere;
+	}
+
+	/// <summary>
+	/// Box oriented to principal axes of points
+	/// Axes are eigenvectors of covariance matrix. Extents are projected bounds of points on them
+	/// Mean, covariance and projection passes read points 8 at a time and are split to threadCount ranges
+	/// Ranges are merged in order, so result is same for same threadCount
+	///
+	/// reference : Real-Time Collision Detection, Christer Ericson, 4.4.3
+	/// </summary>
+	/// <returns>box at origin with zero extents when pointCount is 0</returns>
+	[[nodiscard]] inline OBB ComputePCAOBB(const math::Vector<3, float>* points, size_t pointCount, unsigned int threadCount = 1)
+	{
+		if (pointCount == 0)
+		{
+			return OBB{ math::Vector<3, float>{ 0.0f, 0.0f, 0.0f }, math::Matrix<3, 3, float>(1.0f), math::Vector<3, float>{ 0.0f, 0.0f, 0.0f } };
+		}
+
+		const math::Vector<3, float> zero{ 0.0f, 0.0f, 0.0f };
+		const double inversePointCount = 1.0 / static_cast<double>(pointCount);
+
+		double sums[6];
+		detail::SumPoints<false>(points, pointCount, threadCount, zero, sums);
+		const math::Vector<3, float> mean{ static_cast<float>(sums[0] * inversePointCount), static_cast<float>(sums[1] * inversePointCount), static_cast<float>(sums[2] * inversePointCount) };
+
+		detail::SumPoints<true>(points, pointCount, threadCount, mean, sums);
+		double covariance[3][3]
+		{
+			{ sums[0] * inversePointCount, sums[1] * inversePointCount, sums[2] * inversePointCount },
+			{ sums[1] * inversePointCount, sums[3] * inversePointCount, sums[4] * inversePointCount },
+			{ sums[2] * inversePointCount, sums[4] * inversePointCount, sums[5] * inversePointCount }
+		};
+
+		double eigenVectors[3][3];
+		detail::ComputeSymmetricEigenVectors(covariance, eigenVectors);
+
+		// axis 0 has largest variance
+		size_t order[3]{ 0, 1, 2 };
+		std::sort(order, order + 3, [&covariance](size_t lhs, size_t rhs) { return covariance[lhs][lhs] > covariance[rhs][rhs]; });
+
+		// orthonormalize and make right handed
+		math::Vector<3, float> axes[3];
+		axes[0] = math::normalize(math::Vector<3, float>{ static_cast<float>(eigenVectors[order[0]][0]), static_cast<float>(eigenVectors[order[0]][1]), static_cast<float>(eigenVectors[order[0]][2]) });
+		axes[1] = math::Vector<3, float>{ static_cast<float>(eigenVectors[order[1]][0]), static_cast<float>(eigenVectors[order[1]][1]), static_cast<float>(eigenVectors[order[1]][2]) };
+		axes[1] = math::normalize(axes[1] - axes[0] * math::dot(axes[1], axes[0]));
+		axes[2] = math::cross(axes[0], axes[1]);
+
+		const unsigned int rangeCount = math::Max(threadCount, 1u);
+		std::vector<AABB> rangeBounds(rangeCount, detail::ComputeProjectedBounds(nullptr, 0, mean, axes));
+		math::ParallelFor(pointCount, rangeCount, [&](size_t begin, size_t end, unsigned int rangeIndex)
+		{
+			rangeBounds[rangeIndex] = detail::ComputeProjectedBounds(points + begin, end - begin, mean, axes);
+		});
+
+		AABB localBounds = rangeBounds[0];
+		for (unsigned int rangeIndex = 1; rangeIndex < rangeCount; ++rangeIndex)
+		{
+			localBounds.Merge(rangeBounds[rangeIndex]);
+		}
+
+		const math::Vector<3, float> localCenter = localBounds.center();
+		return OBB
+		{
+			mean + axes[0] * localCenter.x + axes[1] * localCenter.y + axes[2] * localCenter.z,
+			math::Matrix<3, 3, float>{ axes[0], axes[1], axes[2] },
+			localBounds.extents()
+		};
+	}
+}
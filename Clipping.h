@@ -0,0 +1,281 @@
+#pragma once
+
+#include <vector>
+
+#include "LMath_Core.h"
+#include "Utility.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Culling.h"
+
+#include "SIMD_Core.h"
+
+namespace math
+{
+	/// <summary>
+	/// Size of working buffer of clipping. Each clip plane adds at most one vertex to convex polygon,
+	/// so input polygon should have at most CLIPPING_MAX_POLYGON_VERTEX_COUNT - 6 vertices
+	/// </summary>
+	inline constexpr size_t CLIPPING_MAX_POLYGON_VERTEX_COUNT = 32;
+
+	/// <summary>
+	/// Clipped convex polygon in PolygonClipper. Vertices are [ firstVertex, firstVertex + vertexCount ) of GetVertices()
+	/// </summary>
+	struct ClippedPolygon
+	{
+		unsigned int firstVertex;
+		unsigned int vertexCount;
+		/// <summary>
+		/// index of input polygon or triangle
+		/// </summary>
+		unsigned int sourceIndex;
+	};
+
+	namespace detail
+	{
+		/// <summary>
+		/// Vertex with signed distance to every plane. lane 6, 7 are unused
+		/// Distance is affine, so distances of intersection are interpolated same with position
+		/// </summary>
+		struct alignas(32) ClipVertex
+		{
+			float distances[8];
+			math::Vector<3, float> position;
+		};
+	}
+
+	/// <summary>
+	/// Sutherland-Hodgman clipping of triangles and convex polygons against frustum planes
+	///
+	/// Distances of vertex to all planes are evaluated at once and carried with the vertex,
+	/// so intersection vertices never evaluate planes again.
+	/// Edge is always interpolated from inside vertex to outside vertex, so edges shared by adjacent triangles are clipped to same point
+	///
+	/// Clipped polygons are written to arena allocated in constructor. Clipping never allocates memory
+	///
+	/// reference : Reentrant Polygon Clipping, I. Sutherland, G. Hodgman
+	/// </summary>
+	class PolygonClipper
+	{
+	public:
+
+		/// <param name="maxVertexCount">vertex capacity of arena</param>
+		/// <param name="maxPolygonCount">polygon capacity of arena</param>
+		PolygonClipper(size_t maxVertexCount, size_t maxPolygonCount)
+			: mVertices(maxVertexCount), mPolygons(maxPolygonCount)
+		{
+		}
+
+		/// <summary>
+		/// Set planes to clip with. Polygon is clipped to inside of planes ( dot(normal, point) + w >= 0 )
+		/// </summary>
+		/// <param name="sixPlanes">made by ExtractPlanesFromVIewProjectionMatrix. Planes don't need to be normalized</param>
+		/// <param name="planeMask">bit i is set when sixPlanes[i] is used. Ex) only near plane for rasterizer with guard band</param>
+		void SetPlanes(const math::Vector<4, float>* sixPlanes, unsigned int planeMask = CULLING_ALL_PLANES_MASK) noexcept
+		{
+			mPlaneMask = planeMask & CULLING_ALL_PLANES_MASK;
+			for (size_t component = 0; component < 4; ++component)
+			{
+				for (size_t planeIndex = 0; planeIndex < 8; ++planeIndex)
+				{
+					// unused lanes always return positive distance
+					mPlanes[component][planeIndex] = (planeIndex < 6) ? sixPlanes[planeIndex][component] : ((component == 3) ? 1.0f : 0.0f);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Remove every clipped polygon
+		/// </summary>
+		FORCE_INLINE void Clear() noexcept
+		{
+			mVertexCount = 0;
+			mPolygonCount = 0;
+		}
+
+		[[nodiscard]] FORCE_INLINE const math::Vector<3, float>* GetVertices() const noexcept
+		{
+			return mVertices.data();
+		}
+
+		[[nodiscard]] FORCE_INLINE size_t GetVertexCount() const noexcept
+		{
+			return mVertexCount;
+		}
+
+		[[nodiscard]] FORCE_INLINE const ClippedPolygon* GetPolygons() const noexcept
+		{
+			return mPolygons.data();
+		}
+
+		[[nodiscard]] FORCE_INLINE size_t GetPolygonCount() const noexcept
+		{
+			return mPolygonCount;
+		}
+
+		/// <summary>
+		/// Clip convex polygon and append it to arena. Polygon completely outside of any plane isn't appended
+		/// Clipped polygon keeps winding of input polygon and can be drawn as triangle fan
+		/// </summary>
+		/// <param name="vertexCount">at least 3 and at most CLIPPING_MAX_POLYGON_VERTEX_COUNT - 6</param>
+		/// <returns>false when arena is full. Nothing is appended then</returns>
+		bool ClipPolygon(const math::Vector<3, float>* vertices, size_t vertexCount, unsigned int sourceIndex) noexcept
+		{
+			assert(vertexCount >= 3 && vertexCount + 6 <= CLIPPING_MAX_POLYGON_VERTEX_COUNT);
+
+			detail::ClipVertex polygons[2][CLIPPING_MAX_POLYGON_VERTEX_COUNT];
+			unsigned int outsideAllMask = CULLING_ALL_PLANES_MASK;
+			unsigned int outsideAnyMask = 0;
+			for (size_t vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex)
+			{
+				const unsigned int outsideMask = ComputeClipVertex(vertices[vertexIndex], polygons[0][vertexIndex]);
+				outsideAllMask &= outsideMask;
+				outsideAnyMask |= outsideMask;
+			}
+
+			if (outsideAllMask != 0)
+			{
+				return true;
+			}
+
+			size_t clippedVertexCount = vertexCount;
+			size_t current = 0;
+			while (outsideAnyMask != 0)
+			{
+				const unsigned int planeIndex = math::countTrailingZero(outsideAnyMask);
+				outsideAnyMask &= outsideAnyMask - 1;
+
+				clippedVertexCount = ClipByPlane(polygons[current], clippedVertexCount, planeIndex, polygons[current ^ 1]);
+				current ^= 1;
+				if (clippedVertexCount < 3)
+				{
+					return true;
+				}
+			}
+
+			if (mVertexCount + clippedVertexCount > mVertices.size() || mPolygonCount == mPolygons.size())
+			{
+				return false;
+			}
+
+			mPolygons[mPolygonCount++] = ClippedPolygon{ static_cast<unsigned int>(mVertexCount), static_cast<unsigned int>(clippedVertexCount), sourceIndex };
+			for (size_t vertexIndex = 0; vertexIndex < clippedVertexCount; ++vertexIndex)
+			{
+				mVertices[mVertexCount++] = polygons[current][vertexIndex].position;
+			}
+			return true;
+		}
+
+		/// <summary>
+		/// Clip triangles and append them to arena. sourceIndex of clipped polygon is triangle index
+		/// </summary>
+		/// <param name="indices">nullable. 3 indices per triangle. When it's null, every 3 vertices are a triangle</param>
+		/// <returns>count of processed triangles. smaller than triangleCount when arena is full</returns>
+		size_t ClipTriangles(const math::Vector<3, float>* vertices, const unsigned int* indices, size_t triangleCount) noexcept
+		{
+			for (size_t triangleIndex = 0; triangleIndex < triangleCount; ++triangleIndex)
+			{
+				const math::Vector<3, float> triangle[3]{
+					vertices[(indices != nullptr) ? indices[triangleIndex * 3 + 0] : triangleIndex * 3 + 0],
+					vertices[(indices != nullptr) ? indices[triangleIndex * 3 + 1] : triangleIndex * 3 + 1],
+					vertices[(indices != nullptr) ? indices[triangleIndex * 3 + 2] : triangleIndex * 3 + 2] };
+
+				if (ClipPolygon(triangle, 3, static_cast<unsigned int>(triangleIndex)) == false)
+				{
+					return triangleIndex;
+				}
+			}
+			return triangleCount;
+		}
+
+	private:
+
+		/// <summary>
+		/// Compute distances of point to every plane
+		/// </summary>
+		/// <returns>bit i is set when point is outside of plane i. Only planes of mPlaneMask</returns>
+		unsigned int ComputeClipVertex(const math::Vector<3, float>& point, detail::ClipVertex& outVertex) const noexcept
+		{
+			outVertex.position = point;
+#ifdef SIMD_ENABLED
+			M256F distances = M256F_MUL_AND_ADD(_mm256_load_ps(mPlanes[0]), _mm256_set1_ps(point.x), _mm256_load_ps(mPlanes[3]));
+			distances = M256F_MUL_AND_ADD(_mm256_load_ps(mPlanes[1]), _mm256_set1_ps(point.y), distances);
+			distances = M256F_MUL_AND_ADD(_mm256_load_ps(mPlanes[2]), _mm256_set1_ps(point.z), distances);
+			_mm256_store_ps(outVertex.distances, distances);
+			return static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(distances, _mm256_setzero_ps(), _CMP_LT_OQ))) & mPlaneMask;
+#else
+			unsigned int outsideMask = 0;
+			for (size_t planeIndex = 0; planeIndex < 8; ++planeIndex)
+			{
+				outVertex.distances[planeIndex] = mPlanes[0][planeIndex] * point.x + mPlanes[1][planeIndex] * point.y + mPlanes[2][planeIndex] * point.z + mPlanes[3][planeIndex];
+				outsideMask |= (outVertex.distances[planeIndex] < 0.0f) ? (1u << planeIndex) : 0u;
+			}
+			return outsideMask & mPlaneMask;
+#endif
+		}
+
+		/// <summary>
+		/// Intersection of edge from inside vertex to outside vertex with plane
+		/// </summary>
+		static FORCE_INLINE void IntersectEdge(const detail::ClipVertex& inside, const detail::ClipVertex& outside, size_t planeIndex, detail::ClipVertex& outVertex) noexcept
+		{
+			const float t = inside.distances[planeIndex] / (inside.distances[planeIndex] - outside.distances[planeIndex]);
+#ifdef SIMD_ENABLED
+			const M256F insideDistances = _mm256_load_ps(inside.distances);
+			_mm256_store_ps(outVertex.distances, M256F_MUL_AND_ADD(M256F_SUB(_mm256_load_ps(outside.distances), insideDistances), _mm256_set1_ps(t), insideDistances));
+#else
+			for (size_t lane = 0; lane < 8; ++lane)
+			{
+				outVertex.distances[lane] = inside.distances[lane] + (outside.distances[lane] - inside.distances[lane]) * t;
+			}
+#endif
+			outVertex.distances[planeIndex] = 0.0f;
+			outVertex.position = inside.position + (outside.position - inside.position) * t;
+		}
+
+		/// <returns>vertex count of clipped polygon</returns>
+		static size_t ClipByPlane(const detail::ClipVertex* polygon, size_t vertexCount, size_t planeIndex, detail::ClipVertex* outPolygon) noexcept
+		{
+			size_t outVertexCount = 0;
+			const detail::ClipVertex* previous = &polygon[vertexCount - 1];
+			bool isPreviousInside = previous->distances[planeIndex] >= 0.0f;
+
+			for (size_t vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex)
+			{
+				const detail::ClipVertex* current = &polygon[vertexIndex];
+				const bool isCurrentInside = current->distances[planeIndex] >= 0.0f;
+
+				if (isCurrentInside != isPreviousInside)
+				{
+					if (isCurrentInside == true)
+					{
+						IntersectEdge(*current, *previous, planeIndex, outPolygon[outVertexCount++]);
+					}
+					else
+					{
+						IntersectEdge(*previous, *current, planeIndex, outPolygon[outVertexCount++]);
+					}
+				}
+				if (isCurrentInside == true)
+				{
+					outPolygon[outVertexCount++] = *current;
+				}
+
+				previous = current;
+				isPreviousInside = isCurrentInside;
+			}
+			return outVertexCount;
+		}
+
+		/// <summary>
+		/// x, y, z, w of 6 planes as structure of arrays. lane 6, 7 are unused
+		/// </summary>
+		alignas(32) float mPlanes[4][8]{};
+		unsigned int mPlaneMask = CULLING_ALL_PLANES_MASK;
+
+		std::vector<math::Vector<3, float>> mVertices;
+		std::vector<ClippedPolygon> mPolygons;
+		size_t mVertexCount = 0;
+		size_t mPolygonCount = 0;
+	};
+}
@@ -0,0 +1,442 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "LMath_Core.h"
+#include "Utility.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix4x4.h"
+#include "Collision.h"
+#include "Culling.h"
+#include "Parallel.h"
+
+#include "SIMD_Core.h"
+
+namespace math
+{
+	namespace detail
+	{
+		/// <summary>
+		/// Smallest sphere containing cone
+		/// Apex is origin, axis is direction * height and radius of base circle is baseRadius
+		///
+		/// reference : Cull that cone!, Bartlomiej Wronski
+		/// </summary>
+		/// <returns>xyz is center, w is radius</returns>
+		inline math::Vector<4, float> ComputeConeBoundingSphere(const math::Vector<3, float>& origin, const math::Vector<3, float>& direction, float height, float baseRadius) noexcept
+		{
+			// wide cone : sphere centered at base circle contains apex
+			// narrow cone : sphere passing apex and base circle
+			const float centerDistance = (baseRadius >= height) ? height : (height * height + baseRadius * baseRadius) / (2.0f * height);
+			const float radius = (baseRadius >= height) ? baseRadius : centerDistance;
+			return math::Vector<4, float>{ origin.x + direction.x * centerDistance, origin.y + direction.y * centerDistance, origin.z + direction.z * centerDistance, radius };
+		}
+	}
+
+	/// <summary>
+	/// CPU clustered light assignment
+	///
+	/// View frustum is split to clusterCountX * clusterCountY screen tiles and clusterCountZ depth slices.
+	/// Slices are exponentially distributed between near and far, so every cluster has similar shape.
+	/// Cluster index is ( z * clusterCountY + y ) * clusterCountX + x, y = 0 is bottom of screen
+	///
+	/// Every light is bounded by view space sphere and tested with view space AABB of clusters, 8 clusters at once.
+	/// Slices are processed in parallel and each cluster gets compact list of light indices
+	/// Lights in list of cluster are sorted in ascending order, and result doesn't depend on thread count
+	///
+	/// references :
+	/// Clustered Deferred and Forward Shading, O. Olsson, M. Billeter, U. Assarsson
+	/// Doom ( 2016 ) : The Devil is in the Details, Tiago Sousa, Jean Geffroy
+	/// </summary>
+	class ClusteredLightGrid
+	{
+	public:
+
+		ClusteredLightGrid(size_t clusterCountX, size_t clusterCountY, size_t clusterCountZ, unsigned int threadCount = 1)
+			: mClusterCountX{ clusterCountX }, mClusterCountY{ clusterCountY }, mClusterCountZ{ clusterCountZ },
+			mSliceClusterCount{ clusterCountX * clusterCountY },
+			mPaddedSliceClusterCount{ (clusterCountX * clusterCountY + 7) / 8 * 8 },
+			mThreadCount{ math::Max(threadCount, 1u) }
+		{
+			assert(clusterCountX > 0 && clusterCountY > 0 && clusterCountZ > 0);
+
+			for (size_t component = 0; component < 6; ++component)
+			{
+				mClusterBounds[component].resize(mPaddedSliceClusterCount * mClusterCountZ);
+			}
+			mSliceDepths.resize(mClusterCountZ + 1);
+			mSlicePairs.resize(mClusterCountZ);
+			mSliceLightIndexCounts.resize(mClusterCountZ);
+			mClusterLightOffsets.resize(GetClusterCount(), 0);
+			mClusterLightCounts.resize(GetClusterCount(), 0);
+		}
+
+		[[nodiscard]] FORCE_INLINE size_t GetClusterCountX() const noexcept
+		{
+			return mClusterCountX;
+		}
+
+		[[nodiscard]] FORCE_INLINE size_t GetClusterCountY() const noexcept
+		{
+			return mClusterCountY;
+		}
+
+		[[nodiscard]] FORCE_INLINE size_t GetClusterCountZ() const noexcept
+		{
+			return mClusterCountZ;
+		}
+
+		[[nodiscard]] FORCE_INLINE size_t GetClusterCount() const noexcept
+		{
+			return mSliceClusterCount * mClusterCountZ;
+		}
+
+		[[nodiscard]] FORCE_INLINE size_t GetClusterIndex(size_t x, size_t y, size_t z) const noexcept
+		{
+			return (z * mClusterCountY + y) * mClusterCountX + x;
+		}
+
+		[[nodiscard]] FORCE_INLINE float GetNearDepth() const noexcept
+		{
+			return mSliceDepths[0];
+		}
+
+		[[nodiscard]] FORCE_INLINE float GetFarDepth() const noexcept
+		{
+			return mSliceDepths[mClusterCountZ];
+		}
+
+		/// <summary>
+		/// Slice containing view depth ( distance along view direction ). Clamped to valid slice
+		/// Shader can find cluster of pixel with same formula
+		/// </summary>
+		[[nodiscard]] FORCE_INLINE size_t GetSliceIndex(float viewDepth) const noexcept
+		{
+			const float slice = std::log(math::Max(viewDepth, mSliceDepths[0]) / mSliceDepths[0]) * mSliceScale;
+			return math::Min(static_cast<size_t>(slice), mClusterCountZ - 1);
+		}
+
+		/// <summary>
+		/// View space bounds of cluster
+		/// </summary>
+		[[nodiscard]] AABB GetClusterAABB(size_t clusterIndex) const noexcept
+		{
+			const size_t boundIndex = (clusterIndex / mSliceClusterCount) * mPaddedSliceClusterCount + clusterIndex % mSliceClusterCount;
+			return AABB{
+				math::Vector<3, float>{ mClusterBounds[0][boundIndex], mClusterBounds[1][boundIndex], mClusterBounds[2][boundIndex] },
+				math::Vector<3, float>{ mClusterBounds[3][boundIndex], mClusterBounds[4][boundIndex], mClusterBounds[5][boundIndex] } };
+		}
+
+		/// <summary>
+		/// Offset of first light of each cluster in GetLightIndices()
+		/// </summary>
+		[[nodiscard]] FORCE_INLINE const std::vector<unsigned int>& GetClusterLightOffsets() const noexcept
+		{
+			return mClusterLightOffsets;
+		}
+
+		[[nodiscard]] FORCE_INLINE const std::vector<unsigned int>& GetClusterLightCounts() const noexcept
+		{
+			return mClusterLightCounts;
+		}
+
+		/// <summary>
+		/// Light lists of every cluster. List of cluster i is [ offsets[i], offsets[i] + counts[i] )
+		/// </summary>
+		[[nodiscard]] FORCE_INLINE const std::vector<unsigned int>& GetLightIndices() const noexcept
+		{
+			return mLightIndices;
+		}
+
+		/// <summary>
+		/// Build view space clusters from symmetric perspective projection ( made by perspective, perspectiveFov )
+		/// Near, far and handedness are taken from matrix. Depth range follows clip range of Policy
+		/// </summary>
+		template<typename Policy = CurrentClipSpace, std::enable_if_t<CHECK_IS_CLIP_SPACE_POLICY(Policy), bool> = true>
+		void SetProjection(const math::Matrix<4, 4, float>& projectionMatrix)
+		{
+			// clip w = forwardSign * view z, clip z = m22 * view z + m32
+			const float scaleX = projectionMatrix.columns[0][0];
+			const float scaleY = projectionMatrix.columns[1][1];
+			const float m22 = projectionMatrix.columns[2][2];
+			const float m32 = projectionMatrix.columns[3][2];
+			mForwardSign = projectionMatrix.columns[2][3];
+			assert(math::abs(mForwardSign) == 1.0f);
+
+			constexpr float nearNdcZ = (Policy::clipRange == ClipRange::NegativeOneToOne) ? -1.0f : 0.0f;
+			// ndc z * clip w = clip z -> view z = m32 / ( ndc z * forwardSign - m22 )
+			const float nearDepth = mForwardSign * m32 / (nearNdcZ * mForwardSign - m22);
+			const float farDepth = mForwardSign * m32 / (mForwardSign - m22);
+			assert(nearDepth > 0.0f && farDepth > nearDepth);
+
+			mSliceScale = static_cast<float>(mClusterCountZ) / std::log(farDepth / nearDepth);
+			for (size_t slice = 0; slice <= mClusterCountZ; ++slice)
+			{
+				mSliceDepths[slice] = nearDepth * std::pow(farDepth / nearDepth, static_cast<float>(slice) / static_cast<float>(mClusterCountZ));
+			}
+			mSliceDepths[mClusterCountZ] = farDepth;
+
+			for (size_t slice = 0; slice < mClusterCountZ; ++slice)
+			{
+				const float sliceNear = mSliceDepths[slice];
+				const float sliceFar = mSliceDepths[slice + 1];
+				const size_t sliceOffset = slice * mPaddedSliceClusterCount;
+
+				for (size_t y = 0; y < mClusterCountY; ++y)
+				{
+					const float ndcMinY = -1.0f + 2.0f * static_cast<float>(y) / static_cast<float>(mClusterCountY);
+					const float ndcMaxY = -1.0f + 2.0f * static_cast<float>(y + 1) / static_cast<float>(mClusterCountY);
+
+					for (size_t x = 0; x < mClusterCountX; ++x)
+					{
+						const float ndcMinX = -1.0f + 2.0f * static_cast<float>(x) / static_cast<float>(mClusterCountX);
+						const float ndcMaxX = -1.0f + 2.0f * static_cast<float>(x + 1) / static_cast<float>(mClusterCountX);
+
+						// view x = ndc x * depth / scaleX. extremes are on near or far face of slice
+						const size_t boundIndex = sliceOffset + y * mClusterCountX + x;
+						mClusterBounds[0][boundIndex] = math::Min(ndcMinX * sliceNear, ndcMinX * sliceFar) / scaleX;
+						mClusterBounds[1][boundIndex] = math::Min(ndcMinY * sliceNear, ndcMinY * sliceFar) / scaleY;
+						mClusterBounds[2][boundIndex] = math::Min(mForwardSign * sliceNear, mForwardSign * sliceFar);
+						mClusterBounds[3][boundIndex] = math::Max(ndcMaxX * sliceNear, ndcMaxX * sliceFar) / scaleX;
+						mClusterBounds[4][boundIndex] = math::Max(ndcMaxY * sliceNear, ndcMaxY * sliceFar) / scaleY;
+						mClusterBounds[5][boundIndex] = math::Max(mForwardSign * sliceNear, mForwardSign * sliceFar);
+					}
+				}
+
+				// padded clusters are inverted infinite boxes, nothing overlaps them
+				for (size_t boundIndex = sliceOffset + mSliceClusterCount; boundIndex < sliceOffset + mPaddedSliceClusterCount; ++boundIndex)
+				{
+					for (size_t component = 0; component < 3; ++component)
+					{
+						mClusterBounds[component][boundIndex] = math::infinity<float>();
+						mClusterBounds[component + 3][boundIndex] = math::negativeInfinity<float>();
+					}
+				}
+			}
+		}
+
+		/// <summary>
+		/// Assign lights to clusters. SetProjection should be called before
+		///
+		/// Point light i has light index i and spot light i has light index pointLightCount + i
+		/// Spot light is bounded by smallest sphere containing its cone
+		/// </summary>
+		/// <param name="viewMatrix">world space to view space</param>
+		/// <param name="pointLights">world space. xyz is position, radius is range. Should have GetSphereBlockCount(pointLightCount) blocks</param>
+		/// <param name="spotLights">world space. Should have GetSphereBlockCount(spotLightCount) blocks</param>
+		/// <returns>total count of light indices of every cluster</returns>
+		size_t AssignLights(const math::Matrix<4, 4, float>& viewMatrix, const SphereBlock8* pointLights, size_t pointLightCount, const SpotLightBlock8* spotLights, size_t spotLightCount)
+		{
+			BuildViewSpaceLights(viewMatrix, pointLights, pointLightCount, spotLights, spotLightCount);
+
+			math::ParallelFor(mClusterCountZ, mThreadCount, [this](size_t begin, size_t end, unsigned int)
+			{
+				for (size_t slice = begin; slice < end; ++slice)
+				{
+					AssignSliceLights(slice);
+				}
+			});
+
+			// slice lists are concatenated in slice order
+			std::vector<size_t> sliceIndexOffsets(mClusterCountZ + 1, 0);
+			for (size_t slice = 0; slice < mClusterCountZ; ++slice)
+			{
+				sliceIndexOffsets[slice + 1] = sliceIndexOffsets[slice] + mSliceLightIndexCounts[slice];
+			}
+			mLightIndices.resize(sliceIndexOffsets[mClusterCountZ]);
+
+			math::ParallelFor(mClusterCountZ, mThreadCount, [this, &sliceIndexOffsets](size_t begin, size_t end, unsigned int)
+			{
+				for (size_t slice = begin; slice < end; ++slice)
+				{
+					ScatterSliceLights(slice, sliceIndexOffsets[slice]);
+				}
+			});
+
+			return mLightIndices.size();
+		}
+
+	private:
+
+		void BuildViewSpaceLights(const math::Matrix<4, 4, float>& viewMatrix, const SphereBlock8* pointLights, size_t pointLightCount, const SpotLightBlock8* spotLights, size_t spotLightCount)
+		{
+			mLightSpheres.resize(pointLightCount + spotLightCount);
+
+			for (size_t lightIndex = 0; lightIndex < pointLightCount; ++lightIndex)
+			{
+				const SphereBlock8& block = pointLights[lightIndex / 8];
+				const size_t lane = lightIndex % 8;
+				const math::Vector<3, float> viewCenter = TransformPoint(viewMatrix, block.centerX[lane], block.centerY[lane], block.centerZ[lane]);
+				mLightSpheres[lightIndex] = math::Vector<4, float>{ viewCenter.x, viewCenter.y, viewCenter.z, block.radius[lane] };
+			}
+
+			for (size_t lightIndex = 0; lightIndex < spotLightCount; ++lightIndex)
+			{
+				const SpotLightBlock8& block = spotLights[lightIndex / 8];
+				const size_t lane = lightIndex % 8;
+				const math::Vector<3, float> viewPosition = TransformPoint(viewMatrix, block.positionX[lane], block.positionY[lane], block.positionZ[lane]);
+				math::Vector<3, float> viewDirection;
+				for (size_t row = 0; row < 3; ++row)
+				{
+					viewDirection[row] = viewMatrix.columns[0][row] * block.directionX[lane] + viewMatrix.columns[1][row] * block.directionY[lane] + viewMatrix.columns[2][row] * block.directionZ[lane];
+				}
+				mLightSpheres[pointLightCount + lightIndex] = detail::ComputeConeBoundingSphere(viewPosition, viewDirection, block.range[lane], block.baseRadius[lane]);
+			}
+		}
+
+		[[nodiscard]] static FORCE_INLINE math::Vector<3, float> TransformPoint(const math::Matrix<4, 4, float>& matrix, float x, float y, float z) noexcept
+		{
+			math::Vector<3, float> result;
+			for (size_t row = 0; row < 3; ++row)
+			{
+				result[row] = matrix.columns[0][row] * x + matrix.columns[1][row] * y + matrix.columns[2][row] * z + matrix.columns[3][row];
+			}
+			return result;
+		}
+
+		/// <summary>
+		/// Collect ( cluster, light ) pairs of slice and count lights of each cluster
+		/// Lights are visited in ascending order, so pairs of a cluster are already sorted
+		/// </summary>
+		void AssignSliceLights(size_t slice)
+		{
+			std::vector<OverlapPair>& pairs = mSlicePairs[slice];
+			pairs.clear();
+
+			const float sliceNear = mSliceDepths[slice];
+			const float sliceFar = mSliceDepths[slice + 1];
+			const size_t sliceOffset = slice * mPaddedSliceClusterCount;
+			const float* minX = mClusterBounds[0].data() + sliceOffset;
+			const float* minY = mClusterBounds[1].data() + sliceOffset;
+			const float* minZ = mClusterBounds[2].data() + sliceOffset;
+			const float* maxX = mClusterBounds[3].data() + sliceOffset;
+			const float* maxY = mClusterBounds[4].data() + sliceOffset;
+			const float* maxZ = mClusterBounds[5].data() + sliceOffset;
+
+			for (size_t lightIndex = 0; lightIndex < mLightSpheres.size(); ++lightIndex)
+			{
+				const math::Vector<4, float>& sphere = mLightSpheres[lightIndex];
+				const float viewDepth = mForwardSign * sphere.z;
+				if (viewDepth + sphere.w < sliceNear || viewDepth - sphere.w > sliceFar)
+				{
+					continue;
+				}
+
+				const float sqrRadius = sphere.w * sphere.w;
+
+#ifdef SIMD_ENABLED
+				const M256F centerX = _mm256_set1_ps(sphere.x);
+				const M256F centerY = _mm256_set1_ps(sphere.y);
+				const M256F centerZ = _mm256_set1_ps(sphere.z);
+				const M256F m256f_sqrRadius = _mm256_set1_ps(sqrRadius);
+				const M256F zero = _mm256_setzero_ps();
+
+				for (size_t clusterIndex = 0; clusterIndex < mPaddedSliceClusterCount; clusterIndex += 8)
+				{
+					// distance from sphere center to box on each axis. 0 when center is inside slab
+					const M256F distanceX = _mm256_max_ps(zero, _mm256_max_ps(M256F_SUB(_mm256_loadu_ps(minX + clusterIndex), centerX), M256F_SUB(centerX, _mm256_loadu_ps(maxX + clusterIndex))));
+					const M256F distanceY = _mm256_max_ps(zero, _mm256_max_ps(M256F_SUB(_mm256_loadu_ps(minY + clusterIndex), centerY), M256F_SUB(centerY, _mm256_loadu_ps(maxY + clusterIndex))));
+					const M256F distanceZ = _mm256_max_ps(zero, _mm256_max_ps(M256F_SUB(_mm256_loadu_ps(minZ + clusterIndex), centerZ), M256F_SUB(centerZ, _mm256_loadu_ps(maxZ + clusterIndex))));
+					const M256F sqrDistance = M256F_MUL_AND_ADD(distanceZ, distanceZ, M256F_MUL_AND_ADD(distanceY, distanceY, M256F_MUL(distanceX, distanceX)));
+
+					unsigned int overlapMask = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(sqrDistance, m256f_sqrRadius, _CMP_LE_OQ)));
+					while (overlapMask != 0)
+					{
+						const unsigned int lane = math::countTrailingZero(overlapMask);
+						overlapMask &= overlapMask - 1;
+						pairs.push_back(OverlapPair{ static_cast<unsigned int>(clusterIndex + lane), static_cast<unsigned int>(lightIndex) });
+					}
+				}
+#else
+				for (size_t clusterIndex = 0; clusterIndex < mSliceClusterCount; ++clusterIndex)
+				{
+					const float distanceX = math::Max(0.0f, math::Max(minX[clusterIndex] - sphere.x, sphere.x - maxX[clusterIndex]));
+					const float distanceY = math::Max(0.0f, math::Max(minY[clusterIndex] - sphere.y, sphere.y - maxY[clusterIndex]));
+					const float distanceZ = math::Max(0.0f, math::Max(minZ[clusterIndex] - sphere.z, sphere.z - maxZ[clusterIndex]));
+					if (distanceX * distanceX + distanceY * distanceY + distanceZ * distanceZ <= sqrRadius)
+					{
+						pairs.push_back(OverlapPair{ static_cast<unsigned int>(clusterIndex), static_cast<unsigned int>(lightIndex) });
+					}
+				}
+#endif
+			}
+
+			unsigned int* clusterLightCounts = mClusterLightCounts.data() + slice * mSliceClusterCount;
+			std::fill(clusterLightCounts, clusterLightCounts + mSliceClusterCount, 0u);
+			for (const OverlapPair& pair : pairs)
+			{
+				++clusterLightCounts[pair.indexA];
+			}
+			mSliceLightIndexCounts[slice] = pairs.size();
+		}
+
+		/// <summary>
+		/// Counting sort pairs of slice by cluster and write light indices from sliceIndexOffset
+		/// </summary>
+		void ScatterSliceLights(size_t slice, size_t sliceIndexOffset)
+		{
+			const unsigned int* clusterLightCounts = mClusterLightCounts.data() + slice * mSliceClusterCount;
+			unsigned int* clusterLightOffsets = mClusterLightOffsets.data() + slice * mSliceClusterCount;
+
+			unsigned int offset = static_cast<unsigned int>(sliceIndexOffset);
+			for (size_t clusterIndex = 0; clusterIndex < mSliceClusterCount; ++clusterIndex)
+			{
+				clusterLightOffsets[clusterIndex] = offset;
+				offset += clusterLightCounts[clusterIndex];
+			}
+
+			// use offsets as write cursors, then restore them
+			for (const OverlapPair& pair : mSlicePairs[slice])
+			{
+				mLightIndices[clusterLightOffsets[pair.indexA]++] = pair.indexB;
+			}
+			for (size_t clusterIndex = 0; clusterIndex < mSliceClusterCount; ++clusterIndex)
+			{
+				clusterLightOffsets[clusterIndex] -= clusterLightCounts[clusterIndex];
+			}
+		}
+
+		size_t mClusterCountX;
+		size_t mClusterCountY;
+		size_t mClusterCountZ;
+		size_t mSliceClusterCount;
+		/// <summary>
+		/// Cluster count of slice rounded up to multiple of 8
+		/// </summary>
+		size_t mPaddedSliceClusterCount;
+		unsigned int mThreadCount;
+
+		/// <summary>
+		/// sign of view z along view direction. -1 for right handed projection
+		/// </summary>
+		float mForwardSign = 1.0f;
+		/// <summary>
+		/// slice count / log(far / near)
+		/// </summary>
+		float mSliceScale = 0.0f;
+		std::vector<float> mSliceDepths;
+
+		/// <summary>
+		/// View space AABBs of clusters as SoA ( minX, minY, minZ, maxX, maxY, maxZ )
+		/// Clusters of each slice start from slice * mPaddedSliceClusterCount
+		/// </summary>
+		std::vector<float> mClusterBounds[6];
+
+		/// <summary>
+		/// View space bounding sphere of every light. xyz is center, w is radius
+		/// </summary>
+		std::vector<math::Vector<4, float>> mLightSpheres;
+		/// <summary>
+		/// ( cluster index in slice, light index ) pairs found in each slice
+		/// </summary>
+		std::vector<std::vector<OverlapPair>> mSlicePairs;
+		std::vector<size_t> mSliceLightIndexCounts;
+
+		std::vector<unsigned int> mClusterLightOffsets;
+		std::vector<unsigned int> mClusterLightCounts;
+		std::vector<unsigned int> mLightIndices;
+	};
+}
@@ -3,24 +3,272 @@
 #include "Vector2.h"
 #include "Vector3.h"
 
+#include "SIMD_Core.h"
+
 namespace math
 {
-	template <int ComponentCount, typename T>
+	template <size_t ComponentCount, typename T>
 	constexpr math::Vector<ComponentCount, T> ClosestPointOnSphere(const math::Vector<ComponentCount, T>& sphereCenter, float radius, const math::Vector<ComponentCount, T>& point)
 	{
 		//assert(radius > 0);
 		return (point - sphereCenter).normalized() * radius;
 	}
 
-	template <int ComponentCount, typename T>
+	template <size_t ComponentCount, typename T>
 	constexpr bool IsSphereOverlap(const math::Vector<ComponentCount, T>& sphereCenterA, float radiusA, const math::Vector<ComponentCount, T>& sphereCenterB, float radiusB)
 	{
-		return  math::pow(radiusA + radiusB, 2) > (sphereCenterA - sphereCenterB).sqrMagnitude();
+		const float radiusSum = radiusA + radiusB;
+		return radiusSum * radiusSum > (sphereCenterA - sphereCenterB).sqrMagnitude();
 	}
 
-	template <int ComponentCount, typename T>
+	template <size_t ComponentCount, typename T>
 	constexpr bool IsSphereOverlap(const math::Vector<ComponentCount, T>& sphereCenterA, float radiusA, const math::Vector<ComponentCount, T>& point)
 	{
-		return  math::pow(radiusA, 2) > (sphereCenterA - point).sqrMagnitude();
+		return radiusA * radiusA > (sphereCenterA - point).sqrMagnitude();
+	}
+
+	/// <summary>
+	/// Axis aligned bounding box
+	/// </summary>
+	struct AABB
+	{
+		math::Vector<3, float> minimum;
+		math::Vector<3, float> maximum;
+
+		AABB() noexcept = default;
+
+		FORCE_INLINE AABB(const math::Vector<3, float>& minimumValue, const math::Vector<3, float>& maximumValue) noexcept
+			: minimum{ minimumValue }, maximum{ maximumValue }
+		{
+		}
+
+		[[nodiscard]] FORCE_INLINE math::Vector<3, float> center() const noexcept
+		{
+			return (minimum + maximum) * 0.5f;
+		}
+
+		/// <summary>
+		/// half size of box
+		/// </summary>
+		[[nodiscard]] FORCE_INLINE math::Vector<3, float> extents() const noexcept
+		{
+			return (maximum - minimum) * 0.5f;
+		}
+
+		[[nodiscard]] FORCE_INLINE float surfaceArea() const noexcept
+		{
+			const math::Vector<3, float> size = maximum - minimum;
+			return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+		}
+
+		FORCE_INLINE void Merge(const AABB& aabb) noexcept
+		{
+			minimum = math::Min(minimum, aabb.minimum);
+			maximum = math::Max(maximum, aabb.maximum);
+		}
+	};
+
+	/// <summary>
+	/// Touching boxes are treated as overlapped
+	/// </summary>
+	[[nodiscard]] inline bool IsAABBOverlap(const AABB& aabbA, const AABB& aabbB) noexcept
+	{
+		return
+			aabbA.minimum.x <= aabbB.maximum.x && aabbA.maximum.x >= aabbB.minimum.x &&
+			aabbA.minimum.y <= aabbB.maximum.y && aabbA.maximum.y >= aabbB.minimum.y &&
+			aabbA.minimum.z <= aabbB.maximum.z && aabbA.maximum.z >= aabbB.minimum.z;
+	}
+
+	/// <summary>
+	/// Spheres stored as structure of arrays
+	/// x, y, z, radius should have at least count elements
+	/// arrays don't need to be aligned
+	/// </summary>
+	struct SphereArraySoA
+	{
+		const float* x;
+		const float* y;
+		const float* z;
+		const float* radius;
+		size_t count;
+	};
+
+	/// <summary>
+	/// AABBs stored as structure of arrays
+	/// every array should have at least count elements
+	/// arrays don't need to be aligned
+	/// </summary>
+	struct AABBArraySoA
+	{
+		const float* minX;
+		const float* minY;
+		const float* minZ;
+		const float* maxX;
+		const float* maxY;
+		const float* maxZ;
+		size_t count;
+	};
+
+	/// <summary>
+	/// Writable AABBArraySoA. Batched kernels write bounds to it
+	/// </summary>
+	struct MutableAABBArraySoA
+	{
+		float* minX;
+		float* minY;
+		float* minZ;
+		float* maxX;
+		float* maxY;
+		float* maxZ;
+		size_t count;
+
+		FORCE_INLINE operator AABBArraySoA() const noexcept
+		{
+			return AABBArraySoA{ minX, minY, minZ, maxX, maxY, maxZ, count };
+		}
+	};
+
+	/// <summary>
+	/// Index pair of two overlapped object
+	/// </summary>
+	struct OverlapPair
+	{
+		unsigned int indexA;
+		unsigned int indexB;
+	};
+
+	/// <summary>
+	/// Sphere count of one cache block.
+	/// A block of SphereArraySoA is 16 byte * SPHERE_OVERLAP_BLOCK_SIZE, two blocks should stay in L1 cache
+	/// </summary>
+	inline constexpr size_t SPHERE_OVERLAP_BLOCK_SIZE = 256;
+
+	namespace detail
+	{
+		FORCE_INLINE void PushOverlapPair(OverlapPair* outPairs, size_t maxPairCount, size_t& pairCount, size_t indexA, size_t indexB)
+		{
+			if (pairCount < maxPairCount)
+			{
+				outPairs[pairCount].indexA = static_cast<unsigned int>(indexA);
+				outPairs[pairCount].indexB = static_cast<unsigned int>(indexB);
+			}
+			++pairCount;
+		}
+
+		/// <summary>
+		/// Test spheresA[indexA] with spheresB[beginB] ~ spheresB[endB - 1]
+		/// 8 spheres are tested at once
+		/// </summary>
+		inline void TestSphereWithSphereRange(const SphereArraySoA& spheresA, size_t indexA, const SphereArraySoA& spheresB, size_t beginB, size_t endB, OverlapPair* outPairs, size_t maxPairCount, size_t& pairCount)
+		{
+			const float ax = spheresA.x[indexA];
+			const float ay = spheresA.y[indexA];
+			const float az = spheresA.z[indexA];
+			const float ar = spheresA.radius[indexA];
+
+			size_t indexB = beginB;
+
+#ifdef SIMD_ENABLED
+			const M256F m256f_ax = _mm256_set1_ps(ax);
+			const M256F m256f_ay = _mm256_set1_ps(ay);
+			const M256F m256f_az = _mm256_set1_ps(az);
+			const M256F m256f_ar = _mm256_set1_ps(ar);
+
+			for (; indexB + 8 <= endB; indexB += 8)
+			{
+				const M256F dx = M256F_SUB(_mm256_loadu_ps(spheresB.x + indexB), m256f_ax);
+				const M256F dy = M256F_SUB(_mm256_loadu_ps(spheresB.y + indexB), m256f_ay);
+				const M256F dz = M256F_SUB(_mm256_loadu_ps(spheresB.z + indexB), m256f_az);
+				const M256F radiusSum = M256F_ADD(_mm256_loadu_ps(spheresB.radius + indexB), m256f_ar);
+
+				M256F sqrDistance = M256F_MUL(dx, dx);
+				sqrDistance = M256F_MUL_AND_ADD(dy, dy, sqrDistance);
+				sqrDistance = M256F_MUL_AND_ADD(dz, dz, sqrDistance);
+
+				// same with scalar version : radiusSum * radiusSum > sqrDistance
+				unsigned int overlapMask = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(sqrDistance, M256F_MUL(radiusSum, radiusSum), _CMP_LT_OQ)));
+				while (overlapMask != 0)
+				{
+					const unsigned int lane = math::countTrailingZero(overlapMask);
+					overlapMask &= overlapMask - 1;
+					PushOverlapPair(outPairs, maxPairCount, pairCount, indexA, indexB + lane);
+				}
+			}
+#endif
+
+			for (; indexB < endB; ++indexB)
+			{
+				const float dx = spheresB.x[indexB] - ax;
+				const float dy = spheresB.y[indexB] - ay;
+				const float dz = spheresB.z[indexB] - az;
+				const float radiusSum = spheresB.radius[indexB] + ar;
+				if (radiusSum * radiusSum > dx * dx + dy * dy + dz * dz)
+				{
+					PushOverlapPair(outPairs, maxPairCount, pairCount, indexA, indexB);
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// Find every overlapped pair between spheresA and spheresB ( N x M )
+	///
+	/// Spheres are tested block by block ( SPHERE_OVERLAP_BLOCK_SIZE ) for cache locality
+	/// So pairs aren't sorted
+	/// </summary>
+	/// <param name="outPairs">caller provided buffer. indexA is index of spheresA, indexB is index of spheresB</param>
+	/// <param name="maxPairCount">element count of outPairs</param>
+	/// <returns>count of overlapped pairs. When it's larger than maxPairCount, only maxPairCount pairs are written</returns>
+	inline size_t FindSphereOverlapPairs(const SphereArraySoA& spheresA, const SphereArraySoA& spheresB, OverlapPair* outPairs, size_t maxPairCount)
+	{
+		size_t pairCount = 0;
+
+		for (size_t blockBeginA = 0; blockBeginA < spheresA.count; blockBeginA += SPHERE_OVERLAP_BLOCK_SIZE)
+		{
+			const size_t blockEndA = math::Min(blockBeginA + SPHERE_OVERLAP_BLOCK_SIZE, spheresA.count);
+
+			for (size_t blockBeginB = 0; blockBeginB < spheresB.count; blockBeginB += SPHERE_OVERLAP_BLOCK_SIZE)
+			{
+				const size_t blockEndB = math::Min(blockBeginB + SPHERE_OVERLAP_BLOCK_SIZE, spheresB.count);
+
+				for (size_t indexA = blockBeginA; indexA < blockEndA; ++indexA)
+				{
+					detail::TestSphereWithSphereRange(spheresA, indexA, spheresB, blockBeginB, blockEndB, outPairs, maxPairCount, pairCount);
+				}
+			}
+		}
+
+		return pairCount;
+	}
+
+	/// <summary>
+	/// Find every overlapped pair in spheres ( N x N )
+	/// Each pair is reported once and indexA is always smaller than indexB
+	/// </summary>
+	/// <param name="outPairs">caller provided buffer</param>
+	/// <param name="maxPairCount">element count of outPairs</param>
+	/// <returns>count of overlapped pairs. When it's larger than maxPairCount, only maxPairCount pairs are written</returns>
+	inline size_t FindSphereSelfOverlapPairs(const SphereArraySoA& spheres, OverlapPair* outPairs, size_t maxPairCount)
+	{
+		size_t pairCount = 0;
+
+		for (size_t blockBeginA = 0; blockBeginA < spheres.count; blockBeginA += SPHERE_OVERLAP_BLOCK_SIZE)
+		{
+			const size_t blockEndA = math::Min(blockBeginA + SPHERE_OVERLAP_BLOCK_SIZE, spheres.count);
+
+			// only upper triangle of block matrix
+			for (size_t blockBeginB = blockBeginA; blockBeginB < spheres.count; blockBeginB += SPHERE_OVERLAP_BLOCK_SIZE)
+			{
+				const size_t blockEndB = math::Min(blockBeginB + SPHERE_OVERLAP_BLOCK_SIZE, spheres.count);
+
+				for (size_t indexA = blockBeginA; indexA < blockEndA; ++indexA)
+				{
+					const size_t beginB = (blockBeginA == blockBeginB) ? indexA + 1 : blockBeginB;
+					detail::TestSphereWithSphereRange(spheres, indexA, spheres, beginB, blockEndB, outPairs, maxPairCount, pairCount);
+				}
+			}
+		}
+
+		return pairCount;
 	}
-}
\ No newline at end of file
+}
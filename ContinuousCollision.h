@@ -0,0 +1,552 @@
+#pragma once
+
+#include "LMath_Core.h"
+#include "Utility.h"
+#include "Vector3.h"
+#include "Collision.h"
+
+#include "SIMD_Core.h"
+
+namespace math
+{
+	inline constexpr unsigned int TOI_INVALID_INDEX = static_cast<unsigned int>(-1);
+
+	/// <summary>
+	/// Result of time of impact query
+	/// Moving body moves center + displacement * t ( 0 <= t <= 1 ) during a step
+	/// </summary>
+	struct TimeOfImpact
+	{
+		/// <summary>
+		/// fraction of displacement when bodies start touching. 0 when they are already overlapped
+		/// </summary>
+		float time;
+
+		/// <summary>
+		/// unit surface normal of hit body at contact. points from hit body to moving body
+		/// </summary>
+		math::Vector<3, float> normal;
+
+		/// <summary>
+		/// index of hit body in batched queries
+		/// </summary>
+		unsigned int index;
+	};
+
+	namespace detail
+	{
+		/// <summary>
+		/// Fallback when normal can't be computed from contact ( centers are same )
+		/// </summary>
+		FORCE_INLINE math::Vector<3, float> NormalizeOrUp(const math::Vector<3, float>& vector) noexcept
+		{
+			const float sqrMagnitude = math::dot(vector, vector);
+			return (sqrMagnitude > 0.0f) ? vector / std::sqrt(sqrMagnitude) : math::Vector<3, float>{ 0.0f, 1.0f, 0.0f };
+		}
+
+		/// <summary>
+		/// Earliest t in [0, 1] when origin + direction * t is inside of sphere
+		/// </summary>
+		/// <returns>infinity if not hit</returns>
+		inline float IntersectMovingPointSphere(const math::Vector<3, float>& origin, const math::Vector<3, float>& direction, const math::Vector<3, float>& sphereCenter, float radius) noexcept
+		{
+			const math::Vector<3, float> m = origin - sphereCenter;
+			const float c = math::dot(m, m) - radius * radius;
+			if (c <= 0.0f)
+			{
+				return 0.0f;
+			}
+
+			const float b = math::dot(m, direction);
+			const float a = math::dot(direction, direction);
+			if (b >= 0.0f || a <= 0.0f)
+			{
+				return math::infinity<float>();
+			}
+
+			const float discriminant = b * b - a * c;
+			if (discriminant < 0.0f)
+			{
+				return math::infinity<float>();
+			}
+
+			const float t = (-b - std::sqrt(discriminant)) / a;
+			return (t <= 1.0f) ? t : math::infinity<float>();
+		}
+
+		/// <summary>
+		/// Earliest t in [0, 1] when origin + direction * t is inside of capsule
+		/// reference : Real-Time Collision Detection, Christer Ericson, 5.3.7
+		/// </summary>
+		/// <returns>infinity if not hit</returns>
+		inline float IntersectMovingPointCapsule(const math::Vector<3, float>& origin, const math::Vector<3, float>& direction, const math::Vector<3, float>& segmentBegin, const math::Vector<3, float>& segmentEnd, float radius) noexcept
+		{
+			const math::Vector<3, float> axis = segmentEnd - segmentBegin;
+			const math::Vector<3, float> m = origin - segmentBegin;
+			const float axisDotAxis = math::dot(axis, axis);
+			const float axisDotDirection = math::dot(axis, direction);
+			const float axisDotM = math::dot(axis, m);
+
+			float t = math::infinity<float>();
+
+			// body of cylinder
+			const float a = axisDotAxis * math::dot(direction, direction) - axisDotDirection * axisDotDirection;
+			const float b = axisDotAxis * math::dot(m, direction) - axisDotM * axisDotDirection;
+			const float c = axisDotAxis * math::dot(m, m) - axisDotM * axisDotM - radius * radius * axisDotAxis;
+			if (c <= 0.0f && axisDotM >= 0.0f && axisDotM <= axisDotAxis)
+			{
+				return 0.0f;
+			}
+			if (a > 0.0f && b < 0.0f)
+			{
+				const float discriminant = b * b - a * c;
+				if (discriminant >= 0.0f)
+				{
+					const float cylinderT = (-b - std::sqrt(discriminant)) / a;
+					const float segmentParameter = axisDotM + cylinderT * axisDotDirection;
+					if (cylinderT >= 0.0f && cylinderT <= 1.0f && segmentParameter >= 0.0f && segmentParameter <= axisDotAxis)
+					{
+						t = cylinderT;
+					}
+				}
+			}
+
+			// caps
+			t = math::Min(t, IntersectMovingPointSphere(origin, direction, segmentBegin, radius));
+			t = math::Min(t, IntersectMovingPointSphere(origin, direction, segmentEnd, radius));
+			return t;
+		}
+
+		FORCE_INLINE math::Vector<3, float> GetAABBCorner(const AABB& aabb, unsigned int cornerBits) noexcept
+		{
+			return math::Vector<3, float>
+			{
+				(cornerBits & 1) ? aabb.maximum.x : aabb.minimum.x,
+				(cornerBits & 2) ? aabb.maximum.y : aabb.minimum.y,
+				(cornerBits & 4) ? aabb.maximum.z : aabb.minimum.z
+			};
+		}
+
+		/// <summary>
+		/// Slab test of moving point with box in t = [0, 1]
+		/// Axis whose direction is 0 is tested only with origin
+		/// </summary>
+		/// <param name="outEnterAxis">axis where point enters box. 3 when origin is already inside</param>
+		/// <returns>t when point enters box. infinity if not hit</returns>
+		inline float IntersectMovingPointAABB(const math::Vector<3, float>& origin, const math::Vector<3, float>& direction, const AABB& aabb, unsigned int* outEnterAxis = nullptr) noexcept
+		{
+			float tEnter = 0.0f;
+			float tExit = 1.0f;
+			unsigned int enterAxis = 3;
+			for (unsigned int axis = 0; axis < 3; ++axis)
+			{
+				if (direction[axis] == 0.0f)
+				{
+					if (origin[axis] < aabb.minimum[axis] || origin[axis] > aabb.maximum[axis])
+					{
+						return math::infinity<float>();
+					}
+					continue;
+				}
+
+				const float inverseDirection = 1.0f / direction[axis];
+				float t1 = (aabb.minimum[axis] - origin[axis]) * inverseDirection;
+				float t2 = (aabb.maximum[axis] - origin[axis]) * inverseDirection;
+				if (t1 > t2)
+				{
+					std::swap(t1, t2);
+				}
+				if (t1 > tEnter)
+				{
+					tEnter = t1;
+					enterAxis = axis;
+				}
+				tExit = math::Min(tExit, t2);
+				if (tEnter > tExit)
+				{
+					return math::infinity<float>();
+				}
+			}
+
+			if (outEnterAxis != nullptr)
+			{
+				*outEnterAxis = enterAxis;
+			}
+			return tEnter;
+		}
+	}
+
+	/// <summary>
+	/// Moving sphere with static sphere
+	/// </summary>
+	/// <returns>true if spheres touch in a step</returns>
+	inline bool ComputeSphereSphereTOI(const math::Vector<3, float>& center, float radius, const math::Vector<3, float>& displacement, const math::Vector<3, float>& otherCenter, float otherRadius, TimeOfImpact& outTimeOfImpact) noexcept
+	{
+		const float t = detail::IntersectMovingPointSphere(center, displacement, otherCenter, radius + otherRadius);
+		if (t > 1.0f)
+		{
+			return false;
+		}
+
+		outTimeOfImpact.time = t;
+		outTimeOfImpact.normal = detail::NormalizeOrUp(center + displacement * t - otherCenter);
+		outTimeOfImpact.index = 0;
+		return true;
+	}
+
+	/// <summary>
+	/// Moving sphere with static AABB
+	/// Sphere touches box when its center enters box expanded by radius with rounded edges and corners
+	/// After slab test with expanded box, edge and corner regions are tested with capsules of box edges
+	///
+	/// reference : Real-Time Collision Detection, Christer Ericson, 5.5.7
+	/// </summary>
+	/// <returns>true if sphere touches box in a step</returns>
+	inline bool ComputeSphereAABBTOI(const math::Vector<3, float>& center, float radius, const math::Vector<3, float>& displacement, const AABB& aabb, TimeOfImpact& outTimeOfImpact) noexcept
+	{
+		const AABB expandedAABB{ aabb.minimum - radius, aabb.maximum + radius };
+		float t = detail::IntersectMovingPointAABB(center, displacement, expandedAABB);
+		if (t > 1.0f)
+		{
+			return false;
+		}
+
+		const math::Vector<3, float> point = center + displacement * t;
+		unsigned int belowMinimumBits = 0;
+		unsigned int aboveMaximumBits = 0;
+		for (unsigned int axis = 0; axis < 3; ++axis)
+		{
+			if (point[axis] < aabb.minimum[axis])
+			{
+				belowMinimumBits |= 1u << axis;
+			}
+			if (point[axis] > aabb.maximum[axis])
+			{
+				aboveMaximumBits |= 1u << axis;
+			}
+		}
+
+		const unsigned int outsideBits = belowMinimumBits | aboveMaximumBits;
+		const unsigned int outsideAxisCount = (outsideBits & 1) + ((outsideBits >> 1) & 1) + ((outsideBits >> 2) & 1);
+
+		if (outsideAxisCount == 3)
+		{
+			// corner region. test 3 edges meeting at corner
+			const math::Vector<3, float> corner = detail::GetAABBCorner(aabb, aboveMaximumBits);
+			t = math::infinity<float>();
+			for (unsigned int axis = 0; axis < 3; ++axis)
+			{
+				t = math::Min(t, detail::IntersectMovingPointCapsule(center, displacement, corner, detail::GetAABBCorner(aabb, aboveMaximumBits ^ (1u << axis)), radius));
+			}
+		}
+		else if (outsideAxisCount == 2)
+		{
+			// edge region. edge is parallel to inside axis
+			t = detail::IntersectMovingPointCapsule(center, displacement, detail::GetAABBCorner(aabb, belowMinimumBits ^ 7), detail::GetAABBCorner(aabb, aboveMaximumBits), radius);
+		}
+
+		if (t > 1.0f)
+		{
+			return false;
+		}
+
+		const math::Vector<3, float> contactCenter = center + displacement * t;
+		const math::Vector<3, float> closestPoint = math::Min(math::Max(contactCenter, aabb.minimum), aabb.maximum);
+		outTimeOfImpact.time = t;
+		outTimeOfImpact.normal = detail::NormalizeOrUp((contactCenter == closestPoint) ? contactCenter - aabb.center() : contactCenter - closestPoint);
+		outTimeOfImpact.index = 0;
+		return true;
+	}
+
+	/// <summary>
+	/// Moving AABB with static AABB
+	/// Slab test of center of moving box with static box expanded by extents of moving box
+	/// </summary>
+	/// <returns>true if boxes touch in a step</returns>
+	inline bool ComputeAABBAABBTOI(const AABB& aabb, const math::Vector<3, float>& displacement, const AABB& otherAABB, TimeOfImpact& outTimeOfImpact) noexcept
+	{
+		const math::Vector<3, float> extents = aabb.extents();
+		const math::Vector<3, float> center = aabb.center();
+		const AABB expandedAABB{ otherAABB.minimum - extents, otherAABB.maximum + extents };
+
+		unsigned int enterAxis;
+		const float t = detail::IntersectMovingPointAABB(center, displacement, expandedAABB, &enterAxis);
+		if (t > 1.0f)
+		{
+			return false;
+		}
+
+		math::Vector<3, float> normal{ 0.0f, 0.0f, 0.0f };
+		if (enterAxis < 3)
+		{
+			normal[enterAxis] = (displacement[enterAxis] > 0.0f) ? -1.0f : 1.0f;
+		}
+		else
+		{
+			// already overlapped. axis of smallest penetration
+			const math::Vector<3, float> otherCenter = otherAABB.center();
+			float smallestPenetration = math::infinity<float>();
+			unsigned int smallestAxis = 0;
+			for (unsigned int axis = 0; axis < 3; ++axis)
+			{
+				const float penetration = math::Min(expandedAABB.maximum[axis] - center[axis], center[axis] - expandedAABB.minimum[axis]);
+				if (penetration < smallestPenetration)
+				{
+					smallestPenetration = penetration;
+					smallestAxis = axis;
+				}
+			}
+			normal[smallestAxis] = (center[smallestAxis] >= otherCenter[smallestAxis]) ? 1.0f : -1.0f;
+		}
+
+		outTimeOfImpact.time = t;
+		outTimeOfImpact.normal = normal;
+		outTimeOfImpact.index = 0;
+		return true;
+	}
+
+	/// <summary>
+	/// Find earliest static sphere hit by moving sphere
+	/// 8 spheres are tested at once
+	/// </summary>
+	/// <returns>true if any sphere is hit. outTimeOfImpact.index is index of spheres</returns>
+	inline bool FindEarliestSphereSphereTOI(const math::Vector<3, float>& center, float radius, const math::Vector<3, float>& displacement, const SphereArraySoA& spheres, TimeOfImpact& outTimeOfImpact) noexcept
+	{
+		float earliestTime = math::infinity<float>();
+		unsigned int earliestIndex = TOI_INVALID_INDEX;
+		size_t sphereIndex = 0;
+
+#ifdef SIMD_ENABLED
+		const M256F centerX = _mm256_set1_ps(center.x);
+		const M256F centerY = _mm256_set1_ps(center.y);
+		const M256F centerZ = _mm256_set1_ps(center.z);
+		const M256F displacementX = _mm256_set1_ps(displacement.x);
+		const M256F displacementY = _mm256_set1_ps(displacement.y);
+		const M256F displacementZ = _mm256_set1_ps(displacement.z);
+		const M256F m256f_radius = _mm256_set1_ps(radius);
+		const M256F a = _mm256_set1_ps(math::dot(displacement, displacement));
+		const M256F zero = _mm256_setzero_ps();
+
+		for (; sphereIndex + 8 <= spheres.count; sphereIndex += 8)
+		{
+			const M256F mX = M256F_SUB(centerX, _mm256_loadu_ps(spheres.x + sphereIndex));
+			const M256F mY = M256F_SUB(centerY, _mm256_loadu_ps(spheres.y + sphereIndex));
+			const M256F mZ = M256F_SUB(centerZ, _mm256_loadu_ps(spheres.z + sphereIndex));
+			const M256F radiusSum = M256F_ADD(m256f_radius, _mm256_loadu_ps(spheres.radius + sphereIndex));
+
+			const M256F c = M256F_SUB(M256F_MUL_AND_ADD(mZ, mZ, M256F_MUL_AND_ADD(mY, mY, M256F_MUL(mX, mX))), M256F_MUL(radiusSum, radiusSum));
+			const M256F b = M256F_MUL_AND_ADD(mZ, displacementZ, M256F_MUL_AND_ADD(mY, displacementY, M256F_MUL(mX, displacementX)));
+			const M256F discriminant = M256F_SUB(M256F_MUL(b, b), M256F_MUL(a, c));
+
+			// approaching and real root
+			const M256F isHit = _mm256_and_ps(_mm256_cmp_ps(b, zero, _CMP_LT_OQ), _mm256_cmp_ps(discriminant, zero, _CMP_GE_OQ));
+			M256F t = M256F_DIV(M256F_SUB(M256F_SUB(zero, b), _mm256_sqrt_ps(_mm256_max_ps(discriminant, zero))), a);
+			t = _mm256_blendv_ps(_mm256_set1_ps(math::infinity<float>()), t, isHit);
+
+			// already overlapped
+			t = _mm256_blendv_ps(t, zero, _mm256_cmp_ps(c, zero, _CMP_LE_OQ));
+
+			unsigned int candidateMask = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(t, _mm256_set1_ps(math::Min(earliestTime, 1.0f)), _CMP_LE_OQ)));
+			if (candidateMask != 0)
+			{
+				alignas(32) float times[8];
+				_mm256_store_ps(times, t);
+				while (candidateMask != 0)
+				{
+					const unsigned int lane = math::countTrailingZero(candidateMask);
+					candidateMask &= candidateMask - 1;
+					if (times[lane] < earliestTime)
+					{
+						earliestTime = times[lane];
+						earliestIndex = static_cast<unsigned int>(sphereIndex + lane);
+					}
+				}
+			}
+		}
+#endif
+
+		for (; sphereIndex < spheres.count; ++sphereIndex)
+		{
+			const float t = detail::IntersectMovingPointSphere(center, displacement, math::Vector<3, float>{ spheres.x[sphereIndex], spheres.y[sphereIndex], spheres.z[sphereIndex] }, radius + spheres.radius[sphereIndex]);
+			if (t <= 1.0f && t < earliestTime)
+			{
+				earliestTime = t;
+				earliestIndex = static_cast<unsigned int>(sphereIndex);
+			}
+		}
+
+		if (earliestIndex == TOI_INVALID_INDEX)
+		{
+			return false;
+		}
+
+		const math::Vector<3, float> otherCenter{ spheres.x[earliestIndex], spheres.y[earliestIndex], spheres.z[earliestIndex] };
+		outTimeOfImpact.time = earliestTime;
+		outTimeOfImpact.normal = detail::NormalizeOrUp(center + displacement * earliestTime - otherCenter);
+		outTimeOfImpact.index = earliestIndex;
+		return true;
+	}
+
+	namespace detail
+	{
+#ifdef SIMD_ENABLED
+		/// <summary>
+		/// Slab test of moving point with 8 boxes in t = [0, 1]
+		/// Axes whose direction is 0 should be passed with isStaticAxis
+		/// </summary>
+		/// <returns>t when point enters box. +infinity for lanes not hit</returns>
+		FORCE_INLINE M256F IntersectMovingPointAABB8(const math::Vector<3, float>& origin, const math::Vector<3, float>& inverseDirection, const bool* isStaticAxis, const M256F* minimum, const M256F* maximum)
+		{
+			M256F tEnter = _mm256_setzero_ps();
+			M256F tExit = _mm256_set1_ps(1.0f);
+			M256F isHit = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+			for (unsigned int axis = 0; axis < 3; ++axis)
+			{
+				const M256F m256f_origin = _mm256_set1_ps(origin[axis]);
+				if (isStaticAxis[axis] == true)
+				{
+					isHit = _mm256_and_ps(isHit, _mm256_cmp_ps(minimum[axis], m256f_origin, _CMP_LE_OQ));
+					isHit = _mm256_and_ps(isHit, _mm256_cmp_ps(maximum[axis], m256f_origin, _CMP_GE_OQ));
+					continue;
+				}
+
+				const M256F m256f_inverseDirection = _mm256_set1_ps(inverseDirection[axis]);
+				const M256F t1 = M256F_MUL(M256F_SUB(minimum[axis], m256f_origin), m256f_inverseDirection);
+				const M256F t2 = M256F_MUL(M256F_SUB(maximum[axis], m256f_origin), m256f_inverseDirection);
+				tEnter = _mm256_max_ps(tEnter, _mm256_min_ps(t1, t2));
+				tExit = _mm256_min_ps(tExit, _mm256_max_ps(t1, t2));
+			}
+
+			isHit = _mm256_and_ps(isHit, _mm256_cmp_ps(tEnter, tExit, _CMP_LE_OQ));
+			return _mm256_blendv_ps(_mm256_set1_ps(math::infinity<float>()), tEnter, isHit);
+		}
+#endif
+	}
+
+	/// <summary>
+	/// Find earliest static box hit by moving sphere
+	/// 8 boxes expanded by radius are tested at once. Only boxes hit by it are tested with rounded edges and corners
+	/// </summary>
+	/// <returns>true if any box is hit. outTimeOfImpact.index is index of boxes</returns>
+	inline bool FindEarliestSphereAABBTOI(const math::Vector<3, float>& center, float radius, const math::Vector<3, float>& displacement, const AABBArraySoA& boxes, TimeOfImpact& outTimeOfImpact) noexcept
+	{
+		TimeOfImpact earliestTimeOfImpact{ math::infinity<float>(), math::Vector<3, float>{}, TOI_INVALID_INDEX };
+		size_t boxIndex = 0;
+
+		const auto testBox = [&](size_t index)
+		{
+			const AABB aabb{ math::Vector<3, float>{ boxes.minX[index], boxes.minY[index], boxes.minZ[index] }, math::Vector<3, float>{ boxes.maxX[index], boxes.maxY[index], boxes.maxZ[index] } };
+			TimeOfImpact timeOfImpact;
+			if (ComputeSphereAABBTOI(center, radius, displacement, aabb, timeOfImpact) == true && timeOfImpact.time < earliestTimeOfImpact.time)
+			{
+				earliestTimeOfImpact = timeOfImpact;
+				earliestTimeOfImpact.index = static_cast<unsigned int>(index);
+			}
+		};
+
+#ifdef SIMD_ENABLED
+		const bool isStaticAxis[3]{ displacement.x == 0.0f, displacement.y == 0.0f, displacement.z == 0.0f };
+		const math::Vector<3, float> inverseDirection{ 1.0f / displacement.x, 1.0f / displacement.y, 1.0f / displacement.z };
+		const M256F m256f_radius = _mm256_set1_ps(radius);
+
+		for (; boxIndex + 8 <= boxes.count; boxIndex += 8)
+		{
+			const M256F minimum[3]{ M256F_SUB(_mm256_loadu_ps(boxes.minX + boxIndex), m256f_radius), M256F_SUB(_mm256_loadu_ps(boxes.minY + boxIndex), m256f_radius), M256F_SUB(_mm256_loadu_ps(boxes.minZ + boxIndex), m256f_radius) };
+			const M256F maximum[3]{ M256F_ADD(_mm256_loadu_ps(boxes.maxX + boxIndex), m256f_radius), M256F_ADD(_mm256_loadu_ps(boxes.maxY + boxIndex), m256f_radius), M256F_ADD(_mm256_loadu_ps(boxes.maxZ + boxIndex), m256f_radius) };
+			const M256F t = detail::IntersectMovingPointAABB8(center, inverseDirection, isStaticAxis, minimum, maximum);
+
+			// exact time is never earlier than time of expanded box
+			unsigned int candidateMask = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(t, _mm256_set1_ps(math::Min(earliestTimeOfImpact.time, 1.0f)), _CMP_LE_OQ)));
+			while (candidateMask != 0)
+			{
+				const unsigned int lane = math::countTrailingZero(candidateMask);
+				candidateMask &= candidateMask - 1;
+				testBox(boxIndex + lane);
+			}
+		}
+#endif
+
+		for (; boxIndex < boxes.count; ++boxIndex)
+		{
+			testBox(boxIndex);
+		}
+
+		if (earliestTimeOfImpact.index == TOI_INVALID_INDEX)
+		{
+			return false;
+		}
+		outTimeOfImpact = earliestTimeOfImpact;
+		return true;
+	}
+
+	/// <summary>
+	/// Find earliest static box hit by moving box
+	/// 8 boxes are tested at once
+	/// </summary>
+	/// <returns>true if any box is hit. outTimeOfImpact.index is index of boxes</returns>
+	inline bool FindEarliestAABBAABBTOI(const AABB& aabb, const math::Vector<3, float>& displacement, const AABBArraySoA& boxes, TimeOfImpact& outTimeOfImpact) noexcept
+	{
+		float earliestTime = math::infinity<float>();
+		unsigned int earliestIndex = TOI_INVALID_INDEX;
+		size_t boxIndex = 0;
+
+		const math::Vector<3, float> center = aabb.center();
+		const math::Vector<3, float> extents = aabb.extents();
+
+#ifdef SIMD_ENABLED
+		const bool isStaticAxis[3]{ displacement.x == 0.0f, displacement.y == 0.0f, displacement.z == 0.0f };
+		const math::Vector<3, float> inverseDirection{ 1.0f / displacement.x, 1.0f / displacement.y, 1.0f / displacement.z };
+		const M256F extentX = _mm256_set1_ps(extents.x);
+		const M256F extentY = _mm256_set1_ps(extents.y);
+		const M256F extentZ = _mm256_set1_ps(extents.z);
+
+		for (; boxIndex + 8 <= boxes.count; boxIndex += 8)
+		{
+			const M256F minimum[3]{ M256F_SUB(_mm256_loadu_ps(boxes.minX + boxIndex), extentX), M256F_SUB(_mm256_loadu_ps(boxes.minY + boxIndex), extentY), M256F_SUB(_mm256_loadu_ps(boxes.minZ + boxIndex), extentZ) };
+			const M256F maximum[3]{ M256F_ADD(_mm256_loadu_ps(boxes.maxX + boxIndex), extentX), M256F_ADD(_mm256_loadu_ps(boxes.maxY + boxIndex), extentY), M256F_ADD(_mm256_loadu_ps(boxes.maxZ + boxIndex), extentZ) };
+			const M256F t = detail::IntersectMovingPointAABB8(center, inverseDirection, isStaticAxis, minimum, maximum);
+
+			unsigned int candidateMask = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(t, _mm256_set1_ps(math::Min(earliestTime, 1.0f)), _CMP_LE_OQ)));
+			if (candidateMask != 0)
+			{
+				alignas(32) float times[8];
+				_mm256_store_ps(times, t);
+				while (candidateMask != 0)
+				{
+					const unsigned int lane = math::countTrailingZero(candidateMask);
+					candidateMask &= candidateMask - 1;
+					if (times[lane] < earliestTime)
+					{
+						earliestTime = times[lane];
+						earliestIndex = static_cast<unsigned int>(boxIndex + lane);
+					}
+				}
+			}
+		}
+#endif
+
+		for (; boxIndex < boxes.count; ++boxIndex)
+		{
+			const AABB expandedAABB{ math::Vector<3, float>{ boxes.minX[boxIndex], boxes.minY[boxIndex], boxes.minZ[boxIndex] } - extents, math::Vector<3, float>{ boxes.maxX[boxIndex], boxes.maxY[boxIndex], boxes.maxZ[boxIndex] } + extents };
+			const float t = detail::IntersectMovingPointAABB(center, displacement, expandedAABB);
+			if (t <= 1.0f && t < earliestTime)
+			{
+				earliestTime = t;
+				earliestIndex = static_cast<unsigned int>(boxIndex);
+			}
+		}
+
+		if (earliestIndex == TOI_INVALID_INDEX)
+		{
+			return false;
+		}
+
+		// normal of earliest box only
+		const AABB otherAABB{ math::Vector<3, float>{ boxes.minX[earliestIndex], boxes.minY[earliestIndex], boxes.minZ[earliestIndex] }, math::Vector<3, float>{ boxes.maxX[earliestIndex], boxes.maxY[earliestIndex], boxes.maxZ[earliestIndex] } };
+		ComputeAABBAABBTOI(aabb, displacement, otherAABB, outTimeOfImpact);
+		outTimeOfImpact.time = earliestTime;
+		outTimeOfImpact.index = earliestIndex;
+		return true;
+	}
+}
@@ -0,0 +1,874 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "LMath_Core.h"
+#include "Utility.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix4x4.h"
+#include "Collision.h"
+
+#include "SIMD_Core.h"
+
+namespace math
+{
+	/// <summary>
+	/// World space AABB of local AABB transformed by worldMatrix
+	/// Center is transformed by matrix and extents are transformed by absolute value of rotation and scale part
+	///
+	/// reference : Transforming Axis-Aligned Bounding Boxes, James Arvo, Graphics Gems
+	/// </summary>
+	[[nodiscard]] inline AABB TransformAABB(const math::Matrix<4, 4, float>& worldMatrix, const AABB& localAABB) noexcept
+	{
+		const math::Vector<3, float> localCenter = localAABB.center();
+		const math::Vector<3, float> localExtents = localAABB.extents();
+
+		math::Vector<3, float> worldCenter;
+		math::Vector<3, float> worldExtents;
+		for (size_t row = 0; row < 3; ++row)
+		{
+			worldCenter[row] = worldMatrix.columns[0][row] * localCenter.x + worldMatrix.columns[1][row] * localCenter.y + worldMatrix.columns[2][row] * localCenter.z + worldMatrix.columns[3][row];
+			worldExtents[row] = math::abs(worldMatrix.columns[0][row]) * localExtents.x + math::abs(worldMatrix.columns[1][row]) * localExtents.y + math::abs(worldMatrix.columns[2][row]) * localExtents.z;
+		}
+
+		return AABB{ worldCenter - worldExtents, worldCenter + worldExtents };
+	}
+
+	namespace detail
+	{
+#ifdef SIMD_ENABLED
+		/// <summary>
+		/// Load 8 Vector4 placed every floatStride floats and transpose them to x, y, z, w lanes
+		/// every Vector4 should be aligned to 16 byte
+		/// </summary>
+		FORCE_INLINE void LoadTransposedVector4x8(const float* vectors, size_t floatStride, M256F& outX, M256F& outY, M256F& outZ, M256F& outW)
+		{
+			// low 128 bit is vector 0 ~ 3, high 128 bit is vector 4 ~ 7
+			M256F rows[4];
+			for (size_t vectorIndex = 0; vectorIndex < 4; ++vectorIndex)
+			{
+				rows[vectorIndex] = _mm256_insertf128_ps
+				(
+					_mm256_castps128_ps256(_mm_load_ps(vectors + vectorIndex * floatStride)),
+					_mm_load_ps(vectors + (vectorIndex + 4) * floatStride),
+					1
+				);
+			}
+
+			// 4x4 transpose in each 128 bit lane
+			const M256F xy01 = _mm256_unpacklo_ps(rows[0], rows[1]);
+			const M256F xy23 = _mm256_unpacklo_ps(rows[2], rows[3]);
+			const M256F zw01 = _mm256_unpackhi_ps(rows[0], rows[1]);
+			const M256F zw23 = _mm256_unpackhi_ps(rows[2], rows[3]);
+			outX = _mm256_shuffle_ps(xy01, xy23, SHUFFLEMASK(0, 1, 0, 1));
+			outY = _mm256_shuffle_ps(xy01, xy23, SHUFFLEMASK(2, 3, 2, 3));
+			outZ = _mm256_shuffle_ps(zw01, zw23, SHUFFLEMASK(0, 1, 0, 1));
+			outW = _mm256_shuffle_ps(zw01, zw23, SHUFFLEMASK(2, 3, 2, 3));
+		}
+
+		/// <summary>
+		/// Load x, y, z of columns[columnIndex] of 8 matrices to lanes
+		/// </summary>
+		FORCE_INLINE void LoadMatrixColumn8(const math::Matrix<4, 4, float>* matrices, size_t columnIndex, M256F& outX, M256F& outY, M256F& outZ)
+		{
+			M256F w;
+			LoadTransposedVector4x8(matrices->columns[columnIndex].data(), sizeof(math::Matrix<4, 4, float>) / sizeof(float), outX, outY, outZ, w);
+		}
+#endif
+	}
+
+	/// <summary>
+	/// World space AABBs of local AABBs transformed by their world matrices
+	/// worldMatrices[i] transforms localAABBs i th box. 8 boxes are transformed at once
+	/// outWorldAABBs can be passed to culling kernels taking AABBArraySoA
+	///
+	/// reference : Transforming Axis-Aligned Bounding Boxes, James Arvo, Graphics Gems
+	/// </summary>
+	/// <param name="outWorldAABBs">every array should have at least localAABBs.count elements. its count is not used</param>
+	inline void TransformAABBs(const math::Matrix<4, 4, float>* worldMatrices, const AABBArraySoA& localAABBs, const MutableAABBArraySoA& outWorldAABBs) noexcept
+	{
+		size_t boxIndex = 0;
+
+#ifdef SIMD_ENABLED
+		const M256F half = _mm256_set1_ps(0.5f);
+		const M256F signMask = _mm256_set1_ps(-0.0f);
+
+		for (; boxIndex + 8 <= localAABBs.count; boxIndex += 8)
+		{
+			const M256F localMinX = _mm256_loadu_ps(localAABBs.minX + boxIndex);
+			const M256F localMinY = _mm256_loadu_ps(localAABBs.minY + boxIndex);
+			const M256F localMinZ = _mm256_loadu_ps(localAABBs.minZ + boxIndex);
+			const M256F localMaxX = _mm256_loadu_ps(localAABBs.maxX + boxIndex);
+			const M256F localMaxY = _mm256_loadu_ps(localAABBs.maxY + boxIndex);
+			const M256F localMaxZ = _mm256_loadu_ps(localAABBs.maxZ + boxIndex);
+
+			const M256F localCenter[3]{ M256F_MUL(M256F_ADD(localMinX, localMaxX), half), M256F_MUL(M256F_ADD(localMinY, localMaxY), half), M256F_MUL(M256F_ADD(localMinZ, localMaxZ), half) };
+			const M256F localExtents[3]{ M256F_MUL(M256F_SUB(localMaxX, localMinX), half), M256F_MUL(M256F_SUB(localMaxY, localMinY), half), M256F_MUL(M256F_SUB(localMaxZ, localMinZ), half) };
+
+			// start from translation
+			M256F worldCenter[3];
+			detail::LoadMatrixColumn8(worldMatrices + boxIndex, 3, worldCenter[0], worldCenter[1], worldCenter[2]);
+			M256F worldExtents[3]{ _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps() };
+
+			for (size_t columnIndex = 0; columnIndex < 3; ++columnIndex)
+			{
+				M256F column[3];
+				detail::LoadMatrixColumn8(worldMatrices + boxIndex, columnIndex, column[0], column[1], column[2]);
+				for (size_t row = 0; row < 3; ++row)
+				{
+					worldCenter[row] = M256F_MUL_AND_ADD(column[row], localCenter[columnIndex], worldCenter[row]);
+					worldExtents[row] = M256F_MUL_AND_ADD(_mm256_andnot_ps(signMask, column[row]), localExtents[columnIndex], worldExtents[row]);
+				}
+			}
+
+			_mm256_storeu_ps(outWorldAABBs.minX + boxIndex, M256F_SUB(worldCenter[0], worldExtents[0]));
+			_mm256_storeu_ps(outWorldAABBs.minY + boxIndex, M256F_SUB(worldCenter[1], worldExtents[1]));
+			_mm256_storeu_ps(outWorldAABBs.minZ + boxIndex, M256F_SUB(worldCenter[2], worldExtents[2]));
+			_mm256_storeu_ps(outWorldAABBs.maxX + boxIndex, M256F_ADD(worldCenter[0], worldExtents[0]));
+			_mm256_storeu_ps(outWorldAABBs.maxY + boxIndex, M256F_ADD(worldCenter[1], worldExtents[1]));
+			_mm256_storeu_ps(outWorldAABBs.maxZ + boxIndex, M256F_ADD(worldCenter[2], worldExtents[2]));
+		}
+#endif
+
+		for (; boxIndex < localAABBs.count; ++boxIndex)
+		{
+			const AABB localAABB
+			{
+				math::Vector<3, float>{ localAABBs.minX[boxIndex], localAABBs.minY[boxIndex], localAABBs.minZ[boxIndex] },
+				math::Vector<3, float>{ localAABBs.maxX[boxIndex], localAABBs.maxY[boxIndex], localAABBs.maxZ[boxIndex] }
+			};
+			const AABB worldAABB = TransformAABB(worldMatrices[boxIndex], localAABB);
+			outWorldAABBs.minX[boxIndex] = worldAABB.minimum.x;
+			outWorldAABBs.minY[boxIndex] = worldAABB.minimum.y;
+			outWorldAABBs.minZ[boxIndex] = worldAABB.minimum.z;
+			outWorldAABBs.maxX[boxIndex] = worldAABB.maximum.x;
+			outWorldAABBs.maxY[boxIndex] = worldAABB.maximum.y;
+			outWorldAABBs.maxZ[boxIndex] = worldAABB.maximum.z;
+		}
+	}
+
+	/// <summary>
+	/// 8 bounding spheres stored as structure of arrays. Culling kernels test one block at a time
+	/// Unused lanes have radius -infinity, so they are never visible
+	/// </summary>
+	struct alignas(32) SphereBlock8
+	{
+		float centerX[8];
+		float centerY[8];
+		float centerZ[8];
+		float radius[8];
+
+		FORCE_INLINE void SetSphere(size_t lane, const math::Vector<3, float>& center, float sphereRadius) noexcept
+		{
+			centerX[lane] = center.x;
+			centerY[lane] = center.y;
+			centerZ[lane] = center.z;
+			radius[lane] = sphereRadius;
+		}
+
+		FORCE_INLINE void ClearSphere(size_t lane) noexcept
+		{
+			SetSphere(lane, math::Vector<3, float>{ 0.0f, 0.0f, 0.0f }, math::negativeInfinity<float>());
+		}
+	};
+
+	[[nodiscard]] FORCE_INLINE size_t GetSphereBlockCount(size_t sphereCount) noexcept
+	{
+		return (sphereCount + 7) / 8;
+	}
+
+	/// <summary>
+	/// Largest scale of 3 axes of worldMatrix
+	/// Radius scaled by it contains transformed sphere even with non uniform scale
+	/// </summary>
+	[[nodiscard]] inline float GetMaxAxisScale(const math::Matrix<4, 4, float>& worldMatrix) noexcept
+	{
+		float maxSqrLength = 0.0f;
+		for (size_t columnIndex = 0; columnIndex < 3; ++columnIndex)
+		{
+			const math::Vector<4, float>& column = worldMatrix.columns[columnIndex];
+			maxSqrLength = math::Max(maxSqrLength, column.x * column.x + column.y * column.y + column.z * column.z);
+		}
+		return std::sqrt(maxSqrLength);
+	}
+
+	/// <summary>
+	/// Transform local spheres by their world matrices and write them to SphereBlock8s
+	/// Center is transformed by matrix and radius is scaled by max axis scale of matrix
+	/// 8 spheres are transformed at once. Axis scale takes one square root of largest squared column length
+	/// </summary>
+	/// <param name="localSpheres">xyz is center, w is radius</param>
+	/// <param name="outBlocks">should have at least GetSphereBlockCount(sphereCount) blocks</param>
+	inline void TransformSpheres(const math::Matrix<4, 4, float>* worldMatrices, const math::Vector<4, float>* localSpheres, size_t sphereCount, SphereBlock8* outBlocks) noexcept
+	{
+		size_t sphereIndex = 0;
+
+#ifdef SIMD_ENABLED
+		for (; sphereIndex + 8 <= sphereCount; sphereIndex += 8)
+		{
+			M256F localX, localY, localZ, localRadius;
+			detail::LoadTransposedVector4x8(localSpheres[sphereIndex].data(), 4, localX, localY, localZ, localRadius);
+			const M256F local[3]{ localX, localY, localZ };
+
+			// start from translation
+			M256F world[3];
+			detail::LoadMatrixColumn8(worldMatrices + sphereIndex, 3, world[0], world[1], world[2]);
+			M256F maxSqrLength = _mm256_setzero_ps();
+
+			for (size_t columnIndex = 0; columnIndex < 3; ++columnIndex)
+			{
+				M256F column[3];
+				detail::LoadMatrixColumn8(worldMatrices + sphereIndex, columnIndex, column[0], column[1], column[2]);
+				for (size_t row = 0; row < 3; ++row)
+				{
+					world[row] = M256F_MUL_AND_ADD(column[row], local[columnIndex], world[row]);
+				}
+				const M256F sqrLength = M256F_MUL_AND_ADD(column[2], column[2], M256F_MUL_AND_ADD(column[1], column[1], M256F_MUL(column[0], column[0])));
+				maxSqrLength = _mm256_max_ps(maxSqrLength, sqrLength);
+			}
+
+			SphereBlock8& block = outBlocks[sphereIndex / 8];
+			_mm256_store_ps(block.centerX, world[0]);
+			_mm256_store_ps(block.centerY, world[1]);
+			_mm256_store_ps(block.centerZ, world[2]);
+			_mm256_store_ps(block.radius, M256F_MUL(localRadius, _mm256_sqrt_ps(maxSqrLength)));
+		}
+#endif
+
+		for (; sphereIndex < sphereCount; ++sphereIndex)
+		{
+			const math::Matrix<4, 4, float>& worldMatrix = worldMatrices[sphereIndex];
+			const math::Vector<4, float>& localSphere = localSpheres[sphereIndex];
+
+			math::Vector<3, float> worldCenter;
+			for (size_t row = 0; row < 3; ++row)
+			{
+				worldCenter[row] = worldMatrix.columns[0][row] * localSphere.x + worldMatrix.columns[1][row] * localSphere.y + worldMatrix.columns[2][row] * localSphere.z + worldMatrix.columns[3][row];
+			}
+			outBlocks[sphereIndex / 8].SetSphere(sphereIndex % 8, worldCenter, localSphere.w * GetMaxAxisScale(worldMatrix));
+		}
+
+		if (sphereCount % 8 != 0)
+		{
+			for (size_t lane = sphereCount % 8; lane < 8; ++lane)
+			{
+				outBlocks[sphereCount / 8].ClearSphere(lane);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Test 8 spheres of block with frustum
+	/// Sphere is visible when it's not completely outside of any plane ( dot(normal, center) + w >= -radius )
+	/// Planes should be normalized
+	/// </summary>
+	/// <param name="eightPlanes">made by ExtractSIMDPlanesFromViewProjectionMatrix</param>
+	/// <returns>bit i is set when i th sphere of block is visible</returns>
+	[[nodiscard]] inline unsigned int TestSphereBlockInFrustum(const math::Vector<4, float>* eightPlanes, const SphereBlock8& block) noexcept
+	{
+#ifdef SIMD_ENABLED
+		const M256F centerX = _mm256_load_ps(block.centerX);
+		const M256F centerY = _mm256_load_ps(block.centerY);
+		const M256F centerZ = _mm256_load_ps(block.centerZ);
+		const M256F negativeRadius = M256F_SUB(_mm256_setzero_ps(), _mm256_load_ps(block.radius));
+
+		M256F isVisible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (size_t planeIndex = 0; planeIndex < 6; ++planeIndex)
+		{
+			// plane 0 ~ 3 are in eightPlanes[0 ~ 3], plane 4, 5 are in eightPlanes[4 ~ 7]
+			const size_t componentOffset = (planeIndex < 4) ? 0 : 4;
+			const size_t lane = (planeIndex < 4) ? planeIndex : planeIndex - 4;
+
+			M256F distance = M256F_MUL_AND_ADD(centerX, _mm256_set1_ps(eightPlanes[componentOffset + 0][lane]), _mm256_set1_ps(eightPlanes[componentOffset + 3][lane]));
+			distance = M256F_MUL_AND_ADD(centerY, _mm256_set1_ps(eightPlanes[componentOffset + 1][lane]), distance);
+			distance = M256F_MUL_AND_ADD(centerZ, _mm256_set1_ps(eightPlanes[componentOffset + 2][lane]), distance);
+			isVisible = _mm256_and_ps(isVisible, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+		}
+		return static_cast<unsigned int>(_mm256_movemask_ps(isVisible));
+#else
+		unsigned int visibleMask = 0;
+		for (size_t lane = 0; lane < 8; ++lane)
+		{
+			bool isVisible = true;
+			for (size_t planeIndex = 0; planeIndex < 6 && isVisible == true; ++planeIndex)
+			{
+				const size_t componentOffset = (planeIndex < 4) ? 0 : 4;
+				const size_t planeLane = (planeIndex < 4) ? planeIndex : planeIndex - 4;
+				const float distance = eightPlanes[componentOffset + 0][planeLane] * block.centerX[lane] + eightPlanes[componentOffset + 1][planeLane] * block.centerY[lane] + eightPlanes[componentOffset + 2][planeLane] * block.centerZ[lane] + eightPlanes[componentOffset + 3][planeLane];
+				isVisible = distance >= -block.radius[lane];
+			}
+			visibleMask |= (isVisible == true) ? (1u << lane) : 0u;
+		}
+		return visibleMask;
+#endif
+	}
+
+	/// <summary>
+	/// Test every sphere of blocks with frustum
+	/// </summary>
+	/// <param name="outVisibleMasks">one mask per block. bit i is set when i th sphere of block is visible</param>
+	/// <returns>visible sphere count</returns>
+	inline size_t CullSphereBlocks(const math::Vector<4, float>* eightPlanes, const SphereBlock8* blocks, size_t blockCount, unsigned char* outVisibleMasks) noexcept
+	{
+		size_t visibleCount = 0;
+		for (size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+		{
+			const unsigned int visibleMask = TestSphereBlockInFrustum(eightPlanes, blocks[blockIndex]);
+			outVisibleMasks[blockIndex] = static_cast<unsigned char>(visibleMask);
+			visibleCount += math::countBits(visibleMask);
+		}
+		return visibleCount;
+	}
+
+	namespace detail
+	{
+		/// <summary>
+		/// Write index of every set bit of visibleMask to outVisibleIndices[visibleCount ~ ]
+		/// </summary>
+		FORCE_INLINE void AppendVisibleIndices(unsigned int visibleMask, size_t baseIndex, unsigned int* outVisibleIndices, size_t& visibleCount) noexcept
+		{
+			while (visibleMask != 0)
+			{
+				const unsigned int lane = math::countTrailingZero(visibleMask);
+				visibleMask &= visibleMask - 1;
+				outVisibleIndices[visibleCount++] = static_cast<unsigned int>(baseIndex + lane);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Test point lights with frustum and write indices of visible lights
+	/// Point light is sphere of light range, so it uses same block with bounding sphere
+	/// </summary>
+	/// <param name="eightPlanes">made by ExtractSIMDPlanesFromViewProjectionMatrix</param>
+	/// <param name="blocks">xyz is light position, radius is light range. Should have GetSphereBlockCount(lightCount) blocks</param>
+	/// <param name="outVisibleIndices">should have at least lightCount elements. Indices are written in ascending order</param>
+	/// <returns>visible light count</returns>
+	inline size_t CullPointLights(const math::Vector<4, float>* eightPlanes, const SphereBlock8* blocks, size_t lightCount, unsigned int* outVisibleIndices) noexcept
+	{
+		size_t visibleCount = 0;
+		for (size_t blockIndex = 0; blockIndex < GetSphereBlockCount(lightCount); ++blockIndex)
+		{
+			detail::AppendVisibleIndices(TestSphereBlockInFrustum(eightPlanes, blocks[blockIndex]), blockIndex * 8, outVisibleIndices, visibleCount);
+		}
+		return visibleCount;
+	}
+
+	/// <summary>
+	/// 8 spot lights stored as structure of arrays
+	/// Light volume is bounded by cone whose apex is light position, height is light range and half angle is outer angle
+	/// Unused lanes have range -infinity, so they are never visible
+	/// </summary>
+	struct alignas(32) SpotLightBlock8
+	{
+		float positionX[8];
+		float positionY[8];
+		float positionZ[8];
+		float directionX[8];
+		float directionY[8];
+		float directionZ[8];
+		float range[8];
+		/// <summary>
+		/// radius of cone base. range * tan(outerAngle)
+		/// </summary>
+		float baseRadius[8];
+
+		/// <param name="direction">should be normalized</param>
+		/// <param name="outerAngle">half angle of cone in radian. Should be smaller than PI / 2</param>
+		FORCE_INLINE void SetSpotLight(size_t lane, const math::Vector<3, float>& position, const math::Vector<3, float>& direction, float lightRange, float outerAngle) noexcept
+		{
+			assert(outerAngle >= 0.0f && outerAngle < PI * 0.5f);
+			positionX[lane] = position.x;
+			positionY[lane] = position.y;
+			positionZ[lane] = position.z;
+			directionX[lane] = direction.x;
+			directionY[lane] = direction.y;
+			directionZ[lane] = direction.z;
+			range[lane] = lightRange;
+			baseRadius[lane] = lightRange * std::tan(outerAngle);
+		}
+
+		FORCE_INLINE void ClearSpotLight(size_t lane) noexcept
+		{
+			SetSpotLight(lane, math::Vector<3, float>{ 0.0f, 0.0f, 0.0f }, math::Vector<3, float>{ 0.0f, 0.0f, 1.0f }, math::negativeInfinity<float>(), 0.0f);
+		}
+	};
+
+	/// <summary>
+	/// Test 8 spot lights of block with frustum
+	///
+	/// Cone is outside of plane when both of apex and farthest point of base circle are outside.
+	/// With normalized plane normal n, signed distance of that point is
+	/// distance(apex) + range * dot(n, direction) + baseRadius * sqrt(1 - dot(n, direction)^2)
+	/// Sphere of light range is also tested, it's tighter than cone when outer angle is wide
+	/// Planes should be normalized
+	///
+	/// reference : Cull that cone!, Bartlomiej Wronski
+	/// </summary>
+	/// <param name="eightPlanes">made by ExtractSIMDPlanesFromViewProjectionMatrix</param>
+	/// <returns>bit i is set when i th spot light of block is visible</returns>
+	[[nodiscard]] inline unsigned int TestSpotLightBlockInFrustum(const math::Vector<4, float>* eightPlanes, const SpotLightBlock8& block) noexcept
+	{
+#ifdef SIMD_ENABLED
+		const M256F positionX = _mm256_load_ps(block.positionX);
+		const M256F positionY = _mm256_load_ps(block.positionY);
+		const M256F positionZ = _mm256_load_ps(block.positionZ);
+		const M256F directionX = _mm256_load_ps(block.directionX);
+		const M256F directionY = _mm256_load_ps(block.directionY);
+		const M256F directionZ = _mm256_load_ps(block.directionZ);
+		const M256F range = _mm256_load_ps(block.range);
+		const M256F baseRadius = _mm256_load_ps(block.baseRadius);
+		const M256F negativeRange = M256F_SUB(_mm256_setzero_ps(), range);
+		const M256F zero = _mm256_setzero_ps();
+		const M256F one = _mm256_set1_ps(1.0f);
+
+		M256F isVisible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (size_t planeIndex = 0; planeIndex < 6; ++planeIndex)
+		{
+			// plane 0 ~ 3 are in eightPlanes[0 ~ 3], plane 4, 5 are in eightPlanes[4 ~ 7]
+			const size_t componentOffset = (planeIndex < 4) ? 0 : 4;
+			const size_t lane = (planeIndex < 4) ? planeIndex : planeIndex - 4;
+			const M256F planeX = _mm256_set1_ps(eightPlanes[componentOffset + 0][lane]);
+			const M256F planeY = _mm256_set1_ps(eightPlanes[componentOffset + 1][lane]);
+			const M256F planeZ = _mm256_set1_ps(eightPlanes[componentOffset + 2][lane]);
+
+			M256F apexDistance = M256F_MUL_AND_ADD(positionX, planeX, _mm256_set1_ps(eightPlanes[componentOffset + 3][lane]));
+			apexDistance = M256F_MUL_AND_ADD(positionY, planeY, apexDistance);
+			apexDistance = M256F_MUL_AND_ADD(positionZ, planeZ, apexDistance);
+
+			M256F cosine = M256F_MUL(directionX, planeX);
+			cosine = M256F_MUL_AND_ADD(directionY, planeY, cosine);
+			cosine = M256F_MUL_AND_ADD(directionZ, planeZ, cosine);
+			// max with 0 : float error can make 1 - cosine^2 slightly negative
+			const M256F sine = _mm256_sqrt_ps(_mm256_max_ps(zero, M256F_SUB(one, M256F_MUL(cosine, cosine))));
+
+			const M256F baseDistance = M256F_MUL_AND_ADD(baseRadius, sine, M256F_MUL_AND_ADD(range, cosine, apexDistance));
+			const M256F isConeVisible = _mm256_or_ps(_mm256_cmp_ps(apexDistance, zero, _CMP_GE_OQ), _mm256_cmp_ps(baseDistance, zero, _CMP_GE_OQ));
+			const M256F isSphereVisible = _mm256_cmp_ps(apexDistance, negativeRange, _CMP_GE_OQ);
+			isVisible = _mm256_and_ps(isVisible, _mm256_and_ps(isConeVisible, isSphereVisible));
+		}
+		return static_cast<unsigned int>(_mm256_movemask_ps(isVisible));
+#else
+		unsigned int visibleMask = 0;
+		for (size_t lane = 0; lane < 8; ++lane)
+		{
+			bool isVisible = true;
+			for (size_t planeIndex = 0; planeIndex < 6 && isVisible == true; ++planeIndex)
+			{
+				const size_t componentOffset = (planeIndex < 4) ? 0 : 4;
+				const size_t planeLane = (planeIndex < 4) ? planeIndex : planeIndex - 4;
+				const float planeX = eightPlanes[componentOffset + 0][planeLane];
+				const float planeY = eightPlanes[componentOffset + 1][planeLane];
+				const float planeZ = eightPlanes[componentOffset + 2][planeLane];
+
+				const float apexDistance = planeX * block.positionX[lane] + planeY * block.positionY[lane] + planeZ * block.positionZ[lane] + eightPlanes[componentOffset + 3][planeLane];
+				const float cosine = planeX * block.directionX[lane] + planeY * block.directionY[lane] + planeZ * block.directionZ[lane];
+				const float sine = std::sqrt(math::Max(0.0f, 1.0f - cosine * cosine));
+				const float baseDistance = apexDistance + block.range[lane] * cosine + block.baseRadius[lane] * sine;
+				isVisible = (apexDistance >= 0.0f || baseDistance >= 0.0f) && apexDistance >= -block.range[lane];
+			}
+			visibleMask |= (isVisible == true) ? (1u << lane) : 0u;
+		}
+		return visibleMask;
+#endif
+	}
+
+	/// <summary>
+	/// Test spot lights with frustum and write indices of visible lights
+	/// </summary>
+	/// <param name="eightPlanes">made by ExtractSIMDPlanesFromViewProjectionMatrix</param>
+	/// <param name="blocks">should have GetSphereBlockCount(lightCount) blocks</param>
+	/// <param name="outVisibleIndices">should have at least lightCount elements. Indices are written in ascending order</param>
+	/// <returns>visible light count</returns>
+	inline size_t CullSpotLights(const math::Vector<4, float>* eightPlanes, const SpotLightBlock8* blocks, size_t lightCount, unsigned int* outVisibleIndices) noexcept
+	{
+		size_t visibleCount = 0;
+		for (size_t blockIndex = 0; blockIndex < GetSphereBlockCount(lightCount); ++blockIndex)
+		{
+			detail::AppendVisibleIndices(TestSpotLightBlockInFrustum(eightPlanes, blocks[blockIndex]), blockIndex * 8, outVisibleIndices, visibleCount);
+		}
+		return visibleCount;
+	}
+
+	inline constexpr unsigned char CULLING_INVALID_PLANE_INDEX = 0xFF;
+
+	/// <summary>
+	/// Every bit of 6 frustum planes
+	/// </summary>
+	inline constexpr unsigned int CULLING_ALL_PLANES_MASK = 0x3F;
+
+	/// <summary>
+	/// Frustum culling with temporal coherence
+	///
+	/// Remembers per object the plane which rejected it last time and tests that plane first.
+	/// Object which was outside usually stays outside of same plane, so it's rejected with one plane test
+	///
+	/// Plane mask is for hierarchy. Planes which bounds of parent are completely inside don't need to be tested for children.
+	/// Pass outPlaneMask of parent as parentPlaneMask of children. When it's 0, parent is fully inside and children are visible without any test
+	///
+	/// reference : Optimized View Frustum Culling Algorithms for Bounding Boxes, Ulf Assarsson and Tomas Moller
+	/// </summary>
+	class FrustumCullingContext
+	{
+	public:
+
+		explicit FrustumCullingContext(size_t objectCount = 0)
+		{
+			Resize(objectCount);
+		}
+
+		/// <summary>
+		/// Added objects start with no cached plane and invisible state
+		/// </summary>
+		void Resize(size_t objectCount)
+		{
+			mLastRejectPlaneIndices.resize(objectCount, CULLING_INVALID_PLANE_INDEX);
+			mVisibleFlags.resize(objectCount, 0);
+		}
+
+		/// <summary>
+		/// Forget cached planes and states. Call it when camera cuts
+		/// </summary>
+		void Reset() noexcept
+		{
+			std::fill(mLastRejectPlaneIndices.begin(), mLastRejectPlaneIndices.end(), CULLING_INVALID_PLANE_INDEX);
+			std::fill(mVisibleFlags.begin(), mVisibleFlags.end(), static_cast<unsigned char>(0));
+		}
+
+		/// <summary>
+		/// Set planes of this frame
+		/// </summary>
+		/// <param name="sixPlanes">made by ExtractPlanesFromVIewProjectionMatrix with normalize</param>
+		void SetFrustum(const math::Vector<4, float>* sixPlanes) noexcept
+		{
+			for (size_t planeIndex = 0; planeIndex < 6; ++planeIndex)
+			{
+				mPlanes[planeIndex] = sixPlanes[planeIndex];
+			}
+		}
+
+		/// <param name="outPlaneMask">planes which sphere intersects. Pass it to children. written only when visible</param>
+		/// <returns>true if sphere is visible</returns>
+		bool TestSphere(size_t objectIndex, const math::Vector<3, float>& center, float radius, unsigned int parentPlaneMask = CULLING_ALL_PLANES_MASK, unsigned int* outPlaneMask = nullptr) noexcept
+		{
+			return TestObject(objectIndex, parentPlaneMask, outPlaneMask, [&center, radius](const math::Vector<4, float>& plane, float& outDistance, float& outRadius)
+			{
+				outDistance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+				outRadius = radius;
+			});
+		}
+
+		/// <param name="outPlaneMask">planes which box intersects. Pass it to children. written only when visible</param>
+		/// <returns>true if box is visible</returns>
+		bool TestAABB(size_t objectIndex, const AABB& aabb, unsigned int parentPlaneMask = CULLING_ALL_PLANES_MASK, unsigned int* outPlaneMask = nullptr) noexcept
+		{
+			const math::Vector<3, float> center = aabb.center();
+			const math::Vector<3, float> extents = aabb.extents();
+			return TestObject(objectIndex, parentPlaneMask, outPlaneMask, [&center, &extents](const math::Vector<4, float>& plane, float& outDistance, float& outRadius)
+			{
+				outDistance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+				// projected radius of box on plane normal
+				outRadius = math::abs(plane.x) * extents.x + math::abs(plane.y) * extents.y + math::abs(plane.z) * extents.z;
+			});
+		}
+
+		/// <summary>
+		/// Test every box. Object index is box index
+		/// </summary>
+		/// <param name="outVisibleFlags">1 when visible, 0 when culled. at least boxes.count elements</param>
+		/// <returns>visible box count</returns>
+		size_t CullAABBs(const AABBArraySoA& boxes, unsigned char* outVisibleFlags) noexcept
+		{
+			size_t visibleCount = 0;
+			for (size_t boxIndex = 0; boxIndex < boxes.count; ++boxIndex)
+			{
+				const AABB aabb
+				{
+					math::Vector<3, float>{ boxes.minX[boxIndex], boxes.minY[boxIndex], boxes.minZ[boxIndex] },
+					math::Vector<3, float>{ boxes.maxX[boxIndex], boxes.maxY[boxIndex], boxes.maxZ[boxIndex] }
+				};
+				const bool isVisible = TestAABB(boxIndex, aabb);
+				outVisibleFlags[boxIndex] = (isVisible == true) ? 1 : 0;
+				visibleCount += (isVisible == true) ? 1 : 0;
+			}
+			return visibleCount;
+		}
+
+		/// <summary>
+		/// Test every sphere of blocks. Object index is blockIndex * 8 + lane
+		/// </summary>
+		/// <param name="outVisibleFlags">1 when visible, 0 when culled. at least sphereCount elements</param>
+		/// <returns>visible sphere count</returns>
+		size_t CullSpheres(const SphereBlock8* blocks, size_t sphereCount, unsigned char* outVisibleFlags) noexcept
+		{
+			size_t visibleCount = 0;
+			for (size_t sphereIndex = 0; sphereIndex < sphereCount; ++sphereIndex)
+			{
+				const SphereBlock8& block = blocks[sphereIndex / 8];
+				const size_t lane = sphereIndex % 8;
+				const bool isVisible = TestSphere(sphereIndex, math::Vector<3, float>{ block.centerX[lane], block.centerY[lane], block.centerZ[lane] }, block.radius[lane]);
+				outVisibleFlags[sphereIndex] = (isVisible == true) ? 1 : 0;
+				visibleCount += (isVisible == true) ? 1 : 0;
+			}
+			return visibleCount;
+		}
+
+		/// <summary>
+		/// Result of last test of object
+		/// </summary>
+		[[nodiscard]] FORCE_INLINE bool IsVisible(size_t objectIndex) const noexcept
+		{
+			return mVisibleFlags[objectIndex] != 0;
+		}
+
+		/// <returns>CULLING_INVALID_PLANE_INDEX when object wasn't rejected yet</returns>
+		[[nodiscard]] FORCE_INLINE unsigned char GetLastRejectPlaneIndex(size_t objectIndex) const noexcept
+		{
+			return mLastRejectPlaneIndices[objectIndex];
+		}
+
+		/// <summary>
+		/// Count of plane tests since last ResetPlaneTestCount
+		/// </summary>
+		[[nodiscard]] FORCE_INLINE size_t GetPlaneTestCount() const noexcept
+		{
+			return mPlaneTestCount;
+		}
+
+		FORCE_INLINE void ResetPlaneTestCount() noexcept
+		{
+			mPlaneTestCount = 0;
+		}
+
+		[[nodiscard]] FORCE_INLINE size_t GetObjectCount() const noexcept
+		{
+			return mVisibleFlags.size();
+		}
+
+	private:
+
+		/// <param name="getDistanceAndRadius">void(const Vector4& plane, float& outDistance, float& outRadius). outRadius is projected radius of bounds on plane normal</param>
+		template <typename GetDistanceAndRadius>
+		bool TestObject(size_t objectIndex, unsigned int parentPlaneMask, unsigned int* outPlaneMask, const GetDistanceAndRadius& getDistanceAndRadius) noexcept
+		{
+			assert(objectIndex < mVisibleFlags.size());
+
+			unsigned int planeMask = parentPlaneMask & CULLING_ALL_PLANES_MASK;
+			const unsigned char lastRejectPlaneIndex = mLastRejectPlaneIndices[objectIndex];
+
+			// plane which rejected object last time is tested first
+			if (lastRejectPlaneIndex != CULLING_INVALID_PLANE_INDEX && (planeMask & (1u << lastRejectPlaneIndex)) != 0)
+			{
+				float distance, radius;
+				getDistanceAndRadius(mPlanes[lastRejectPlaneIndex], distance, radius);
+				++mPlaneTestCount;
+				if (distance < -radius)
+				{
+					mVisibleFlags[objectIndex] = 0;
+					return false;
+				}
+				if (distance >= radius)
+				{
+					planeMask &= ~(1u << lastRejectPlaneIndex);
+				}
+			}
+
+			unsigned int remainingPlaneMask = planeMask;
+			if (lastRejectPlaneIndex != CULLING_INVALID_PLANE_INDEX)
+			{
+				remainingPlaneMask &= ~(1u << lastRejectPlaneIndex);
+			}
+
+			while (remainingPlaneMask != 0)
+			{
+				const unsigned int planeIndex = math::countTrailingZero(remainingPlaneMask);
+				remainingPlaneMask &= remainingPlaneMask - 1;
+
+				float distance, radius;
+				getDistanceAndRadius(mPlanes[planeIndex], distance, radius);
+				++mPlaneTestCount;
+				if (distance < -radius)
+				{
+					mLastRejectPlaneIndices[objectIndex] = static_cast<unsigned char>(planeIndex);
+					mVisibleFlags[objectIndex] = 0;
+					return false;
+				}
+				if (distance >= radius)
+				{
+					// completely inside of this plane. children don't need to test it
+					planeMask &= ~(1u << planeIndex);
+				}
+			}
+
+			if (outPlaneMask != nullptr)
+			{
+				*outPlaneMask = planeMask;
+			}
+			mVisibleFlags[objectIndex] = 1;
+			return true;
+		}
+
+		math::Vector<4, float> mPlanes[6];
+
+		/// <summary>
+		/// per object. plane which rejected object last time
+		/// </summary>
+		std::vector<unsigned char> mLastRejectPlaneIndices;
+
+		/// <summary>
+		/// per object. 1 when object was visible at last test
+		/// </summary>
+		std::vector<unsigned char> mVisibleFlags;
+
+		size_t mPlaneTestCount = 0;
+	};
+
+	inline constexpr size_t MULTI_VIEW_MAX_FRUSTUM_COUNT = 8;
+
+	/// <summary>
+	/// Planes of up to 8 frustums packed as structure of arrays
+	/// Planes of frustum k are [k * 6, k * 6 + 5]. 8 planes are tested at once
+	/// e.g. 2 for stereo, 6 for cubemap shadow, 4 for shadow cascades
+	/// </summary>
+	struct alignas(32) MultiViewFrustums
+	{
+		float planeX[MULTI_VIEW_MAX_FRUSTUM_COUNT * 6];
+		float planeY[MULTI_VIEW_MAX_FRUSTUM_COUNT * 6];
+		float planeZ[MULTI_VIEW_MAX_FRUSTUM_COUNT * 6];
+		float planeW[MULTI_VIEW_MAX_FRUSTUM_COUNT * 6];
+		size_t frustumCount = 0;
+
+		/// <summary>
+		/// Extract normalized planes of every view projection matrix
+		/// </summary>
+		void SetFrustums(const math::Matrix<4, 4, float>* viewProjectionMatrices, size_t matrixCount) noexcept
+		{
+			assert(matrixCount <= MULTI_VIEW_MAX_FRUSTUM_COUNT);
+
+			math::Vector<4, float> sixPlanes[MULTI_VIEW_MAX_FRUSTUM_COUNT * 6];
+			math::ExtractPlanesFromViewProjectionMatrices(viewProjectionMatrices, matrixCount, sixPlanes, true);
+
+			// unused planes are zero, so nothing is outside of them
+			for (size_t planeIndex = 0; planeIndex < MULTI_VIEW_MAX_FRUSTUM_COUNT * 6; ++planeIndex)
+			{
+				const bool isUsed = planeIndex < matrixCount * 6;
+				planeX[planeIndex] = (isUsed == true) ? sixPlanes[planeIndex].x : 0.0f;
+				planeY[planeIndex] = (isUsed == true) ? sixPlanes[planeIndex].y : 0.0f;
+				planeZ[planeIndex] = (isUsed == true) ? sixPlanes[planeIndex].z : 0.0f;
+				planeW[planeIndex] = (isUsed == true) ? sixPlanes[planeIndex].w : 0.0f;
+			}
+			frustumCount = matrixCount;
+		}
+	};
+
+	namespace detail
+	{
+		/// <summary>
+		/// Bounds are center with extents ( box ) plus radius ( sphere )
+		/// </summary>
+		/// <returns>bit k is set when bounds are visible in frustum k</returns>
+		inline unsigned int TestBoundsInFrustums(const MultiViewFrustums& frustums, const math::Vector<3, float>& center, const math::Vector<3, float>& extents, float radius) noexcept
+		{
+			const size_t planeCount = frustums.frustumCount * 6;
+
+			// bit i is set when bounds are completely outside of plane i
+			unsigned long long outsideBits = 0;
+
+#ifdef SIMD_ENABLED
+			const M256F centerX = _mm256_set1_ps(center.x);
+			const M256F centerY = _mm256_set1_ps(center.y);
+			const M256F centerZ = _mm256_set1_ps(center.z);
+			const M256F extentX = _mm256_set1_ps(extents.x);
+			const M256F extentY = _mm256_set1_ps(extents.y);
+			const M256F extentZ = _mm256_set1_ps(extents.z);
+			const M256F m256f_radius = _mm256_set1_ps(radius);
+			const M256F signMask = _mm256_set1_ps(-0.0f);
+			const M256F zero = _mm256_setzero_ps();
+
+			for (size_t planeIndex = 0; planeIndex < planeCount; planeIndex += 8)
+			{
+				const M256F planeX = _mm256_load_ps(frustums.planeX + planeIndex);
+				const M256F planeY = _mm256_load_ps(frustums.planeY + planeIndex);
+				const M256F planeZ = _mm256_load_ps(frustums.planeZ + planeIndex);
+
+				M256F distance = M256F_MUL_AND_ADD(centerX, planeX, _mm256_load_ps(frustums.planeW + planeIndex));
+				distance = M256F_MUL_AND_ADD(centerY, planeY, distance);
+				distance = M256F_MUL_AND_ADD(centerZ, planeZ, distance);
+
+				// projected radius of bounds on plane normal
+				M256F projectedRadius = M256F_MUL_AND_ADD(extentX, _mm256_andnot_ps(signMask, planeX), m256f_radius);
+				projectedRadius = M256F_MUL_AND_ADD(extentY, _mm256_andnot_ps(signMask, planeY), projectedRadius);
+				projectedRadius = M256F_MUL_AND_ADD(extentZ, _mm256_andnot_ps(signMask, planeZ), projectedRadius);
+
+				const unsigned int outsideMask = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(M256F_ADD(distance, projectedRadius), zero, _CMP_LT_OQ)));
+				outsideBits |= static_cast<unsigned long long>(outsideMask) << planeIndex;
+			}
+#else
+			for (size_t planeIndex = 0; planeIndex < planeCount; ++planeIndex)
+			{
+				const float distance = frustums.planeX[planeIndex] * center.x + frustums.planeY[planeIndex] * center.y + frustums.planeZ[planeIndex] * center.z + frustums.planeW[planeIndex];
+				const float projectedRadius = math::abs(frustums.planeX[planeIndex]) * extents.x + math::abs(frustums.planeY[planeIndex]) * extents.y + math::abs(frustums.planeZ[planeIndex]) * extents.z + radius;
+				if (distance + projectedRadius < 0.0f)
+				{
+					outsideBits |= 1ull << planeIndex;
+				}
+			}
+#endif
+
+			unsigned int visibleMask = 0;
+			for (size_t frustumIndex = 0; frustumIndex < frustums.frustumCount; ++frustumIndex)
+			{
+				if (((outsideBits >> (frustumIndex * 6)) & 0x3F) == 0)
+				{
+					visibleMask |= 1u << frustumIndex;
+				}
+			}
+			return visibleMask;
+		}
+	}
+
+	/// <returns>bit k is set when box is visible in frustum k</returns>
+	[[nodiscard]] inline unsigned int TestAABBInFrustums(const MultiViewFrustums& frustums, const AABB& aabb) noexcept
+	{
+		return detail::TestBoundsInFrustums(frustums, aabb.center(), aabb.extents(), 0.0f);
+	}
+
+	/// <returns>bit k is set when sphere is visible in frustum k</returns>
+	[[nodiscard]] inline unsigned int TestSphereInFrustums(const MultiViewFrustums& frustums, const math::Vector<3, float>& center, float radius) noexcept
+	{
+		return detail::TestBoundsInFrustums(frustums, center, math::Vector<3, float>{ 0.0f, 0.0f, 0.0f }, radius);
+	}
+
+	/// <summary>
+	/// Test every box with every frustum. Bounds of each box are loaded once
+	/// </summary>
+	/// <param name="outVisibleMasks">bit k is set when box is visible in frustum k. at least boxes.count elements</param>
+	inline void CullAABBsMultiView(const MultiViewFrustums& frustums, const AABBArraySoA& boxes, unsigned char* outVisibleMasks) noexcept
+	{
+		for (size_t boxIndex = 0; boxIndex < boxes.count; ++boxIndex)
+		{
+			const AABB aabb
+			{
+				math::Vector<3, float>{ boxes.minX[boxIndex], boxes.minY[boxIndex], boxes.minZ[boxIndex] },
+				math::Vector<3, float>{ boxes.maxX[boxIndex], boxes.maxY[boxIndex], boxes.maxZ[boxIndex] }
+			};
+			outVisibleMasks[boxIndex] = static_cast<unsigned char>(TestAABBInFrustums(frustums, aabb));
+		}
+	}
+
+	/// <summary>
+	/// Test every sphere of blocks with every frustum. Bounds of each sphere are loaded once
+	/// </summary>
+	/// <param name="outVisibleMasks">bit k is set when sphere is visible in frustum k. at least sphereCount elements</param>
+	inline void CullSphereBlocksMultiView(const MultiViewFrustums& frustums, const SphereBlock8* blocks, size_t sphereCount, unsigned char* outVisibleMasks) noexcept
+	{
+		for (size_t sphereIndex = 0; sphereIndex < sphereCount; ++sphereIndex)
+		{
+			const SphereBlock8& block = blocks[sphereIndex / 8];
+			const size_t lane = sphereIndex % 8;
+			outVisibleMasks[sphereIndex] = static_cast<unsigned char>(TestSphereInFrustums(frustums, math::Vector<3, float>{ block.centerX[lane], block.centerY[lane], block.centerZ[lane] }, block.radius[lane]));
+		}
+	}
+}
@@ -0,0 +1,785 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include "LMath_Core.h"
+#include "Utility.h"
+#include "Vector3.h"
+#include "Matrix3x3.h"
+
+#include "SIMD_Core.h"
+
+namespace math
+{
+	inline constexpr unsigned int GJK_MAX_ITERATION_COUNT = 64;
+	inline constexpr unsigned int EPA_MAX_ITERATION_COUNT = 64;
+
+	/// <summary>
+	/// GJK stops when distance improves less than this ratio of squared distance
+	/// </summary>
+	inline constexpr float GJK_RELATIVE_TOLERANCE = 1e-6f;
+
+	/// <summary>
+	/// Shapes closer than this are treated as intersecting
+	/// </summary>
+	inline constexpr float GJK_INTERSECTION_TOLERANCE = 1e-6f;
+
+	/// <summary>
+	/// EPA stops when polytope expands less than this
+	/// </summary>
+	inline constexpr float EPA_TOLERANCE = 1e-4f;
+
+	/// <summary>
+	/// Convex hull whose vertices are stored as structure of arrays in local space
+	/// World space vertex is orientation * localVertex + position
+	/// Vertices don't need to be aligned and don't need to be only vertices on hull
+	/// </summary>
+	struct ConvexHull
+	{
+		const float* x;
+		const float* y;
+		const float* z;
+		size_t vertexCount;
+		math::Matrix<3, 3, float> orientation{ 1.0f };
+		math::Vector<3, float> position{};
+
+		[[nodiscard]] FORCE_INLINE math::Vector<3, float> GetVertex(size_t vertexIndex) const noexcept
+		{
+			return orientation * math::Vector<3, float>{ x[vertexIndex], y[vertexIndex], z[vertexIndex] } + position;
+		}
+	};
+
+	/// <summary>
+	/// Find vertex having largest dot product with direction
+	/// 8 vertices are tested at once. When dot products are same, smaller index is returned
+	/// </summary>
+	/// <returns>index of found vertex</returns>
+	[[nodiscard]] inline size_t FindSupportVertex(const float* x, const float* y, const float* z, size_t vertexCount, const math::Vector<3, float>& direction) noexcept
+	{
+		assert(vertexCount > 0);
+
+		size_t vertexIndex = 0;
+		float bestDot = math::negativeInfinity<float>();
+		size_t bestVertexIndex = 0;
+
+#ifdef SIMD_ENABLED
+		if (vertexCount >= 8)
+		{
+			const M256F directionX = _mm256_set1_ps(direction.x);
+			const M256F directionY = _mm256_set1_ps(direction.y);
+			const M256F directionZ = _mm256_set1_ps(direction.z);
+
+			// index is stored as float. it's exact until 2^24
+			const M256F laneOffset = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+			M256F bestDots = _mm256_set1_ps(math::negativeInfinity<float>());
+			M256F bestIndices = _mm256_setzero_ps();
+
+			for (; vertexIndex + 8 <= vertexCount; vertexIndex += 8)
+			{
+				M256F dots = M256F_MUL(_mm256_loadu_ps(x + vertexIndex), directionX);
+				dots = M256F_MUL_AND_ADD(_mm256_loadu_ps(y + vertexIndex), directionY, dots);
+				dots = M256F_MUL_AND_ADD(_mm256_loadu_ps(z + vertexIndex), directionZ, dots);
+
+				// strict comparison keeps first found vertex of each lane
+				const M256F isBetter = _mm256_cmp_ps(dots, bestDots, _CMP_GT_OQ);
+				bestDots = _mm256_blendv_ps(bestDots, dots, isBetter);
+				bestIndices = _mm256_blendv_ps(bestIndices, M256F_ADD(_mm256_set1_ps(static_cast<float>(vertexIndex)), laneOffset), isBetter);
+			}
+
+			alignas(32) float laneDots[8];
+			alignas(32) float laneIndices[8];
+			_mm256_store_ps(laneDots, bestDots);
+			_mm256_store_ps(laneIndices, bestIndices);
+			for (size_t lane = 0; lane < 8; ++lane)
+			{
+				const size_t laneVertexIndex = static_cast<size_t>(laneIndices[lane]);
+				if (laneDots[lane] > bestDot || (laneDots[lane] == bestDot && laneVertexIndex < bestVertexIndex))
+				{
+					bestDot = laneDots[lane];
+					bestVertexIndex = laneVertexIndex;
+				}
+			}
+		}
+#endif
+
+		for (; vertexIndex < vertexCount; ++vertexIndex)
+		{
+			const float dot = x[vertexIndex] * direction.x + y[vertexIndex] * direction.y + z[vertexIndex] * direction.z;
+			if (dot > bestDot)
+			{
+				bestDot = dot;
+				bestVertexIndex = vertexIndex;
+			}
+		}
+
+		return bestVertexIndex;
+	}
+
+	/// <summary>
+	/// Find support vertex of hull with world space direction
+	/// </summary>
+	/// <returns>index of found vertex</returns>
+	[[nodiscard]] inline size_t FindSupportVertex(const ConvexHull& hull, const math::Vector<3, float>& direction) noexcept
+	{
+		// transpose of orientation * direction
+		const math::Vector<3, float> localDirection{ math::dot(hull.orientation.columns[0], direction), math::dot(hull.orientation.columns[1], direction), math::dot(hull.orientation.columns[2], direction) };
+		return FindSupportVertex(hull.x, hull.y, hull.z, hull.vertexCount, localDirection);
+	}
+
+	/// <summary>
+	/// Vertex indices of last simplex of GJK
+	/// Pass same cache every frame to start GJK from last simplex. When shapes move little, GJK ends in a few iterations
+	/// </summary>
+	struct GJKCache
+	{
+		unsigned int vertexIndexA[4];
+		unsigned int vertexIndexB[4];
+		unsigned int count = 0;
+	};
+
+	struct GJKResult
+	{
+		bool isIntersecting;
+
+		/// <summary>
+		/// distance between two hulls. 0 when intersecting
+		/// </summary>
+		float distance;
+
+		/// <summary>
+		/// penetration depth from EPA. Only ComputeConvexHullPenetration computes it
+		/// </summary>
+		float penetrationDepth;
+
+		/// <summary>
+		/// unit vector from A to B
+		/// When separated, it's direction from pointA to pointB
+		/// When intersecting, moving B by normal * penetrationDepth separates two hulls
+		/// </summary>
+		math::Vector<3, float> normal;
+
+		/// <summary>
+		/// closest points when separated, deepest points when intersecting
+		/// </summary>
+		math::Vector<3, float> pointA;
+		math::Vector<3, float> pointB;
+	};
+
+	namespace detail
+	{
+		struct SimplexVertex
+		{
+			math::Vector<3, float> pointA;
+			math::Vector<3, float> pointB;
+
+			/// <summary>
+			/// pointA - pointB. Point of minkowski difference
+			/// </summary>
+			math::Vector<3, float> point;
+			unsigned int vertexIndexA;
+			unsigned int vertexIndexB;
+		};
+
+		struct Simplex
+		{
+			SimplexVertex vertices[4];
+			float barycentric[4];
+			unsigned int count = 0;
+
+			[[nodiscard]] math::Vector<3, float> GetClosestPoint() const noexcept
+			{
+				math::Vector<3, float> point{};
+				for (unsigned int i = 0; i < count; ++i)
+				{
+					point += vertices[i].point * barycentric[i];
+				}
+				return point;
+			}
+
+			void GetClosestPoints(math::Vector<3, float>& outPointA, math::Vector<3, float>& outPointB) const noexcept
+			{
+				outPointA = math::Vector<3, float>{};
+				outPointB = math::Vector<3, float>{};
+				for (unsigned int i = 0; i < count; ++i)
+				{
+					outPointA += vertices[i].pointA * barycentric[i];
+					outPointB += vertices[i].pointB * barycentric[i];
+				}
+			}
+
+			[[nodiscard]] bool Contains(unsigned int vertexIndexA, unsigned int vertexIndexB) const noexcept
+			{
+				for (unsigned int i = 0; i < count; ++i)
+				{
+					if (vertices[i].vertexIndexA == vertexIndexA && vertices[i].vertexIndexB == vertexIndexB)
+					{
+						return true;
+					}
+				}
+				return false;
+			}
+		};
+
+		[[nodiscard]] inline SimplexVertex ComputeSupport(const ConvexHull& hullA, const ConvexHull& hullB, const math::Vector<3, float>& direction) noexcept
+		{
+			SimplexVertex vertex;
+			vertex.vertexIndexA = static_cast<unsigned int>(FindSupportVertex(hullA, direction));
+			vertex.vertexIndexB = static_cast<unsigned int>(FindSupportVertex(hullB, -direction));
+			vertex.pointA = hullA.GetVertex(vertex.vertexIndexA);
+			vertex.pointB = hullB.GetVertex(vertex.vertexIndexB);
+			vertex.point = vertex.pointA - vertex.pointB;
+			return vertex;
+		}
+
+		/// <summary>
+		/// Reduce simplex to vertices of feature closest to origin
+		/// </summary>
+		inline void SolveSegment(Simplex& simplex, unsigned int indexA, unsigned int indexB) noexcept
+		{
+			const SimplexVertex a = simplex.vertices[indexA];
+			const SimplexVertex b = simplex.vertices[indexB];
+			const math::Vector<3, float> ab = b.point - a.point;
+
+			const float t = math::dot(-a.point, ab);
+			const float sqrLength = math::dot(ab, ab);
+			if (t <= 0.0f || sqrLength <= 0.0f)
+			{
+				simplex.vertices[0] = a;
+				simplex.barycentric[0] = 1.0f;
+				simplex.count = 1;
+			}
+			else if (t >= sqrLength)
+			{
+				simplex.vertices[0] = b;
+				simplex.barycentric[0] = 1.0f;
+				simplex.count = 1;
+			}
+			else
+			{
+				simplex.vertices[0] = a;
+				simplex.vertices[1] = b;
+				simplex.barycentric[1] = t / sqrLength;
+				simplex.barycentric[0] = 1.0f - simplex.barycentric[1];
+				simplex.count = 2;
+			}
+		}
+
+		/// <summary>
+		/// Reduce simplex to vertices of feature closest to origin
+		/// reference : Real-Time Collision Detection, Christer Ericson, 5.1.5
+		/// </summary>
+		inline void SolveTriangle(Simplex& simplex, unsigned int indexA, unsigned int indexB, unsigned int indexC) noexcept
+		{
+			const SimplexVertex a = simplex.vertices[indexA];
+			const SimplexVertex b = simplex.vertices[indexB];
+			const SimplexVertex c = simplex.vertices[indexC];
+			const math::Vector<3, float> ab = b.point - a.point;
+			const math::Vector<3, float> ac = c.point - a.point;
+
+			const float d1 = math::dot(ab, -a.point);
+			const float d2 = math::dot(ac, -a.point);
+			if (d1 <= 0.0f && d2 <= 0.0f)
+			{
+				simplex.vertices[0] = a;
+				simplex.barycentric[0] = 1.0f;
+				simplex.count = 1;
+				return;
+			}
+
+			const float d3 = math::dot(ab, -b.point);
+			const float d4 = math::dot(ac, -b.point);
+			if (d3 >= 0.0f && d4 <= d3)
+			{
+				simplex.vertices[0] = b;
+				simplex.barycentric[0] = 1.0f;
+				simplex.count = 1;
+				return;
+			}
+
+			const float vc = d1 * d4 - d3 * d2;
+			if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+			{
+				const float v = d1 / (d1 - d3);
+				simplex.vertices[0] = a;
+				simplex.vertices[1] = b;
+				simplex.barycentric[0] = 1.0f - v;
+				simplex.barycentric[1] = v;
+				simplex.count = 2;
+				return;
+			}
+
+			const float d5 = math::dot(ab, -c.point);
+			const float d6 = math::dot(ac, -c.point);
+			if (d6 >= 0.0f && d5 <= d6)
+			{
+				simplex.vertices[0] = c;
+				simplex.barycentric[0] = 1.0f;
+				simplex.count = 1;
+				return;
+			}
+
+			const float vb = d5 * d2 - d1 * d6;
+			if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+			{
+				const float w = d2 / (d2 - d6);
+				simplex.vertices[0] = a;
+				simplex.vertices[1] = c;
+				simplex.barycentric[0] = 1.0f - w;
+				simplex.barycentric[1] = w;
+				simplex.count = 2;
+				return;
+			}
+
+			const float va = d3 * d6 - d5 * d4;
+			if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+			{
+				const float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+				simplex.vertices[0] = b;
+				simplex.vertices[1] = c;
+				simplex.barycentric[0] = 1.0f - w;
+				simplex.barycentric[1] = w;
+				simplex.count = 2;
+				return;
+			}
+
+			const float denominator = va + vb + vc;
+			if (denominator <= 0.0f)
+			{
+				// degenerated triangle
+				SolveSegment(simplex, indexA, indexB);
+				return;
+			}
+
+			const float v = vb / denominator;
+			const float w = vc / denominator;
+			simplex.vertices[0] = a;
+			simplex.vertices[1] = b;
+			simplex.vertices[2] = c;
+			simplex.barycentric[0] = 1.0f - v - w;
+			simplex.barycentric[1] = v;
+			simplex.barycentric[2] = w;
+			simplex.count = 3;
+		}
+
+		/// <summary>
+		/// Reduce simplex to vertices of feature closest to origin
+		/// reference : Real-Time Collision Detection, Christer Ericson, 5.1.6
+		/// </summary>
+		/// <returns>true if origin is inside of tetrahedron</returns>
+		inline bool SolveTetrahedron(Simplex& simplex) noexcept
+		{
+			// face and vertex opposite to face
+			constexpr unsigned int faces[4][4]{ { 0, 1, 2, 3 }, { 0, 2, 3, 1 }, { 0, 3, 1, 2 }, { 1, 3, 2, 0 } };
+
+			const Simplex tetrahedron = simplex;
+			float bestSqrDistance = math::infinity<float>();
+			bool isOutsideOfAnyFace = false;
+
+			for (const unsigned int* face : faces)
+			{
+				const math::Vector<3, float>& a = tetrahedron.vertices[face[0]].point;
+				const math::Vector<3, float> normal = math::cross(tetrahedron.vertices[face[1]].point - a, tetrahedron.vertices[face[2]].point - a);
+				const float signOfOrigin = math::dot(-a, normal);
+				const float signOfOppositeVertex = math::dot(tetrahedron.vertices[face[3]].point - a, normal);
+
+				// flat tetrahedron can't contain origin
+				const bool isOutside = (signOfOrigin * signOfOppositeVertex < 0.0f) || math::abs(signOfOppositeVertex) <= math::epsilon<float>();
+				if (isOutside == false)
+				{
+					continue;
+				}
+				isOutsideOfAnyFace = true;
+
+				Simplex faceSimplex = tetrahedron;
+				SolveTriangle(faceSimplex, face[0], face[1], face[2]);
+				const math::Vector<3, float> closestPoint = faceSimplex.GetClosestPoint();
+				const float sqrDistance = math::dot(closestPoint, closestPoint);
+				if (sqrDistance < bestSqrDistance)
+				{
+					bestSqrDistance = sqrDistance;
+					simplex = faceSimplex;
+				}
+			}
+
+			return isOutsideOfAnyFace == false;
+		}
+
+		/// <returns>true if origin is inside of simplex</returns>
+		inline bool SolveSimplex(Simplex& simplex) noexcept
+		{
+			switch (simplex.count)
+			{
+			case 1:
+				simplex.barycentric[0] = 1.0f;
+				return false;
+			case 2:
+				SolveSegment(simplex, 0, 1);
+				return false;
+			case 3:
+				SolveTriangle(simplex, 0, 1, 2);
+				return false;
+			default:
+				return SolveTetrahedron(simplex);
+			}
+		}
+
+		/// <summary>
+		/// Run GJK until closest points are found or origin is enclosed
+		/// </summary>
+		/// <returns>true if hulls are intersecting</returns>
+		inline bool RunGJK(const ConvexHull& hullA, const ConvexHull& hullB, GJKCache* cache, Simplex& simplex) noexcept
+		{
+			simplex.count = 0;
+			if (cache != nullptr)
+			{
+				for (unsigned int i = 0; i < cache->count; ++i)
+				{
+					if (cache->vertexIndexA[i] < hullA.vertexCount && cache->vertexIndexB[i] < hullB.vertexCount)
+					{
+						SimplexVertex& vertex = simplex.vertices[simplex.count++];
+						vertex.vertexIndexA = cache->vertexIndexA[i];
+						vertex.vertexIndexB = cache->vertexIndexB[i];
+						vertex.pointA = hullA.GetVertex(vertex.vertexIndexA);
+						vertex.pointB = hullB.GetVertex(vertex.vertexIndexB);
+						vertex.point = vertex.pointA - vertex.pointB;
+					}
+				}
+			}
+
+			if (simplex.count == 0)
+			{
+				simplex.vertices[0] = ComputeSupport(hullA, hullB, hullB.position - hullA.position + math::Vector<3, float>{ math::epsilon<float>(), 0.0f, 0.0f });
+				simplex.count = 1;
+			}
+
+			bool isIntersecting = false;
+			float lastSqrDistance = math::infinity<float>();
+			Simplex lastSimplex;
+
+			for (unsigned int iteration = 0; iteration < GJK_MAX_ITERATION_COUNT; ++iteration)
+			{
+				if (SolveSimplex(simplex) == true)
+				{
+					isIntersecting = true;
+					break;
+				}
+
+				const math::Vector<3, float> closestPoint = simplex.GetClosestPoint();
+				const float sqrDistance = math::dot(closestPoint, closestPoint);
+				if (sqrDistance <= GJK_INTERSECTION_TOLERANCE * GJK_INTERSECTION_TOLERANCE)
+				{
+					isIntersecting = true;
+					break;
+				}
+
+				// distance should decrease every iteration
+				// when it doesn't, new vertex was almost on closest feature and solving simplex lost precision. keep last simplex
+				if (sqrDistance >= lastSqrDistance)
+				{
+					simplex = lastSimplex;
+					break;
+				}
+				lastSqrDistance = sqrDistance;
+				lastSimplex = simplex;
+
+				const SimplexVertex support = ComputeSupport(hullA, hullB, -closestPoint);
+				if (simplex.Contains(support.vertexIndexA, support.vertexIndexB) == true)
+				{
+					break;
+				}
+
+				// no more progress toward origin
+				if (sqrDistance - math::dot(closestPoint, support.point) <= GJK_RELATIVE_TOLERANCE * sqrDistance)
+				{
+					break;
+				}
+
+				simplex.vertices[simplex.count++] = support;
+			}
+
+			if (cache != nullptr)
+			{
+				cache->count = simplex.count;
+				for (unsigned int i = 0; i < simplex.count; ++i)
+				{
+					cache->vertexIndexA[i] = simplex.vertices[i].vertexIndexA;
+					cache->vertexIndexB[i] = simplex.vertices[i].vertexIndexB;
+				}
+			}
+
+			return isIntersecting;
+		}
+
+		/// <summary>
+		/// Add vertices to simplex enclosing origin until it becomes tetrahedron
+		/// When origin is on boundary of minkowski difference, simplex can be lower than tetrahedron
+		/// </summary>
+		/// <returns>false if tetrahedron can't be made ( flat minkowski difference )</returns>
+		inline bool ExpandSimplexToTetrahedron(const ConvexHull& hullA, const ConvexHull& hullB, Simplex& simplex) noexcept
+		{
+			const math::Vector<3, float> axes[3]{ { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+
+			if (simplex.count == 1)
+			{
+				for (unsigned int i = 0; i < 6 && simplex.count == 1; ++i)
+				{
+					const SimplexVertex support = ComputeSupport(hullA, hullB, (i % 2 == 0) ? axes[i / 2] : -axes[i / 2]);
+					if ((support.point - simplex.vertices[0].point).sqrMagnitude() > GJK_INTERSECTION_TOLERANCE)
+					{
+						simplex.vertices[simplex.count++] = support;
+					}
+				}
+			}
+
+			if (simplex.count == 2)
+			{
+				const math::Vector<3, float> segment = simplex.vertices[1].point - simplex.vertices[0].point;
+
+				// axis of smallest component is least parallel to segment
+				unsigned int axisIndex = 0;
+				if (math::abs(segment.y) < math::abs(segment[axisIndex]))
+				{
+					axisIndex = 1;
+				}
+				if (math::abs(segment.z) < math::abs(segment[axisIndex]))
+				{
+					axisIndex = 2;
+				}
+				const math::Vector<3, float> perpendicular0 = math::cross(segment, axes[axisIndex]);
+				const math::Vector<3, float> perpendicular1 = math::cross(segment, perpendicular0);
+				const math::Vector<3, float> directions[4]{ perpendicular0, -perpendicular0, perpendicular1, -perpendicular1 };
+
+				for (unsigned int i = 0; i < 4 && simplex.count == 2; ++i)
+				{
+					const SimplexVertex support = ComputeSupport(hullA, hullB, directions[i]);
+					if (math::cross(support.point - simplex.vertices[0].point, segment).sqrMagnitude() > GJK_INTERSECTION_TOLERANCE)
+					{
+						simplex.vertices[simplex.count++] = support;
+					}
+				}
+			}
+
+			if (simplex.count == 3)
+			{
+				const math::Vector<3, float> normal = math::cross(simplex.vertices[1].point - simplex.vertices[0].point, simplex.vertices[2].point - simplex.vertices[0].point);
+				for (unsigned int i = 0; i < 2 && simplex.count == 3; ++i)
+				{
+					const SimplexVertex support = ComputeSupport(hullA, hullB, (i == 0) ? normal : -normal);
+					if (math::abs(math::dot(support.point - simplex.vertices[0].point, normal)) > GJK_INTERSECTION_TOLERANCE)
+					{
+						simplex.vertices[simplex.count++] = support;
+					}
+				}
+			}
+
+			return simplex.count == 4;
+		}
+
+		struct PolytopeFace
+		{
+			unsigned int vertexIndex[3];
+			math::Vector<3, float> normal;
+			float distance;
+		};
+
+		[[nodiscard]] inline PolytopeFace MakePolytopeFace(const std::vector<SimplexVertex>& vertices, unsigned int a, unsigned int b, unsigned int c) noexcept
+		{
+			PolytopeFace face{ { a, b, c }, math::Vector<3, float>{}, math::infinity<float>() };
+			const math::Vector<3, float> normal = math::cross(vertices[b].point - vertices[a].point, vertices[c].point - vertices[a].point);
+			const float length = normal.magnitude();
+			if (length > math::epsilon<float>())
+			{
+				face.normal = normal / length;
+				face.distance = math::dot(face.normal, vertices[a].point);
+			}
+			return face;
+		}
+
+		/// <summary>
+		/// Expanding polytope algorithm
+		/// Expand polytope from tetrahedron enclosing origin until face closest to origin is on boundary of minkowski difference
+		/// </summary>
+		inline void RunEPA(const ConvexHull& hullA, const ConvexHull& hullB, const Simplex& tetrahedron, GJKResult& result)
+		{
+			std::vector<SimplexVertex> vertices(tetrahedron.vertices, tetrahedron.vertices + 4);
+
+			// wind faces to make normals point outward
+			if (math::dot(math::cross(vertices[1].point - vertices[0].point, vertices[2].point - vertices[0].point), vertices[3].point - vertices[0].point) > 0.0f)
+			{
+				std::swap(vertices[1], vertices[2]);
+			}
+
+			std::vector<PolytopeFace> faces
+			{
+				MakePolytopeFace(vertices, 0, 1, 2),
+				MakePolytopeFace(vertices, 0, 3, 1),
+				MakePolytopeFace(vertices, 0, 2, 3),
+				MakePolytopeFace(vertices, 1, 3, 2)
+			};
+			std::vector<std::pair<unsigned int, unsigned int>> horizonEdges;
+
+			size_t closestFaceIndex = 0;
+			for (unsigned int iteration = 0; iteration < EPA_MAX_ITERATION_COUNT; ++iteration)
+			{
+				closestFaceIndex = 0;
+				for (size_t faceIndex = 1; faceIndex < faces.size(); ++faceIndex)
+				{
+					if (faces[faceIndex].distance < faces[closestFaceIndex].distance)
+					{
+						closestFaceIndex = faceIndex;
+					}
+				}
+
+				const PolytopeFace closestFace = faces[closestFaceIndex];
+				const SimplexVertex support = ComputeSupport(hullA, hullB, closestFace.normal);
+				if (math::dot(support.point, closestFace.normal) - closestFace.distance < EPA_TOLERANCE)
+				{
+					break;
+				}
+
+				// remove faces seen from support point and collect their boundary
+				const unsigned int supportIndex = static_cast<unsigned int>(vertices.size());
+				vertices.push_back(support);
+				horizonEdges.clear();
+				for (size_t faceIndex = 0; faceIndex < faces.size();)
+				{
+					const PolytopeFace& face = faces[faceIndex];
+					if (math::dot(face.normal, support.point - vertices[face.vertexIndex[0]].point) <= 0.0f)
+					{
+						++faceIndex;
+						continue;
+					}
+
+					for (unsigned int edge = 0; edge < 3; ++edge)
+					{
+						const std::pair<unsigned int, unsigned int> edgeVertices{ face.vertexIndex[edge], face.vertexIndex[(edge + 1) % 3] };
+
+						// edge shared by two removed faces isn't on horizon
+						auto reversedEdge = std::find(horizonEdges.begin(), horizonEdges.end(), std::make_pair(edgeVertices.second, edgeVertices.first));
+						if (reversedEdge != horizonEdges.end())
+						{
+							horizonEdges.erase(reversedEdge);
+						}
+						else
+						{
+							horizonEdges.push_back(edgeVertices);
+						}
+					}
+
+					faces[faceIndex] = faces.back();
+					faces.pop_back();
+				}
+
+				for (const std::pair<unsigned int, unsigned int>& edge : horizonEdges)
+				{
+					faces.push_back(MakePolytopeFace(vertices, edge.first, edge.second, supportIndex));
+				}
+
+				if (faces.empty() == true)
+				{
+					faces.push_back(closestFace);
+					break;
+				}
+			}
+
+			closestFaceIndex = 0;
+			for (size_t faceIndex = 1; faceIndex < faces.size(); ++faceIndex)
+			{
+				if (faces[faceIndex].distance < faces[closestFaceIndex].distance)
+				{
+					closestFaceIndex = faceIndex;
+				}
+			}
+			const PolytopeFace& face = faces[closestFaceIndex];
+
+			// barycentric coordinate of origin projected to face
+			const SimplexVertex& a = vertices[face.vertexIndex[0]];
+			const SimplexVertex& b = vertices[face.vertexIndex[1]];
+			const SimplexVertex& c = vertices[face.vertexIndex[2]];
+			const math::Vector<3, float> projectedOrigin = face.normal * face.distance;
+			const math::Vector<3, float> v0 = b.point - a.point;
+			const math::Vector<3, float> v1 = c.point - a.point;
+			const math::Vector<3, float> v2 = projectedOrigin - a.point;
+			const float d00 = math::dot(v0, v0);
+			const float d01 = math::dot(v0, v1);
+			const float d11 = math::dot(v1, v1);
+			const float d20 = math::dot(v2, v0);
+			const float d21 = math::dot(v2, v1);
+			const float denominator = d00 * d11 - d01 * d01;
+
+			float v = 0.0f;
+			float w = 0.0f;
+			if (math::abs(denominator) > math::epsilon<float>())
+			{
+				v = (d11 * d20 - d01 * d21) / denominator;
+				w = (d00 * d21 - d01 * d20) / denominator;
+			}
+			const float u = 1.0f - v - w;
+
+			// face normal points outward of A - B. Moving B along it by face distance moves origin out of A - B
+			result.penetrationDepth = math::Max(face.distance, 0.0f);
+			result.normal = face.normal;
+			result.pointA = a.pointA * u + b.pointA * v + c.pointA * w;
+			result.pointB = a.pointB * u + b.pointB * v + c.pointB * w;
+		}
+	}
+
+	/// <summary>
+	/// GJK distance between two convex hulls
+	/// When hulls are intersecting, only isIntersecting is meaningful. Use ComputeConvexHullPenetration for penetration depth
+	///
+	/// reference :
+	/// A Fast Procedure for Computing the Distance Between Complex Objects in Three-Dimensional Space, Gilbert et al.
+	/// Real-Time Collision Detection, Christer Ericson
+	/// </summary>
+	/// <param name="cache">can be nullptr. When not nullptr, GJK starts from cached simplex and cache is updated</param>
+	inline GJKResult ComputeConvexHullDistance(const ConvexHull& hullA, const ConvexHull& hullB, GJKCache* cache = nullptr) noexcept
+	{
+		detail::Simplex simplex;
+		GJKResult result{};
+		result.isIntersecting = detail::RunGJK(hullA, hullB, cache, simplex);
+
+		simplex.GetClosestPoints(result.pointA, result.pointB);
+		if (result.isIntersecting == false)
+		{
+			const math::Vector<3, float> delta = result.pointB - result.pointA;
+			result.distance = delta.magnitude();
+			result.normal = (result.distance > 0.0f) ? delta / result.distance : math::Vector<3, float>{};
+		}
+		return result;
+	}
+
+	[[nodiscard]] inline bool IsConvexHullOverlap(const ConvexHull& hullA, const ConvexHull& hullB, GJKCache* cache = nullptr) noexcept
+	{
+		detail::Simplex simplex;
+		return detail::RunGJK(hullA, hullB, cache, simplex);
+	}
+
+	/// <summary>
+	/// GJK, then EPA when hulls are intersecting
+	/// </summary>
+	/// <param name="cache">can be nullptr. When not nullptr, GJK starts from cached simplex and cache is updated</param>
+	inline GJKResult ComputeConvexHullPenetration(const ConvexHull& hullA, const ConvexHull& hullB, GJKCache* cache = nullptr)
+	{
+		detail::Simplex simplex;
+		GJKResult result{};
+		result.isIntersecting = detail::RunGJK(hullA, hullB, cache, simplex);
+
+		simplex.GetClosestPoints(result.pointA, result.pointB);
+		if (result.isIntersecting == false)
+		{
+			const math::Vector<3, float> delta = result.pointB - result.pointA;
+			result.distance = delta.magnitude();
+			result.normal = (result.distance > 0.0f) ? delta / result.distance : math::Vector<3, float>{};
+			return result;
+		}
+
+		if (detail::ExpandSimplexToTetrahedron(hullA, hullB, simplex) == true)
+		{
+			detail::RunEPA(hullA, hullB, simplex, result);
+		}
+		return result;
+	}
+}
@@ -91,3 +91,57 @@
 #endif
 
 
+namespace math
+{
+	enum class Handedness
+	{
+		Left,
+		Right
+	};
+
+	/// <summary>
+	/// Range of NDC z
+	/// </summary>
+	enum class ClipRange
+	{
+		ZeroToOne,
+		NegativeOneToOne
+	};
+
+	/// <summary>
+	/// Compile time convention of view and clip space
+	/// Functions templated on policy ( Ex) perspective<LeftHandZeroToOne> ) are resolved at compile time,
+	/// so several conventions can be used in one binary. Functions without policy use CurrentClipSpace
+	/// </summary>
+	template <Handedness HandednessValue, ClipRange ClipRangeValue>
+	struct ClipSpacePolicy
+	{
+		static constexpr Handedness handedness = HandednessValue;
+		static constexpr ClipRange clipRange = ClipRangeValue;
+	};
+
+	using LeftHandZeroToOne = ClipSpacePolicy<Handedness::Left, ClipRange::ZeroToOne>; // DirectX, Metal, Vulkan
+	using LeftHandNegativeOneToOne = ClipSpacePolicy<Handedness::Left, ClipRange::NegativeOneToOne>;
+	using RightHandZeroToOne = ClipSpacePolicy<Handedness::Right, ClipRange::ZeroToOne>;
+	using RightHandNegativeOneToOne = ClipSpacePolicy<Handedness::Right, ClipRange::NegativeOneToOne>; // OpenGL
+
+#if CURRENT_SETTING == LEFT_HAND_ZERO_TO_ONE
+	using CurrentClipSpace = LeftHandZeroToOne;
+#elif CURRENT_SETTING == LEFT_HAND_NEGATIVE_ONE_TO_ONE
+	using CurrentClipSpace = LeftHandNegativeOneToOne;
+#elif CURRENT_SETTING == RIGHT_HAND_ZERO_TO_ONE
+	using CurrentClipSpace = RightHandZeroToOne;
+#elif CURRENT_SETTING == RIGHT_HAND_NEGATIVE_ONE_TO_ONE
+	using CurrentClipSpace = RightHandNegativeOneToOne;
+#endif
+
+	template <typename T>
+	struct IsClipSpacePolicy : std::false_type {};
+
+	template <Handedness HandednessValue, ClipRange ClipRangeValue>
+	struct IsClipSpacePolicy<ClipSpacePolicy<HandednessValue, ClipRangeValue>> : std::true_type {};
+}
+
+#ifndef CHECK_IS_CLIP_SPACE_POLICY
+#define CHECK_IS_CLIP_SPACE_POLICY(t) math::IsClipSpacePolicy<t>::value
+#endif
@@ -624,7 +624,7 @@ namespace math
 	/// Extract 6 Planes From MVPMatrix
 	/// Scalar Version
 	/// </summary>
-	template <typename T>
+	template <typename T, std::enable_if_t<CHECK_IS_NUMBER(T), bool> = true>
 	inline constexpr void ExtractPlanesFromVIewProjectionMatrix(const Matrix<4, 4, T>& viewProjectionMatrix, math::Vector<4, T>* sixPlanes, bool normalize) noexcept
 	{
 		sixPlanes[0].x = viewProjectionMatrix[0][3] + viewProjectionMatrix[0][0];
@@ -659,16 +659,16 @@ namespace math
 		// Normalize the plane equations, if requested
 		if (normalize == true)
 		{
-			sixPlanes[0].Normalize();
-			sixPlanes[1].Normalize();
-			sixPlanes[2].Normalize();
-			sixPlanes[3].Normalize();
-			sixPlanes[4].Normalize();
-			sixPlanes[5].Normalize();
+			NormalizePlane(sixPlanes[0]);
+			NormalizePlane(sixPlanes[1]);
+			NormalizePlane(sixPlanes[2]);
+			NormalizePlane(sixPlanes[3]);
+			NormalizePlane(sixPlanes[4]);
+			NormalizePlane(sixPlanes[5]);
 		}
 	}
 
-	template <typename T>
+	template <typename T, std::enable_if_t<CHECK_IS_NUMBER(T), bool> = true>
 	inline constexpr void ExtractSIMDPlanesFromViewProjectionMatrix(const Matrix<4, 4, T>& viewProjectionMatrix, math::Vector<4, T>* eightPlanes, bool normalize) noexcept
 	{
 
@@ -718,6 +718,82 @@ namespace math
 
 	}
 
+	/// <summary>
+	/// Extract 6 planes of each view projection matrix
+	/// outSixPlanes[matrixIndex * 6 ~ matrixIndex * 6 + 5] are planes of viewProjectionMatrices[matrixIndex]
+	/// </summary>
+	template <typename T>
+	inline void ExtractPlanesFromViewProjectionMatrices(const Matrix<4, 4, T>* viewProjectionMatrices, size_t matrixCount, math::Vector<4, T>* outSixPlanes, bool normalize) noexcept
+	{
+		for (size_t matrixIndex = 0; matrixIndex < matrixCount; ++matrixIndex)
+		{
+			ExtractPlanesFromVIewProjectionMatrix(viewProjectionMatrices[matrixIndex], outSixPlanes + matrixIndex * 6, normalize);
+		}
+	}
+
+	/// <summary>
+	/// Extract planes for SIMD computation of each view projection matrix
+	/// outEightPlanes[matrixIndex * 8 ~ matrixIndex * 8 + 7] are planes of viewProjectionMatrices[matrixIndex]
+	/// </summary>
+	template <typename T>
+	inline void ExtractSIMDPlanesFromViewProjectionMatrices(const Matrix<4, 4, T>* viewProjectionMatrices, size_t matrixCount, math::Vector<4, T>* outEightPlanes, bool normalize) noexcept
+	{
+		for (size_t matrixIndex = 0; matrixIndex < matrixCount; ++matrixIndex)
+		{
+			ExtractSIMDPlanesFromViewProjectionMatrix(viewProjectionMatrices[matrixIndex], outEightPlanes + matrixIndex * 8, normalize);
+		}
+	}
+
+	/// <summary>
+	/// Extract 6 Planes From MVPMatrix made with clip space convention of Policy
+	/// Functions without policy take near plane as row3 + row2 ( -w <= z ).
+	/// Near plane of ClipRange::ZeroToOne is row2 ( 0 <= z )
+	/// </summary>
+	template <typename Policy, typename T, std::enable_if_t<CHECK_IS_CLIP_SPACE_POLICY(Policy), bool> = true>
+	inline void ExtractPlanesFromVIewProjectionMatrix(const Matrix<4, 4, T>& viewProjectionMatrix, math::Vector<4, T>* sixPlanes, bool normalize) noexcept
+	{
+		if constexpr (Policy::clipRange == ClipRange::NegativeOneToOne)
+		{
+			ExtractPlanesFromVIewProjectionMatrix(viewProjectionMatrix, sixPlanes, normalize);
+		}
+		else
+		{
+			ExtractPlanesFromVIewProjectionMatrix(viewProjectionMatrix, sixPlanes, false);
+			sixPlanes[4] = math::Vector<4, T>(viewProjectionMatrix[0][2], viewProjectionMatrix[1][2], viewProjectionMatrix[2][2], viewProjectionMatrix[3][2]);
+			if (normalize == true)
+			{
+				for (size_t planeIndex = 0; planeIndex < 6; ++planeIndex)
+				{
+					NormalizePlane(sixPlanes[planeIndex]);
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// Extract Planes for SIMD computation from VP Matrix made with clip space convention of Policy
+	/// Layout is same with ExtractSIMDPlanesFromViewProjectionMatrix
+	/// </summary>
+	template <typename Policy, typename T, std::enable_if_t<CHECK_IS_CLIP_SPACE_POLICY(Policy), bool> = true>
+	inline void ExtractSIMDPlanesFromViewProjectionMatrix(const Matrix<4, 4, T>& viewProjectionMatrix, math::Vector<4, T>* eightPlanes, bool normalize) noexcept
+	{
+		ExtractSIMDPlanesFromViewProjectionMatrix(viewProjectionMatrix, eightPlanes, normalize);
+		if constexpr (Policy::clipRange == ClipRange::ZeroToOne)
+		{
+			// replace lane of plane 4 with near plane of zero to one clip range
+			math::Vector<4, T> nearPlane(viewProjectionMatrix[0][2], viewProjectionMatrix[1][2], viewProjectionMatrix[2][2], viewProjectionMatrix[3][2]);
+			if (normalize == true)
+			{
+				NormalizePlane(nearPlane);
+			}
+			for (size_t component = 0; component < 4; ++component)
+			{
+				eightPlanes[4 + component].x = nearPlane[component];
+				eightPlanes[4 + component].z = nearPlane[component];
+			}
+		}
+	}
+
 }
 
 #include "SIMD_Core.h"
@@ -945,8 +945,54 @@ namespace math
 // 		return ON_PLANE;
 // 	}
 
+	namespace detail
+	{
+		/// <summary>
+		/// Extract planes of view projection matrix in SIMD layout
+		/// Plane is row 3 plus or minus row 0, 1, 2 of matrix,
+		/// so component k of every plane is made from columns[k] without transpose
+		/// Normalization uses rsqrt with one Newton-Raphson step
+		/// </summary>
+		FORCE_INLINE void ExtractSIMDPlanes(const Matrix<4, 4, float>& viewProjectionMatrix, M128F* outEightPlanes, bool normalize) noexcept
+		{
+			const M128F* columns = reinterpret_cast<const M128F*>(&viewProjectionMatrix);
+
+			// Plane0 ~ 3 : row 3 + row 0, row 3 - row 0, row 3 - row 1, row 3 + row 1
+			const M128F signs0123 = _mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f);
+			// Plane4, 5, 4, 5 : row 3 + row 2, row 3 - row 2
+			const M128F signs45 = _mm_setr_ps(1.0f, -1.0f, 1.0f, -1.0f);
+
+			for (size_t componentIndex = 0; componentIndex < 4; ++componentIndex)
+			{
+				const M128F row3 = M128F_REPLICATE(columns[componentIndex], 3);
+				outEightPlanes[componentIndex] = M128F_MUL_AND_ADD(M128F_SWIZZLE(columns[componentIndex], 0, 0, 1, 1), signs0123, row3);
+				outEightPlanes[componentIndex + 4] = M128F_MUL_AND_ADD(M128F_REPLICATE(columns[componentIndex], 2), signs45, row3);
+			}
+
+			if (normalize == true)
+			{
+				const M128F half = _mm_set1_ps(0.5f);
+				const M128F three = _mm_set1_ps(3.0f);
+				for (size_t groupOffset = 0; groupOffset < 8; groupOffset += 4)
+				{
+					M128F sqrLength = M128F_MUL(outEightPlanes[groupOffset], outEightPlanes[groupOffset]);
+					sqrLength = M128F_MUL_AND_ADD(outEightPlanes[groupOffset + 1], outEightPlanes[groupOffset + 1], sqrLength);
+					sqrLength = M128F_MUL_AND_ADD(outEightPlanes[groupOffset + 2], outEightPlanes[groupOffset + 2], sqrLength);
+
+					M128F inverseLength = _mm_rsqrt_ps(sqrLength);
+					inverseLength = M128F_MUL(M128F_MUL(half, inverseLength), M128F_SUB(three, M128F_MUL(M128F_MUL(sqrLength, inverseLength), inverseLength)));
+
+					for (size_t componentIndex = 0; componentIndex < 4; ++componentIndex)
+					{
+						outEightPlanes[groupOffset + componentIndex] = M128F_MUL(outEightPlanes[groupOffset + componentIndex], inverseLength);
+					}
+				}
+			}
+		}
+	}
+
 	/// <summary>
-	/// Extract 6 Planes ( 8 Planes ) From MVPMatrix
+	/// Extract 6 Planes From MVPMatrix
 	/// SIMD Version
 	///  sixPlanes[0] : x of Plane0, y of Plane0, z of Plane0, w of Plane0
 	///  sixPlanes[1] : x of Plane1, y of Plane1, z of Plane1, w of Plane1
@@ -954,6 +1000,9 @@ namespace math
 	///  sixPlanes[3] : x of Plane3, y of Plane3, z of Plane3, w of Plane3
 	///  sixPlanes[4] : x of Plane4, y of Plane4, z of Plane4, w of Plane4
 	///  sixPlanes[5] : x of Plane5, y of Plane5, z of Plane5, w of Plane5
+	/// 
+	/// Planes are extracted in SIMD layout and transposed
+	/// 
 	/// references :
 	/// https://www.slideshare.net/DICEStudio/culling-the-battlefield-data-oriented-design-in-practice
 	/// https://www.gamedevs.org/uploads/fast-extraction-viewing-frustum-planes-from-world-view-projection-matrix.pdf
@@ -962,51 +1011,21 @@ namespace math
 	template <>
 	inline void ExtractPlanesFromVIewProjectionMatrix(const Matrix<4, 4, float>& viewProjectionMatrix, math::Vector<4, float>* sixPlanes, bool normalize) noexcept
 	{
-		sixPlanes[0].x = viewProjectionMatrix[0][3] + viewProjectionMatrix[0][0];
-		sixPlanes[0].y = viewProjectionMatrix[1][3] + viewProjectionMatrix[1][0];
-		sixPlanes[0].z = viewProjectionMatrix[2][3] + viewProjectionMatrix[2][0];
-		sixPlanes[0].w = viewProjectionMatrix[3][3] + viewProjectionMatrix[3][0];
-		// Right clipping plane
-		sixPlanes[1].x = viewProjectionMatrix[0][3] - viewProjectionMatrix[0][0];
-		sixPlanes[1].y = viewProjectionMatrix[1][3] - viewProjectionMatrix[1][0];
-		sixPlanes[1].z = viewProjectionMatrix[2][3] - viewProjectionMatrix[2][0];
-		sixPlanes[1].w = viewProjectionMatrix[3][3] - viewProjectionMatrix[3][0];
-		// Top clipping plane
-		sixPlanes[2].x = viewProjectionMatrix[0][3] - viewProjectionMatrix[0][1];
-		sixPlanes[2].y = viewProjectionMatrix[1][3] - viewProjectionMatrix[1][1];
-		sixPlanes[2].z = viewProjectionMatrix[2][3] - viewProjectionMatrix[2][1];
-		sixPlanes[2].w = viewProjectionMatrix[3][3] - viewProjectionMatrix[3][1];
-		// Bottom clipping plane
-		sixPlanes[3].x = viewProjectionMatrix[0][3] + viewProjectionMatrix[0][1];
-		sixPlanes[3].y = viewProjectionMatrix[1][3] + viewProjectionMatrix[1][1];
-		sixPlanes[3].z = viewProjectionMatrix[2][3] + viewProjectionMatrix[2][1];
-		sixPlanes[3].w = viewProjectionMatrix[3][3] + viewProjectionMatrix[3][1];
-		// Near clipping plane
-		sixPlanes[4].x = viewProjectionMatrix[0][3] + viewProjectionMatrix[0][2];
-		sixPlanes[4].y = viewProjectionMatrix[1][3] + viewProjectionMatrix[1][2];
-		sixPlanes[4].z = viewProjectionMatrix[2][3] + viewProjectionMatrix[2][2];
-		sixPlanes[4].w = viewProjectionMatrix[3][3] + viewProjectionMatrix[3][2];
-		// Far clipping plane
-		sixPlanes[5].x = viewProjectionMatrix[0][3] - viewProjectionMatrix[0][2];
-		sixPlanes[5].y = viewProjectionMatrix[1][3] - viewProjectionMatrix[1][2];
-		sixPlanes[5].z = viewProjectionMatrix[2][3] - viewProjectionMatrix[2][2];
-		sixPlanes[5].w = viewProjectionMatrix[3][3] - viewProjectionMatrix[3][2];
-
-		// Normalize the plane equations, if requested
-		if (normalize == true)
-		{
-			NormalizePlane(sixPlanes[0]);
-			NormalizePlane(sixPlanes[1]);
-			NormalizePlane(sixPlanes[2]);
-			NormalizePlane(sixPlanes[3]);
-			NormalizePlane(sixPlanes[4]);
-			NormalizePlane(sixPlanes[5]);
-		}
+		M128F eightPlanes[8];
+		detail::ExtractSIMDPlanes(viewProjectionMatrix, eightPlanes, normalize);
+
+		_MM_TRANSPOSE4_PS(eightPlanes[0], eightPlanes[1], eightPlanes[2], eightPlanes[3]);
+		_MM_TRANSPOSE4_PS(eightPlanes[4], eightPlanes[5], eightPlanes[6], eightPlanes[7]);
+
+		M128F* m128f_sixPlanes = reinterpret_cast<M128F*>(sixPlanes);
+		m128f_sixPlanes[0] = eightPlanes[0];
+		m128f_sixPlanes[1] = eightPlanes[1];
+		m128f_sixPlanes[2] = eightPlanes[2];
+		m128f_sixPlanes[3] = eightPlanes[3];
+		m128f_sixPlanes[4] = eightPlanes[4];
+		m128f_sixPlanes[5] = eightPlanes[5];
 	}
 
-
-
-
 	/// <summary>
 	/// 
 	///	Extract Planes for SIMD computation from VP Matrix
@@ -1021,59 +1040,27 @@ namespace math
 	/// eightPlanes[5] : y of Plane4, y of Plane5, y of Plane4, y of Plane5
 	/// eightPlanes[6] : z of Plane4, z of Plane5, z of Plane4, z of Plane5
 	/// eightPlanes[7] : w of Plane4, w of Plane5, w of Plane4, w of Plane5
+	/// 
+	/// Planes are written directly from columns of matrix without temporary six planes
 	/// </summary>
-	/// <param name="ModelViewProjectionMatrix"></param>
-	/// <param name="eightPlanes"></param>
-	/// <param name="normalize"></param>
-	/// <returns></returns>
 	template <>
 	inline void ExtractSIMDPlanesFromViewProjectionMatrix(const Matrix<4, 4, float>& viewProjectionMatrix, math::Vector<4, float>* eightPlanes, bool normalize) noexcept
 	{
-		
-		math::Vector4 sixPlane[6]{ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
-
-		ExtractPlanesFromVIewProjectionMatrix(viewProjectionMatrix, sixPlane, normalize);
-
-		eightPlanes[0].x = sixPlane[0].x;
-		eightPlanes[0].y = sixPlane[1].x;
-		eightPlanes[0].z = sixPlane[2].x;
-		eightPlanes[0].w = sixPlane[3].x;
-
-		eightPlanes[1].x = sixPlane[0].y;
-		eightPlanes[1].y = sixPlane[1].y;
-		eightPlanes[1].z = sixPlane[2].y;
-		eightPlanes[1].w = sixPlane[3].y;
-
-		eightPlanes[2].x = sixPlane[0].z;
-		eightPlanes[2].y = sixPlane[1].z;
-		eightPlanes[2].z = sixPlane[2].z;
-		eightPlanes[2].w = sixPlane[3].z;
-
-		eightPlanes[3].x = sixPlane[0].w;
-		eightPlanes[3].y = sixPlane[1].w;
-		eightPlanes[3].z = sixPlane[2].w;
-		eightPlanes[3].w = sixPlane[3].w;
-
-		eightPlanes[4].x = sixPlane[4].x;
-		eightPlanes[4].y = sixPlane[5].x;
-		eightPlanes[4].z = sixPlane[4].x;
-		eightPlanes[4].w = sixPlane[5].x;
-
-		eightPlanes[5].x = sixPlane[4].y;
-		eightPlanes[5].y = sixPlane[5].y;
-		eightPlanes[5].z = sixPlane[4].y;
-		eightPlanes[5].w = sixPlane[5].y;
-
-		eightPlanes[6].x = sixPlane[4].z;
-		eightPlanes[6].y = sixPlane[5].z;
-		eightPlanes[6].z = sixPlane[4].z;
-		eightPlanes[6].w = sixPlane[5].z;
-
-		eightPlanes[7].x = sixPlane[4].w;
-		eightPlanes[7].y = sixPlane[5].w;
-		eightPlanes[7].z = sixPlane[4].w;
-		eightPlanes[7].w = sixPlane[5].w;
-		
+		detail::ExtractSIMDPlanes(viewProjectionMatrix, reinterpret_cast<M128F*>(eightPlanes), normalize);
+	}
+
+	/// <summary>
+	/// Extract planes for SIMD computation of each view projection matrix
+	/// outEightPlanes[matrixIndex * 8 ~ matrixIndex * 8 + 7] are planes of viewProjectionMatrices[matrixIndex]
+	/// </summary>
+	template <>
+	inline void ExtractSIMDPlanesFromViewProjectionMatrices(const Matrix<4, 4, float>* viewProjectionMatrices, size_t matrixCount, math::Vector<4, float>* outEightPlanes, bool normalize) noexcept
+	{
+		M128F* m128f_eightPlanes = reinterpret_cast<M128F*>(outEightPlanes);
+		for (size_t matrixIndex = 0; matrixIndex < matrixCount; ++matrixIndex)
+		{
+			detail::ExtractSIMDPlanes(viewProjectionMatrices[matrixIndex], m128f_eightPlanes + matrixIndex * 8, normalize);
+		}
 	}
 
 }
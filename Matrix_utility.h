@@ -57,14 +57,23 @@ namespace math
 		return Result;
 	}
 
-	template<typename T>
+	template<typename Policy, typename T, std::enable_if_t<CHECK_IS_CLIP_SPACE_POLICY(Policy), bool> = true>
+	inline constexpr math::Matrix<4, 4, T> lookAt(const math::Vector<3, T>& eye, const math::Vector<3, T>& center, const math::Vector<3, T>& up)
+	{
+		if constexpr (Policy::handedness == Handedness::Left)
+		{
+			return lookAtLH(eye, center, up);
+		}
+		else
+		{
+			return lookAtRH(eye, center, up);
+		}
+	}
+
+	template<typename T, std::enable_if_t<CHECK_IS_NUMBER(T), bool> = true>
 	inline constexpr math::Matrix<4, 4, T> lookAt(const math::Vector<3, T>& eye, const math::Vector<3, T>& center, const math::Vector<3, T>& up)
 	{
-#       if (CURRENT_COORDINATE_SYSTEM == LEFT_HAND)
-		return lookAtLH(eye, center, up);
-#       else
-		return lookAtRH(eye, center, up);
-#       endif
+		return lookAt<CurrentClipSpace>(eye, center, up);
 	}
 
 	template<typename T>
@@ -131,18 +140,37 @@ namespace math
 		return Result;
 	}
 
+	template<typename Policy, typename T, std::enable_if_t<CHECK_IS_CLIP_SPACE_POLICY(Policy), bool> = true>
+	inline constexpr math::Matrix<4, 4, T> ortho(T left, T right, T bottom, T top, T zNear, T zFar)
+	{
+		if constexpr (Policy::handedness == Handedness::Left)
+		{
+			if constexpr (Policy::clipRange == ClipRange::ZeroToOne)
+			{
+				return orthoLH_ZO(left, right, bottom, top, zNear, zFar);
+			}
+			else
+			{
+				return orthoLH_NO(left, right, bottom, top, zNear, zFar);
+			}
+		}
+		else
+		{
+			if constexpr (Policy::clipRange == ClipRange::ZeroToOne)
+			{
+				return orthoRH_ZO(left, right, bottom, top, zNear, zFar);
+			}
+			else
+			{
+				return orthoRH_NO(left, right, bottom, top, zNear, zFar);
+			}
+		}
+	}
+
 	template<typename T>
 	inline constexpr math::Matrix<4, 4, T> ortho(T left, T right, T bottom, T top, T zNear, T zFar)
 	{
-#		if CURRENT_SETTING == LEFT_HAND_ZERO_TO_ONE
-		return orthoLH_ZO(left, right, bottom, top, zNear, zFar);
-#		elif CURRENT_SETTING == LEFT_HAND_NEGATIVE_ONE_TO_ONE
-		return orthoLH_NO(left, right, bottom, top, zNear, zFar);
-#		elif CURRENT_SETTING == RIGHT_HAND_ZERO_TO_ONE
-		return orthoRH_ZO(left, right, bottom, top, zNear, zFar);
-#		elif CURRENT_SETTING == RIGHT_HAND_NEGATIVE_ONE_TO_ONE
-		return orthoRH_NO(left, right, bottom, top, zNear, zFar);
-#		endif
+		return ortho<CurrentClipSpace>(left, right, bottom, top, zNear, zFar);
 	}
 
 	template<typename T>
@@ -209,18 +237,37 @@ namespace math
 		return Result;
 	}
 
+	template<typename Policy, typename T, std::enable_if_t<CHECK_IS_CLIP_SPACE_POLICY(Policy), bool> = true>
+	inline constexpr math::Matrix<4, 4, T> perspective(const T& fovy, const T& aspect, const T& zNear, const T& zFar)
+	{
+		if constexpr (Policy::handedness == Handedness::Left)
+		{
+			if constexpr (Policy::clipRange == ClipRange::ZeroToOne)
+			{
+				return perspectiveLH_ZO(fovy, aspect, zNear, zFar);
+			}
+			else
+			{
+				return perspectiveLH_NO(fovy, aspect, zNear, zFar);
+			}
+		}
+		else
+		{
+			if constexpr (Policy::clipRange == ClipRange::ZeroToOne)
+			{
+				return perspectiveRH_ZO(fovy, aspect, zNear, zFar);
+			}
+			else
+			{
+				return perspectiveRH_NO(fovy, aspect, zNear, zFar);
+			}
+		}
+	}
+
 	template<typename T>
 	inline constexpr math::Matrix<4, 4, T> perspective(const T& fovy, const T& aspect, const T& zNear, const T& zFar)
 	{
-#		if CURRENT_SETTING == LEFT_HAND_ZERO_TO_ONE
-			return perspectiveLH_ZO(fovy, aspect, zNear, zFar);
-#		elif CURRENT_SETTING == LEFT_HAND_NEGATIVE_ONE_TO_ONE
-			return perspectiveLH_NO(fovy, aspect, zNear, zFar);
-#		elif CURRENT_SETTING == RIGHT_HAND_ZERO_TO_ONE
-			return perspectiveRH_ZO(fovy, aspect, zNear, zFar);
-#		elif CURRENT_SETTING == RIGHT_HAND_NEGATIVE_ONE_TO_ONE
-			return perspectiveRH_NO(fovy, aspect, zNear, zFar);
-#		endif
+		return perspective<CurrentClipSpace>(fovy, aspect, zNear, zFar);
 	}
 
 
@@ -306,18 +353,37 @@ namespace math
 	}
 
 
+	template<typename Policy, typename T, std::enable_if_t<CHECK_IS_CLIP_SPACE_POLICY(Policy), bool> = true>
+	inline math::Matrix<4, 4, T> perspectiveFov(T fov, T width, T height, T zNear, T zFar)
+	{
+		if constexpr (Policy::handedness == Handedness::Left)
+		{
+			if constexpr (Policy::clipRange == ClipRange::ZeroToOne)
+			{
+				return perspectiveFovLH_ZO(fov, width, height, zNear, zFar);
+			}
+			else
+			{
+				return perspectiveFovLH_NO(fov, width, height, zNear, zFar);
+			}
+		}
+		else
+		{
+			if constexpr (Policy::clipRange == ClipRange::ZeroToOne)
+			{
+				return perspectiveFovRH_ZO(fov, width, height, zNear, zFar);
+			}
+			else
+			{
+				return perspectiveFovRH_NO(fov, width, height, zNear, zFar);
+			}
+		}
+	}
+
 	template<typename T>
 	inline math::Matrix<4, 4, T> perspectiveFov(T fov, T width, T height, T zNear, T zFar)
 	{
-#		if CURRENT_SETTING == LEFT_HAND_ZERO_TO_ONE
-		return perspectiveFovLH_ZO(fov, width, height, zNear, zFar);
-#		elif CURRENT_SETTING == LEFT_HAND_NEGATIVE_ONE_TO_ONE
-		return perspectiveFovLH_NO(fov, width, height, zNear, zFar);
-#		elif CURRENT_SETTING == RIGHT_HAND_ZERO_TO_ONE
-		return perspectiveFovRH_ZO(fov, width, height, zNear, zFar);
-#		elif CURRENT_SETTING == RIGHT_HAND_NEGATIVE_ONE_TO_ONE
-		return perspectiveFovRH_NO(fov, width, height, zNear, zFar);
-#		endif
+		return perspectiveFov<CurrentClipSpace>(fov, width, height, zNear, zFar);
 	}
 
 	/*
@@ -359,14 +425,392 @@ namespace math
 		return math::Vector<3, T>(tmp);
 	}
 
-	template<typename T, typename U>
+	template<typename Policy, typename T, typename U, std::enable_if_t<CHECK_IS_CLIP_SPACE_POLICY(Policy), bool> = true>
+	inline constexpr math::Vector<3, T> project(const math::Vector<3, T>& obj, const math::Matrix<4, 4, T>& model, const math::Matrix<4, 4, T>& proj, const math::Vector<4, U>& viewport)
+	{
+		if constexpr (Policy::clipRange == ClipRange::ZeroToOne)
+		{
+			return projectZeroToOne(obj, model, proj, viewport);
+		}
+		else
+		{
+			return projectNOneToOne(obj, model, proj, viewport);
+		}
+	}
+
+	template<typename T, typename U, std::enable_if_t<CHECK_IS_NUMBER(T), bool> = true>
 	inline constexpr math::Vector<3, T> project(const math::Vector<3, T>& obj, const math::Matrix<4, 4, T>& model, const math::Matrix<4, 4, T>& proj, const math::Vector<4, U>& viewport)
 	{
-#		if CURRENT_CLIP_RANGE == CLIP_RANGE_NEGATIVE_ONE_TO_ONE
-		return projectZeroToOne(obj, model, proj, viewport);
-#		else
-		return projectNOneToOne(obj, model, proj, viewport);
-#		endif
+		return project<CurrentClipSpace>(obj, model, proj, viewport);
+	}
+
+	template<typename T, typename U>
+	inline constexpr math::Vector<3, T> unProjectZeroToOne(const math::Vector<3, T>& win, const math::Matrix<4, 4, T>& model, const math::Matrix<4, 4, T>& proj, const math::Vector<4, U>& viewport)
+	{
+		const math::Matrix<4, 4, T> Inverse = (proj * model).inverse();
+
+		math::Vector<4, T> tmp = math::Vector<4, T>(win, static_cast<T>(1));
+		tmp.x = (tmp.x - T(viewport[0])) / T(viewport[2]);
+		tmp.y = (tmp.y - T(viewport[1])) / T(viewport[3]);
+		tmp.x = tmp.x * static_cast<T>(2) - static_cast<T>(1);
+		tmp.y = tmp.y * static_cast<T>(2) - static_cast<T>(1);
+
+		math::Vector<4, T> obj = Inverse * tmp;
+		obj /= obj.w;
+
+		return math::Vector<3, T>(obj);
+	}
+
+	template<typename T, typename U>
+	inline constexpr math::Vector<3, T> unProjectNOneToOne(const math::Vector<3, T>& win, const math::Matrix<4, 4, T>& model, const math::Matrix<4, 4, T>& proj, const math::Vector<4, U>& viewport)
+	{
+		const math::Matrix<4, 4, T> Inverse = (proj * model).inverse();
+
+		math::Vector<4, T> tmp = math::Vector<4, T>(win, static_cast<T>(1));
+		tmp.x = (tmp.x - T(viewport[0])) / T(viewport[2]);
+		tmp.y = (tmp.y - T(viewport[1])) / T(viewport[3]);
+		tmp = tmp * static_cast<T>(2) - static_cast<T>(1);
+
+		math::Vector<4, T> obj = Inverse * tmp;
+		obj /= obj.w;
+
+		return math::Vector<3, T>(obj);
+	}
+
+	template<typename Policy, typename T, typename U, std::enable_if_t<CHECK_IS_CLIP_SPACE_POLICY(Policy), bool> = true>
+	inline constexpr math::Vector<3, T> unProject(const math::Vector<3, T>& win, const math::Matrix<4, 4, T>& model, const math::Matrix<4, 4, T>& proj, const math::Vector<4, U>& viewport)
+	{
+		if constexpr (Policy::clipRange == ClipRange::ZeroToOne)
+		{
+			return unProjectZeroToOne(win, model, proj, viewport);
+		}
+		else
+		{
+			return unProjectNOneToOne(win, model, proj, viewport);
+		}
+	}
+
+	template<typename T, typename U, std::enable_if_t<CHECK_IS_NUMBER(T), bool> = true>
+	inline constexpr math::Vector<3, T> unProject(const math::Vector<3, T>& win, const math::Matrix<4, 4, T>& model, const math::Matrix<4, 4, T>& proj, const math::Vector<4, U>& viewport)
+	{
+		return unProject<CurrentClipSpace>(win, model, proj, viewport);
+	}
+
+	namespace detail
+	{
+		/// <summary>
+		/// outPoints[i] = ( matrix * ( points[i], 1 ) ).xyz / w
+		/// 8 points are transformed at once with one reciprocal of w
+		/// points and outPoints can be same array
+		/// </summary>
+		inline void TransformAndDividePoints(const math::Matrix<4, 4, float>& matrix, const math::Vector<3, float>* points, size_t count, math::Vector<3, float>* outPoints) noexcept
+		{
+			size_t pointIndex = 0;
+
+#ifdef SIMD_ENABLED
+			M256F elements[4][4];
+			for (size_t column = 0; column < 4; ++column)
+			{
+				for (size_t row = 0; row < 4; ++row)
+				{
+					elements[column][row] = _mm256_set1_ps(matrix.columns[column][row]);
+				}
+			}
+			const M256F one = _mm256_set1_ps(1.0f);
+
+			for (; pointIndex + 8 <= count; pointIndex += 8)
+			{
+				M256F x, y, z;
+				detail::LoadPoints8(points + pointIndex, x, y, z);
+
+				M256F result[4];
+				for (size_t row = 0; row < 4; ++row)
+				{
+					result[row] = M256F_MUL_AND_ADD(elements[2][row], z, M256F_MUL_AND_ADD(elements[1][row], y, M256F_MUL_AND_ADD(elements[0][row], x, elements[3][row])));
+				}
+
+				const M256F inverseW = M256F_DIV(one, result[3]);
+				detail::StorePoints8(M256F_MUL(result[0], inverseW), M256F_MUL(result[1], inverseW), M256F_MUL(result[2], inverseW), outPoints + pointIndex);
+			}
+#endif
+
+			for (; pointIndex < count; ++pointIndex)
+			{
+				const math::Vector<3, float> point = points[pointIndex];
+				float result[4];
+				for (size_t row = 0; row < 4; ++row)
+				{
+					result[row] = matrix.columns[0][row] * point.x + matrix.columns[1][row] * point.y + matrix.columns[2][row] * point.z + matrix.columns[3][row];
+				}
+
+				const float inverseW = 1.0f / result[3];
+				outPoints[pointIndex] = math::Vector<3, float>{ result[0] * inverseW, result[1] * inverseW, result[2] * inverseW };
+			}
+		}
+	}
+
+	/// <summary>
+	/// Batched project. Depth range follows clip range of Policy
+	/// Viewport transform is folded to model-view-projection matrix, so each point takes one matrix multiplication and one reciprocal of w
+	/// </summary>
+	/// <param name="outWins">should have at least count elements. can be same with objs</param>
+	template<typename Policy = CurrentClipSpace, std::enable_if_t<CHECK_IS_CLIP_SPACE_POLICY(Policy), bool> = true>
+	inline void projectPoints(const math::Vector<3, float>* objs, size_t count, const math::Matrix<4, 4, float>& model, const math::Matrix<4, 4, float>& proj, const math::Vector<4, float>& viewport, math::Vector<3, float>* outWins) noexcept
+	{
+		constexpr bool isZeroToOne = (Policy::clipRange == ClipRange::ZeroToOne);
+		constexpr float depthScale = isZeroToOne ? 1.0f : 0.5f;
+		constexpr float depthOffset = isZeroToOne ? 0.0f : 0.5f;
+
+		// ndc -> window
+		const math::Matrix<4, 4, float> viewportMatrix{
+			math::Vector<4, float>{ viewport[2] * 0.5f, 0.0f, 0.0f, 0.0f },
+			math::Vector<4, float>{ 0.0f, viewport[3] * 0.5f, 0.0f, 0.0f },
+			math::Vector<4, float>{ 0.0f, 0.0f, depthScale, 0.0f },
+			math::Vector<4, float>{ viewport[0] + viewport[2] * 0.5f, viewport[1] + viewport[3] * 0.5f, depthOffset, 1.0f } };
+
+		detail::TransformAndDividePoints(viewportMatrix * (proj * model), objs, count, outWins);
+	}
+
+	/// <summary>
+	/// Batched unProject. Depth range follows clip range of Policy
+	/// Inverse of model-view-projection matrix is computed once and window to ndc transform is folded to it
+	/// </summary>
+	/// <param name="outObjs">should have at least count elements. can be same with wins</param>
+	template<typename Policy = CurrentClipSpace, std::enable_if_t<CHECK_IS_CLIP_SPACE_POLICY(Policy), bool> = true>
+	inline void unProjectPoints(const math::Vector<3, float>* wins, size_t count, const math::Matrix<4, 4, float>& model, const math::Matrix<4, 4, float>& proj, const math::Vector<4, float>& viewport, math::Vector<3, float>* outObjs) noexcept
+	{
+		constexpr bool isZeroToOne = (Policy::clipRange == ClipRange::ZeroToOne);
+		constexpr float depthScale = isZeroToOne ? 1.0f : 2.0f;
+		constexpr float depthOffset = isZeroToOne ? 0.0f : -1.0f;
+
+		// window -> ndc
+		const math::Matrix<4, 4, float> ndcMatrix{
+			math::Vector<4, float>{ 2.0f / viewport[2], 0.0f, 0.0f, 0.0f },
+			math::Vector<4, float>{ 0.0f, 2.0f / viewport[3], 0.0f, 0.0f },
+			math::Vector<4, float>{ 0.0f, 0.0f, depthScale, 0.0f },
+			math::Vector<4, float>{ -1.0f - 2.0f * viewport[0] / viewport[2], -1.0f - 2.0f * viewport[1] / viewport[3], depthOffset, 1.0f } };
+
+		detail::TransformAndDividePoints((proj * model).inverse() * ndcMatrix, wins, count, outObjs);
+	}
+
+	namespace detail
+	{
+#ifdef SIMD_ENABLED
+		/// <summary>
+		/// Transpose 4 x 8 lanes. Lower 128 bits of out[i] is ( a[i], b[i], c[i], d[i] ), upper 128 bits is ( a[i + 4], b[i + 4], c[i + 4], d[i + 4] )
+		/// </summary>
+		FORCE_INLINE void TransposeLanes4x8(M256F a, M256F b, M256F c, M256F d, M256F* out) noexcept
+		{
+			const M256F ab01 = _mm256_unpacklo_ps(a, b);
+			const M256F ab23 = _mm256_unpackhi_ps(a, b);
+			const M256F cd01 = _mm256_unpacklo_ps(c, d);
+			const M256F cd23 = _mm256_unpackhi_ps(c, d);
+			out[0] = _mm256_shuffle_ps(ab01, cd01, _MM_SHUFFLE(1, 0, 1, 0));
+			out[1] = _mm256_shuffle_ps(ab01, cd01, _MM_SHUFFLE(3, 2, 3, 2));
+			out[2] = _mm256_shuffle_ps(ab23, cd23, _MM_SHUFFLE(1, 0, 1, 0));
+			out[3] = _mm256_shuffle_ps(ab23, cd23, _MM_SHUFFLE(3, 2, 3, 2));
+		}
+
+		/// <summary>
+		/// x * 1 / sqrt(dot(x, x)) with rsqrt and one Newton-Raphson step
+		/// </summary>
+		FORCE_INLINE void Normalize8(M256F& x, M256F& y, M256F& z) noexcept
+		{
+			const M256F sqrLength = M256F_MUL_AND_ADD(z, z, M256F_MUL_AND_ADD(y, y, M256F_MUL(x, x)));
+			M256F inverseLength = _mm256_rsqrt_ps(sqrLength);
+			// inverseLength * ( 1.5 - 0.5 * sqrLength * inverseLength^2 )
+			inverseLength = M256F_MUL(inverseLength, M256F_SUB(_mm256_set1_ps(1.5f), M256F_MUL(M256F_MUL(_mm256_set1_ps(0.5f), sqrLength), M256F_MUL(inverseLength, inverseLength))));
+			x = M256F_MUL(x, inverseLength);
+			y = M256F_MUL(y, inverseLength);
+			z = M256F_MUL(z, inverseLength);
+		}
+
+		FORCE_INLINE void Cross8(M256F ax, M256F ay, M256F az, M256F bx, M256F by, M256F bz, M256F& outX, M256F& outY, M256F& outZ) noexcept
+		{
+			outX = M256F_SUB(M256F_MUL(ay, bz), M256F_MUL(az, by));
+			outY = M256F_SUB(M256F_MUL(az, bx), M256F_MUL(ax, bz));
+			outZ = M256F_SUB(M256F_MUL(ax, by), M256F_MUL(ay, bx));
+		}
+
+		/// <summary>
+		/// 8 lookAt matrices as rows. outRows[row][column] has element of 8 matrices
+		/// Same with lookAt<Policy>
+		/// </summary>
+		template<typename Policy>
+		inline void LookAt8(const math::Vector<3, float>* eyes, const math::Vector<3, float>* centers, const math::Vector<3, float>* ups, M256F(&outRows)[3][4]) noexcept
+		{
+			M256F eye[3], f[3], up[3], s[3], u[3];
+			LoadPoints8(eyes, eye[0], eye[1], eye[2]);
+			LoadPoints8(centers, f[0], f[1], f[2]);
+			LoadPoints8(ups, up[0], up[1], up[2]);
+
+			for (size_t component = 0; component < 3; ++component)
+			{
+				f[component] = M256F_SUB(f[component], eye[component]);
+			}
+			Normalize8(f[0], f[1], f[2]);
+
+			// left handed : s = normalize(cross(up, f)), u = cross(f, s)
+			Cross8(up[0], up[1], up[2], f[0], f[1], f[2], s[0], s[1], s[2]);
+			Normalize8(s[0], s[1], s[2]);
+			Cross8(f[0], f[1], f[2], s[0], s[1], s[2], u[0], u[1], u[2]);
+
+			if constexpr (Policy::handedness == Handedness::Right)
+			{
+				// right handed : s and f of left handed are negated, u is same
+				for (size_t component = 0; component < 3; ++component)
+				{
+					s[component] = M256F_SUB(_mm256_setzero_ps(), s[component]);
+					f[component] = M256F_SUB(_mm256_setzero_ps(), f[component]);
+				}
+			}
+
+			const M256F* const axes[3]{ s, u, f };
+			for (size_t row = 0; row < 3; ++row)
+			{
+				const M256F* axis = axes[row];
+				outRows[row][0] = axis[0];
+				outRows[row][1] = axis[1];
+				outRows[row][2] = axis[2];
+				outRows[row][3] = M256F_SUB(_mm256_setzero_ps(), M256F_MUL_AND_ADD(axis[2], eye[2], M256F_MUL_AND_ADD(axis[1], eye[1], M256F_MUL(axis[0], eye[0]))));
+			}
+		}
+#endif
+
+		/// <summary>
+		/// Write first 3 rows of matrix, row major
+		/// </summary>
+		FORCE_INLINE void StoreRows3x4(const math::Matrix<4, 4, float>& matrix, float* outRows) noexcept
+		{
+			for (size_t row = 0; row < 3; ++row)
+			{
+				for (size_t column = 0; column < 4; ++column)
+				{
+					outRows[row * 4 + column] = matrix.columns[column][row];
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// Batched lookAt. Follows handedness of Policy same with lookAt<Policy>
+	/// 8 matrices are built at once with vectorized cross products and rsqrt normalization
+	/// </summary>
+	/// <param name="outMatrices">should have at least count elements</param>
+	template<typename Policy = CurrentClipSpace, std::enable_if_t<CHECK_IS_CLIP_SPACE_POLICY(Policy), bool> = true>
+	inline void lookAtMatrices(const math::Vector<3, float>* eyes, const math::Vector<3, float>* centers, const math::Vector<3, float>* ups, size_t count, math::Matrix<4, 4, float>* outMatrices) noexcept
+	{
+		size_t matrixIndex = 0;
+
+#ifdef SIMD_ENABLED
+		const M256F zero = _mm256_setzero_ps();
+		const M256F one = _mm256_set1_ps(1.0f);
+
+		for (; matrixIndex + 8 <= count; matrixIndex += 8)
+		{
+			M256F rows[3][4];
+			detail::LookAt8<Policy>(eyes + matrixIndex, centers + matrixIndex, ups + matrixIndex, rows);
+
+			for (size_t column = 0; column < 4; ++column)
+			{
+				M256F columns[4];
+				detail::TransposeLanes4x8(rows[0][column], rows[1][column], rows[2][column], (column == 3) ? one : zero, columns);
+				for (size_t lane = 0; lane < 4; ++lane)
+				{
+					_mm_store_ps(outMatrices[matrixIndex + lane].columns[column].data(), _mm256_castps256_ps128(columns[lane]));
+					_mm_store_ps(outMatrices[matrixIndex + lane + 4].columns[column].data(), _mm256_extractf128_ps(columns[lane], 1));
+				}
+			}
+		}
+#endif
+
+		for (; matrixIndex < count; ++matrixIndex)
+		{
+			outMatrices[matrixIndex] = lookAt<Policy>(eyes[matrixIndex], centers[matrixIndex], ups[matrixIndex]);
+		}
+	}
+
+	/// <summary>
+	/// Batched lookAt writing first 3 rows of each matrix ( 12 floats, row major ). Last row is always ( 0, 0, 0, 1 )
+	/// </summary>
+	/// <param name="outRows">should have at least count * 12 elements</param>
+	template<typename Policy = CurrentClipSpace, std::enable_if_t<CHECK_IS_CLIP_SPACE_POLICY(Policy), bool> = true>
+	inline void lookAtMatrices3x4(const math::Vector<3, float>* eyes, const math::Vector<3, float>* centers, const math::Vector<3, float>* ups, size_t count, float* outRows) noexcept
+	{
+		size_t matrixIndex = 0;
+
+#ifdef SIMD_ENABLED
+		for (; matrixIndex + 8 <= count; matrixIndex += 8)
+		{
+			M256F rows[3][4];
+			detail::LookAt8<Policy>(eyes + matrixIndex, centers + matrixIndex, ups + matrixIndex, rows);
+
+			for (size_t row = 0; row < 3; ++row)
+			{
+				M256F matrixRows[4];
+				detail::TransposeLanes4x8(rows[row][0], rows[row][1], rows[row][2], rows[row][3], matrixRows);
+				for (size_t lane = 0; lane < 4; ++lane)
+				{
+					_mm_storeu_ps(outRows + (matrixIndex + lane) * 12 + row * 4, _mm256_castps256_ps128(matrixRows[lane]));
+					_mm_storeu_ps(outRows + (matrixIndex + lane + 4) * 12 + row * 4, _mm256_extractf128_ps(matrixRows[lane], 1));
+				}
+			}
+		}
+#endif
+
+		for (; matrixIndex < count; ++matrixIndex)
+		{
+			detail::StoreRows3x4(lookAt<Policy>(eyes[matrixIndex], centers[matrixIndex], ups[matrixIndex]), outRows + matrixIndex * 12);
+		}
+	}
+
+	/// <summary>
+	/// World matrices of camera facing ( screen aligned ) billboards
+	///
+	/// Every billboard has same rotation, axes of camera in world space ( rows of view matrix ),
+	/// so no normalization or cross product is needed per billboard. Local x, y of billboard are right, up of screen
+	/// </summary>
+	/// <param name="viewMatrix">world space to view space. Shouldn't have scale</param>
+	/// <param name="scales">nullable. uniform scale of each billboard</param>
+	/// <param name="outMatrices">should have at least count elements</param>
+	inline void billboardMatrices(const math::Matrix<4, 4, float>& viewMatrix, const math::Vector<3, float>* positions, const float* scales, size_t count, math::Matrix<4, 4, float>* outMatrices) noexcept
+	{
+		math::Vector<4, float> axes[3];
+		for (size_t axisIndex = 0; axisIndex < 3; ++axisIndex)
+		{
+			axes[axisIndex] = math::Vector<4, float>{ viewMatrix.columns[0][axisIndex], viewMatrix.columns[1][axisIndex], viewMatrix.columns[2][axisIndex], 0.0f };
+		}
+
+		for (size_t matrixIndex = 0; matrixIndex < count; ++matrixIndex)
+		{
+			const float scale = (scales != nullptr) ? scales[matrixIndex] : 1.0f;
+			math::Matrix<4, 4, float>& matrix = outMatrices[matrixIndex];
+			matrix.columns[0] = axes[0] * scale;
+			matrix.columns[1] = axes[1] * scale;
+			matrix.columns[2] = axes[2] * scale;
+			matrix.columns[3] = math::Vector<4, float>{ positions[matrixIndex].x, positions[matrixIndex].y, positions[matrixIndex].z, 1.0f };
+		}
+	}
+
+	/// <summary>
+	/// billboardMatrices writing first 3 rows of each matrix ( 12 floats, row major ). Last row is always ( 0, 0, 0, 1 )
+	/// </summary>
+	/// <param name="outRows">should have at least count * 12 elements</param>
+	inline void billboardMatrices3x4(const math::Matrix<4, 4, float>& viewMatrix, const math::Vector<3, float>* positions, const float* scales, size_t count, float* outRows) noexcept
+	{
+		for (size_t matrixIndex = 0; matrixIndex < count; ++matrixIndex)
+		{
+			const float scale = (scales != nullptr) ? scales[matrixIndex] : 1.0f;
+			float* rows = outRows + matrixIndex * 12;
+			for (size_t row = 0; row < 3; ++row)
+			{
+				// row of billboard matrix is column of view matrix rotation
+				rows[row * 4 + 0] = viewMatrix.columns[row][0] * scale;
+				rows[row * 4 + 1] = viewMatrix.columns[row][1] * scale;
+				rows[row * 4 + 2] = viewMatrix.columns[row][2] * scale;
+				rows[row * 4 + 3] = positions[matrixIndex][row];
+			}
+		}
 	}
 
 	template<typename T>
@@ -440,8 +884,5 @@ namespace math
 	/*
 	template<typename T>
 	constexpr math::Matrix<4, 4, T> tweakedInfinitePerspective(T fovy, T aspect, T zNear);
-
-	template<typename T, typename U>
-	constexpr math::Vector<3, T> unProject(const math::Vector<3, T>& win, const math::Matrix<4, 4, T>& model, const math::Matrix<4, 4, T>& proj, const math::Vector<4, U>& viewport);
 	*/
 }
\ No newline at end of file
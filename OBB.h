@@ -0,0 +1,392 @@
+#pragma once
+
+#include "LMath_Core.h"
+#include "Utility.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix3x3.h"
+#include "Quaternion.h"
+#include "Collision.h"
+
+#include "SIMD_Core.h"
+
+namespace math
+{
+	/// <summary>
+	/// Added to absolute rotation terms of SAT
+	/// Without this, cross product axes of nearly parallel edges are near zero vectors and give wrong result
+	/// </summary>
+	inline constexpr float OBB_SAT_EPSILON = 1e-6f;
+
+	/// <summary>
+	/// Oriented bounding box
+	/// Columns of orientation are local x, y, z axes in world space and should be orthonormal
+	/// </summary>
+	struct OBB
+	{
+		math::Vector<3, float> center;
+		math::Matrix<3, 3, float> orientation;
+		math::Vector<3, float> halfExtents;
+
+		OBB() noexcept = default;
+
+		FORCE_INLINE OBB(const math::Vector<3, float>& centerValue, const math::Matrix<3, 3, float>& orientationValue, const math::Vector<3, float>& halfExtentsValue) noexcept
+			: center{ centerValue }, orientation{ orientationValue }, halfExtents{ halfExtentsValue }
+		{
+		}
+
+		FORCE_INLINE OBB(const math::Vector<3, float>& centerValue, const math::Quaternion& rotation, const math::Vector<3, float>& halfExtentsValue) noexcept
+			: center{ centerValue }, orientation{ static_cast<math::Matrix<3, 3, float>>(rotation) }, halfExtents{ halfExtentsValue }
+		{
+		}
+
+		[[nodiscard]] FORCE_INLINE const math::Vector<3, float>& axis(size_t axisIndex) const noexcept
+		{
+			return orientation.columns[axisIndex];
+		}
+
+		/// <summary>
+		/// Smallest AABB containing this box
+		/// </summary>
+		[[nodiscard]] AABB ToAABB() const noexcept
+		{
+			const math::Vector<3, float> extents
+			{
+				math::abs(orientation.columns[0].x) * halfExtents.x + math::abs(orientation.columns[1].x) * halfExtents.y + math::abs(orientation.columns[2].x) * halfExtents.z,
+				math::abs(orientation.columns[0].y) * halfExtents.x + math::abs(orientation.columns[1].y) * halfExtents.y + math::abs(orientation.columns[2].y) * halfExtents.z,
+				math::abs(orientation.columns[0].z) * halfExtents.x + math::abs(orientation.columns[1].z) * halfExtents.y + math::abs(orientation.columns[2].z) * halfExtents.z
+			};
+			return AABB{ center - extents, center + extents };
+		}
+	};
+
+	/// <summary>
+	/// OBBs stored as structure of arrays
+	/// axisN is N th column of orientation
+	/// every array should have at least count elements
+	/// arrays don't need to be aligned
+	/// </summary>
+	struct OBBArraySoA
+	{
+		const float* centerX;
+		const float* centerY;
+		const float* centerZ;
+		const float* axis0X;
+		const float* axis0Y;
+		const float* axis0Z;
+		const float* axis1X;
+		const float* axis1Y;
+		const float* axis1Z;
+		const float* axis2X;
+		const float* axis2Y;
+		const float* axis2Z;
+		const float* halfExtentX;
+		const float* halfExtentY;
+		const float* halfExtentZ;
+		size_t count;
+	};
+
+	/// <summary>
+	/// Separating axis test with 15 axes ( 3 axes of A, 3 axes of B, 9 cross products of them )
+	/// Touching boxes are treated as overlapped
+	///
+	/// Every axis is tested in box A's local space. R is rotation from B to A, t is translation from A to B
+	/// Axes are grouped to 3 lanes of M128F, so 15 tests are 5 SIMD comparisons
+	///
+	/// reference : OBBTree: A Hierarchical Structure for Rapid Interference Detection, Gottschalk et al.
+	/// </summary>
+	[[nodiscard]] inline bool IsOBBOverlap(const OBB& obbA, const OBB& obbB) noexcept
+	{
+#ifdef SIMD_ENABLED
+		const M128F axisA[3]
+		{
+			_mm_setr_ps(obbA.orientation.columns[0].x, obbA.orientation.columns[0].y, obbA.orientation.columns[0].z, 0.0f),
+			_mm_setr_ps(obbA.orientation.columns[1].x, obbA.orientation.columns[1].y, obbA.orientation.columns[1].z, 0.0f),
+			_mm_setr_ps(obbA.orientation.columns[2].x, obbA.orientation.columns[2].y, obbA.orientation.columns[2].z, 0.0f)
+		};
+		const M128F signMask = _mm_set1_ps(-0.0f);
+		const M128F epsilon = _mm_setr_ps(OBB_SAT_EPSILON, OBB_SAT_EPSILON, OBB_SAT_EPSILON, 0.0f);
+
+		// rowR[i] = ( R[i][0], R[i][1], R[i][2], 0 ), R[i][j] = dot(A_i, B_j)
+		M128F rowR[3];
+		M128F rowAbsR[3];
+		for (size_t i = 0; i < 3; ++i)
+		{
+			rowR[i] = M128F_MUL_AND_ADD(M128F_REPLICATE(axisA[i], 2), _mm_setr_ps(obbB.orientation.columns[0].z, obbB.orientation.columns[1].z, obbB.orientation.columns[2].z, 0.0f),
+				M128F_MUL_AND_ADD(M128F_REPLICATE(axisA[i], 1), _mm_setr_ps(obbB.orientation.columns[0].y, obbB.orientation.columns[1].y, obbB.orientation.columns[2].y, 0.0f),
+					M128F_MUL(M128F_REPLICATE(axisA[i], 0), _mm_setr_ps(obbB.orientation.columns[0].x, obbB.orientation.columns[1].x, obbB.orientation.columns[2].x, 0.0f))));
+			rowAbsR[i] = M128F_ADD(_mm_andnot_ps(signMask, rowR[i]), epsilon);
+		}
+
+		// t = ( dot(d, A_0), dot(d, A_1), dot(d, A_2), 0 )
+		const math::Vector<3, float> d = obbB.center - obbA.center;
+		const float tValue[3]{ math::dot(d, obbA.axis(0)), math::dot(d, obbA.axis(1)), math::dot(d, obbA.axis(2)) };
+		const M128F t = _mm_setr_ps(tValue[0], tValue[1], tValue[2], 0.0f);
+
+		const M128F a = _mm_setr_ps(obbA.halfExtents.x, obbA.halfExtents.y, obbA.halfExtents.z, 0.0f);
+		const M128F b = _mm_setr_ps(obbB.halfExtents.x, obbB.halfExtents.y, obbB.halfExtents.z, 0.0f);
+
+		// axes of A. lane i : |t_i| > a_i + sum_j b_j * |R[i][j]|
+		// columns of |R| are made by transposing rows
+		M128F columnAbsR0 = _mm_unpacklo_ps(rowAbsR[0], rowAbsR[1]); // R00 R10 R01 R11
+		M128F columnAbsR2 = _mm_unpackhi_ps(rowAbsR[0], rowAbsR[1]); // R02 R12 0 0
+		const M128F columnAbsR1 = _mm_shuffle_ps(columnAbsR0, rowAbsR[2], SHUFFLEMASK(2, 3, 1, 3)); // R01 R11 R21 0
+		columnAbsR0 = _mm_shuffle_ps(columnAbsR0, rowAbsR[2], SHUFFLEMASK(0, 1, 0, 3)); // R00 R10 R20 0
+		columnAbsR2 = _mm_shuffle_ps(columnAbsR2, rowAbsR[2], SHUFFLEMASK(0, 1, 2, 3)); // R02 R12 R22 0
+
+		M128F radius = M128F_MUL_AND_ADD(M128F_REPLICATE(b, 0), columnAbsR0, a);
+		radius = M128F_MUL_AND_ADD(M128F_REPLICATE(b, 1), columnAbsR1, radius);
+		radius = M128F_MUL_AND_ADD(M128F_REPLICATE(b, 2), columnAbsR2, radius);
+		M128F isSeparated = _mm_cmpgt_ps(_mm_andnot_ps(signMask, t), radius);
+
+		// axes of B. lane j : |sum_i t_i * R[i][j]| > sum_i a_i * |R[i][j]| + b_j
+		M128F distance = M128F_MUL_AND_ADD(_mm_set1_ps(tValue[2]), rowR[2], M128F_MUL_AND_ADD(_mm_set1_ps(tValue[1]), rowR[1], M128F_MUL(_mm_set1_ps(tValue[0]), rowR[0])));
+		radius = M128F_MUL_AND_ADD(M128F_REPLICATE(a, 2), rowAbsR[2], M128F_MUL_AND_ADD(M128F_REPLICATE(a, 1), rowAbsR[1], M128F_MUL_AND_ADD(M128F_REPLICATE(a, 0), rowAbsR[0], b)));
+		isSeparated = _mm_or_ps(isSeparated, _mm_cmpgt_ps(_mm_andnot_ps(signMask, distance), radius));
+
+		// A_i x B_j. lane j
+		// |t[i2] * R[i1][j] - t[i1] * R[i2][j]| > a[i1] * |R[i2][j]| + a[i2] * |R[i1][j]| + b[j1] * |R[i][j2]| + b[j2] * |R[i][j1]|
+		const M128F b_YZX = M128F_SWIZZLE(b, 1, 2, 0, 3);
+		const M128F b_ZXY = M128F_SWIZZLE(b, 2, 0, 1, 3);
+		const float aValue[3]{ obbA.halfExtents.x, obbA.halfExtents.y, obbA.halfExtents.z };
+		for (size_t i = 0; i < 3; ++i)
+		{
+			const size_t i1 = (i + 1) % 3;
+			const size_t i2 = (i + 2) % 3;
+			distance = M128F_SUB(M128F_MUL(_mm_set1_ps(tValue[i2]), rowR[i1]), M128F_MUL(_mm_set1_ps(tValue[i1]), rowR[i2]));
+			radius = M128F_MUL_AND_ADD(_mm_set1_ps(aValue[i1]), rowAbsR[i2], M128F_MUL(_mm_set1_ps(aValue[i2]), rowAbsR[i1]));
+			radius = M128F_MUL_AND_ADD(b_YZX, M128F_SWIZZLE(rowAbsR[i], 2, 0, 1, 3), radius);
+			radius = M128F_MUL_AND_ADD(b_ZXY, M128F_SWIZZLE(rowAbsR[i], 1, 2, 0, 3), radius);
+			isSeparated = _mm_or_ps(isSeparated, _mm_cmpgt_ps(_mm_andnot_ps(signMask, distance), radius));
+		}
+
+		return (_mm_movemask_ps(isSeparated) & 0x7) == 0;
+#else
+		float R[3][3];
+		float absR[3][3];
+		for (size_t i = 0; i < 3; ++i)
+		{
+			for (size_t j = 0; j < 3; ++j)
+			{
+				R[i][j] = math::dot(obbA.axis(i), obbB.axis(j));
+				absR[i][j] = math::abs(R[i][j]) + OBB_SAT_EPSILON;
+			}
+		}
+
+		const math::Vector<3, float> d = obbB.center - obbA.center;
+		const float t[3]{ math::dot(d, obbA.axis(0)), math::dot(d, obbA.axis(1)), math::dot(d, obbA.axis(2)) };
+		const float a[3]{ obbA.halfExtents.x, obbA.halfExtents.y, obbA.halfExtents.z };
+		const float b[3]{ obbB.halfExtents.x, obbB.halfExtents.y, obbB.halfExtents.z };
+
+		for (size_t i = 0; i < 3; ++i)
+		{
+			if (math::abs(t[i]) > a[i] + b[0] * absR[i][0] + b[1] * absR[i][1] + b[2] * absR[i][2])
+			{
+				return false;
+			}
+		}
+
+		for (size_t j = 0; j < 3; ++j)
+		{
+			if (math::abs(t[0] * R[0][j] + t[1] * R[1][j] + t[2] * R[2][j]) > a[0] * absR[0][j] + a[1] * absR[1][j] + a[2] * absR[2][j] + b[j])
+			{
+				return false;
+			}
+		}
+
+		for (size_t i = 0; i < 3; ++i)
+		{
+			const size_t i1 = (i + 1) % 3;
+			const size_t i2 = (i + 2) % 3;
+			for (size_t j = 0; j < 3; ++j)
+			{
+				const size_t j1 = (j + 1) % 3;
+				const size_t j2 = (j + 2) % 3;
+				if (math::abs(t[i2] * R[i1][j] - t[i1] * R[i2][j]) > a[i1] * absR[i2][j] + a[i2] * absR[i1][j] + b[j1] * absR[i][j2] + b[j2] * absR[i][j1])
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+#endif
+	}
+
+	/// <summary>
+	/// Test one OBB with many OBBs
+	/// 8 boxes of obbs are tested at once. Each lane runs same 15 axes test with IsOBBOverlap
+	/// </summary>
+	/// <param name="outOBBIndices">caller provided buffer</param>
+	/// <returns>count of overlapped boxes. When it's larger than maxOBBCount, only maxOBBCount indices are written</returns>
+	inline size_t FindOBBOverlaps(const OBB& obb, const OBBArraySoA& obbs, unsigned int* outOBBIndices, size_t maxOBBCount)
+	{
+		size_t overlapCount = 0;
+		size_t obbIndex = 0;
+
+#ifdef SIMD_ENABLED
+		const M256F signMask = _mm256_set1_ps(-0.0f);
+		const M256F epsilon = _mm256_set1_ps(OBB_SAT_EPSILON);
+		const M256F a[3]{ _mm256_set1_ps(obb.halfExtents.x), _mm256_set1_ps(obb.halfExtents.y), _mm256_set1_ps(obb.halfExtents.z) };
+
+		for (; obbIndex + 8 <= obbs.count; obbIndex += 8)
+		{
+			const M256F axisB[3][3]
+			{
+				{ _mm256_loadu_ps(obbs.axis0X + obbIndex), _mm256_loadu_ps(obbs.axis0Y + obbIndex), _mm256_loadu_ps(obbs.axis0Z + obbIndex) },
+				{ _mm256_loadu_ps(obbs.axis1X + obbIndex), _mm256_loadu_ps(obbs.axis1Y + obbIndex), _mm256_loadu_ps(obbs.axis1Z + obbIndex) },
+				{ _mm256_loadu_ps(obbs.axis2X + obbIndex), _mm256_loadu_ps(obbs.axis2Y + obbIndex), _mm256_loadu_ps(obbs.axis2Z + obbIndex) }
+			};
+			const M256F b[3]{ _mm256_loadu_ps(obbs.halfExtentX + obbIndex), _mm256_loadu_ps(obbs.halfExtentY + obbIndex), _mm256_loadu_ps(obbs.halfExtentZ + obbIndex) };
+
+			const M256F dx = M256F_SUB(_mm256_loadu_ps(obbs.centerX + obbIndex), _mm256_set1_ps(obb.center.x));
+			const M256F dy = M256F_SUB(_mm256_loadu_ps(obbs.centerY + obbIndex), _mm256_set1_ps(obb.center.y));
+			const M256F dz = M256F_SUB(_mm256_loadu_ps(obbs.centerZ + obbIndex), _mm256_set1_ps(obb.center.z));
+
+			M256F R[3][3];
+			M256F absR[3][3];
+			M256F t[3];
+			for (size_t i = 0; i < 3; ++i)
+			{
+				const math::Vector<3, float>& axisA = obb.axis(i);
+				const M256F axisAX = _mm256_set1_ps(axisA.x);
+				const M256F axisAY = _mm256_set1_ps(axisA.y);
+				const M256F axisAZ = _mm256_set1_ps(axisA.z);
+				for (size_t j = 0; j < 3; ++j)
+				{
+					R[i][j] = M256F_MUL_AND_ADD(axisAZ, axisB[j][2], M256F_MUL_AND_ADD(axisAY, axisB[j][1], M256F_MUL(axisAX, axisB[j][0])));
+					absR[i][j] = M256F_ADD(_mm256_andnot_ps(signMask, R[i][j]), epsilon);
+				}
+				t[i] = M256F_MUL_AND_ADD(axisAZ, dz, M256F_MUL_AND_ADD(axisAY, dy, M256F_MUL(axisAX, dx)));
+			}
+
+			M256F isSeparated = _mm256_setzero_ps();
+			for (size_t i = 0; i < 3; ++i)
+			{
+				const M256F radius = M256F_MUL_AND_ADD(b[2], absR[i][2], M256F_MUL_AND_ADD(b[1], absR[i][1], M256F_MUL_AND_ADD(b[0], absR[i][0], a[i])));
+				isSeparated = _mm256_or_ps(isSeparated, _mm256_cmp_ps(_mm256_andnot_ps(signMask, t[i]), radius, _CMP_GT_OQ));
+			}
+
+			for (size_t j = 0; j < 3; ++j)
+			{
+				const M256F distance = M256F_MUL_AND_ADD(t[2], R[2][j], M256F_MUL_AND_ADD(t[1], R[1][j], M256F_MUL(t[0], R[0][j])));
+				const M256F radius = M256F_MUL_AND_ADD(a[2], absR[2][j], M256F_MUL_AND_ADD(a[1], absR[1][j], M256F_MUL_AND_ADD(a[0], absR[0][j], b[j])));
+				isSeparated = _mm256_or_ps(isSeparated, _mm256_cmp_ps(_mm256_andnot_ps(signMask, distance), radius, _CMP_GT_OQ));
+			}
+
+			for (size_t i = 0; i < 3; ++i)
+			{
+				const size_t i1 = (i + 1) % 3;
+				const size_t i2 = (i + 2) % 3;
+				for (size_t j = 0; j < 3; ++j)
+				{
+					const size_t j1 = (j + 1) % 3;
+					const size_t j2 = (j + 2) % 3;
+					const M256F distance = M256F_SUB(M256F_MUL(t[i2], R[i1][j]), M256F_MUL(t[i1], R[i2][j]));
+					M256F radius = M256F_MUL_AND_ADD(a[i1], absR[i2][j], M256F_MUL(a[i2], absR[i1][j]));
+					radius = M256F_MUL_AND_ADD(b[j1], absR[i][j2], M256F_MUL_AND_ADD(b[j2], absR[i][j1], radius));
+					isSeparated = _mm256_or_ps(isSeparated, _mm256_cmp_ps(_mm256_andnot_ps(signMask, distance), radius, _CMP_GT_OQ));
+				}
+			}
+
+			unsigned int overlapMask = static_cast<unsigned int>(~_mm256_movemask_ps(isSeparated)) & 0xFF;
+			while (overlapMask != 0)
+			{
+				const unsigned int lane = math::countTrailingZero(overlapMask);
+				overlapMask &= overlapMask - 1;
+				if (overlapCount < maxOBBCount)
+				{
+					outOBBIndices[overlapCount] = static_cast<unsigned int>(obbIndex + lane);
+				}
+				++overlapCount;
+			}
+		}
+#endif
+
+		for (; obbIndex < obbs.count; ++obbIndex)
+		{
+			const OBB otherOBB
+			{
+				math::Vector<3, float>{ obbs.centerX[obbIndex], obbs.centerY[obbIndex], obbs.centerZ[obbIndex] },
+				math::Matrix<3, 3, float>
+				{
+					math::Vector<3, float>{ obbs.axis0X[obbIndex], obbs.axis0Y[obbIndex], obbs.axis0Z[obbIndex] },
+					math::Vector<3, float>{ obbs.axis1X[obbIndex], obbs.axis1Y[obbIndex], obbs.axis1Z[obbIndex] },
+					math::Vector<3, float>{ obbs.axis2X[obbIndex], obbs.axis2Y[obbIndex], obbs.axis2Z[obbIndex] }
+				},
+				math::Vector<3, float>{ obbs.halfExtentX[obbIndex], obbs.halfExtentY[obbIndex], obbs.halfExtentZ[obbIndex] }
+			};
+
+			if (IsOBBOverlap(obb, otherOBB) == true)
+			{
+				if (overlapCount < maxOBBCount)
+				{
+					outOBBIndices[overlapCount] = static_cast<unsigned int>(obbIndex);
+				}
+				++overlapCount;
+			}
+		}
+
+		return overlapCount;
+	}
+
+	/// <summary>
+	/// Box is culled only when it's completely outside of a plane
+	/// Projected radius of box to plane normal is sum of |dot(normal, axis_i)| * halfExtent_i
+	///
+	/// Plane 0 ~ 3 are tested in one M128F and plane 4, 5 in another
+	/// </summary>
+	/// <param name="eightPlanes">planes from ExtractSIMDPlanesFromViewProjectionMatrix</param>
+	/// <returns>true if box is inside of or intersecting frustum</returns>
+	[[nodiscard]] inline bool IsOBBInFrustum(const math::Vector<4, float>* eightPlanes, const OBB& obb) noexcept
+	{
+#ifdef SIMD_ENABLED
+		const M128F* m128f_eightPlanes = reinterpret_cast<const M128F*>(eightPlanes);
+		const M128F signMask = _mm_set1_ps(-0.0f);
+
+		M128F isInside = M128F_EVERY_BITS_ONE;
+		for (size_t planeGroup = 0; planeGroup < 2; ++planeGroup)
+		{
+			const M128F planeX = m128f_eightPlanes[planeGroup * 4 + 0];
+			const M128F planeY = m128f_eightPlanes[planeGroup * 4 + 1];
+			const M128F planeZ = m128f_eightPlanes[planeGroup * 4 + 2];
+			const M128F planeW = m128f_eightPlanes[planeGroup * 4 + 3];
+
+			M128F distance = M128F_MUL_AND_ADD(_mm_set1_ps(obb.center.z), planeZ, planeW);
+			distance = M128F_MUL_AND_ADD(_mm_set1_ps(obb.center.y), planeY, distance);
+			distance = M128F_MUL_AND_ADD(_mm_set1_ps(obb.center.x), planeX, distance);
+
+			const float halfExtents[3]{ obb.halfExtents.x, obb.halfExtents.y, obb.halfExtents.z };
+			for (size_t axisIndex = 0; axisIndex < 3; ++axisIndex)
+			{
+				const math::Vector<3, float>& axis = obb.axis(axisIndex);
+				M128F projection = M128F_MUL_AND_ADD(_mm_set1_ps(axis.z), planeZ, M128F_MUL_AND_ADD(_mm_set1_ps(axis.y), planeY, M128F_MUL(_mm_set1_ps(axis.x), planeX)));
+				distance = M128F_MUL_AND_ADD(_mm_andnot_ps(signMask, projection), _mm_set1_ps(halfExtents[axisIndex]), distance);
+			}
+
+			isInside = _mm_and_ps(isInside, _mm_cmpge_ps(distance, M128F_Zero));
+		}
+
+		return _mm_movemask_ps(isInside) == 0xF;
+#else
+		for (size_t planeIndex = 0; planeIndex < 6; ++planeIndex)
+		{
+			// plane 4, 5 are stored at lane 0, 1 of eightPlanes[4] ~ eightPlanes[7]
+			const size_t planeGroup = (planeIndex < 4) ? 0 : 4;
+			const size_t lane = (planeIndex < 4) ? planeIndex : planeIndex - 4;
+			const math::Vector<3, float> normal{ eightPlanes[planeGroup + 0][lane], eightPlanes[planeGroup + 1][lane], eightPlanes[planeGroup + 2][lane] };
+
+			const float distance =
+				math::dot(normal, obb.center) + eightPlanes[planeGroup + 3][lane] +
+				math::abs(math::dot(normal, obb.axis(0))) * obb.halfExtents.x +
+				math::abs(math::dot(normal, obb.axis(1))) * obb.halfExtents.y +
+				math::abs(math::dot(normal, obb.axis(2))) * obb.halfExtents.z;
+			if (distance < 0.0f)
+			{
+				return false;
+			}
+		}
+		return true;
+#endif
+	}
+}
@@ -0,0 +1,713 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "LMath_Core.h"
+#include "Utility.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix4x4.h"
+#include "Collision.h"
+#include "Parallel.h"
+
+#include "SIMD_Core.h"
+
+namespace math
+{
+	/// <summary>
+	/// Occlusion buffer is split to square tiles of this size. Tiles are rasterized in parallel
+	/// </summary>
+	inline constexpr size_t OCCLUSION_TILE_SIZE = 32;
+
+	/// <summary>
+	/// Level 0 is depth buffer. Texel of last level covers one tile
+	/// </summary>
+	inline constexpr size_t OCCLUSION_HIERARCHY_LEVEL_COUNT = 6;
+
+	/// <summary>
+	/// Vertices with clip w smaller than this are treated as crossing near plane
+	/// </summary>
+	inline constexpr float OCCLUSION_NEAR_CLIP_W = 1e-5f;
+
+	/// <summary>
+	/// Occluder triangles are clipped to |x| <= w * OCCLUSION_GUARD_BAND_SCALE and |y| <= w * OCCLUSION_GUARD_BAND_SCALE,
+	/// so screen coordinates stay in float precision range of edge equations. Clipped part is out of screen
+	/// </summary>
+	inline constexpr float OCCLUSION_GUARD_BAND_SCALE = 4.0f;
+
+	/// <summary>
+	/// Triangle clipped by near plane and 4 guard band planes has at most 3 + 5 vertices
+	/// </summary>
+	inline constexpr size_t OCCLUSION_MAX_CLIPPED_VERTEX_COUNT = 8;
+
+	namespace detail
+	{
+		/// <summary>
+		/// Screen space triangle ready for rasterization
+		/// edge i is edgeA[i] * x + edgeB[i] * y + edgeC[i]. pixel is inside when every edge is not negative
+		/// depth is depthA * x + depthB * y + depthC
+		/// </summary>
+		struct OcclusionTriangle
+		{
+			float edgeA[3];
+			float edgeB[3];
+			float edgeC[3];
+			float depthA;
+			float depthB;
+			float depthC;
+			int minX;
+			int minY;
+			int maxX;
+			int maxY;
+		};
+	}
+
+	/// <summary>
+	/// Software occlusion culling
+	///
+	/// Occluder meshes are transformed to clip space, set up and binned to screen tiles by AddOccluder.
+	/// Rasterize draws every tile in parallel with 8 wide edge functions and builds min / max depth pyramid.
+	/// Occludee boxes are projected 8 at a time and tested with pyramid hierarchically.
+	///
+	/// Depth is 1 / clip w, so larger is closer and cleared buffer ( 0 ) is infinitely far.
+	/// Triangles crossing near plane are skipped and both faces are drawn, which keeps culling conservative
+	///
+	/// references :
+	/// Masked Software Occlusion Culling, J. Hasselgren, M. Andersson, T. Akenine-Moller
+	/// Software Occlusion Culling, Intel
+	/// </summary>
+	class OcclusionBuffer
+	{
+	public:
+
+		/// <param name="width">rounded up to multiple of OCCLUSION_TILE_SIZE</param>
+		/// <param name="height">rounded up to multiple of OCCLUSION_TILE_SIZE</param>
+		OcclusionBuffer(size_t width, size_t height, unsigned int threadCount = 1)
+			: mWidth{ (width + OCCLUSION_TILE_SIZE - 1) / OCCLUSION_TILE_SIZE * OCCLUSION_TILE_SIZE },
+			mHeight{ (height + OCCLUSION_TILE_SIZE - 1) / OCCLUSION_TILE_SIZE * OCCLUSION_TILE_SIZE },
+			mThreadCount{ math::Max(threadCount, 1u) }
+		{
+			assert(width > 0 && height > 0);
+
+			mTileCountX = mWidth / OCCLUSION_TILE_SIZE;
+			mTileCountY = mHeight / OCCLUSION_TILE_SIZE;
+			mTileBins.resize(mTileCountX * mTileCountY);
+
+			for (size_t level = 0; level < OCCLUSION_HIERARCHY_LEVEL_COUNT; ++level)
+			{
+				mMinDepths[level].resize((mWidth >> level) * (mHeight >> level), 0.0f);
+				if (level > 0)
+				{
+					mMaxDepths[level].resize((mWidth >> level) * (mHeight >> level), 0.0f);
+				}
+			}
+		}
+
+		[[nodiscard]] FORCE_INLINE size_t GetWidth() const noexcept
+		{
+			return mWidth;
+		}
+
+		[[nodiscard]] FORCE_INLINE size_t GetHeight() const noexcept
+		{
+			return mHeight;
+		}
+
+		/// <summary>
+		/// Depth buffer ( level 0 ). row major, row 0 is bottom of screen
+		/// </summary>
+		[[nodiscard]] FORCE_INLINE const std::vector<float>& GetDepthBuffer() const noexcept
+		{
+			return mMinDepths[0];
+		}
+
+		/// <summary>
+		/// Remove every occluder and clear depth
+		/// </summary>
+		void Clear()
+		{
+			mTriangles.clear();
+			for (std::vector<unsigned int>& tileBin : mTileBins)
+			{
+				tileBin.clear();
+			}
+			for (size_t level = 0; level < OCCLUSION_HIERARCHY_LEVEL_COUNT; ++level)
+			{
+				std::fill(mMinDepths[level].begin(), mMinDepths[level].end(), 0.0f);
+				std::fill(mMaxDepths[level].begin(), mMaxDepths[level].end(), 0.0f);
+			}
+		}
+
+		/// <summary>
+		/// Transform occluder mesh to clip space and bin its triangles to tiles
+		/// </summary>
+		/// <param name="indices">3 indices per triangle. When nullptr, vertices are triangle list</param>
+		void AddOccluder(const math::Vector<3, float>* vertices, size_t vertexCount, const unsigned int* indices, size_t triangleCount, const math::Matrix<4, 4, float>& modelViewProjectionMatrix)
+		{
+			mClipVertices.resize(vertexCount);
+			for (size_t vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex)
+			{
+				const math::Vector<3, float>& vertex = vertices[vertexIndex];
+				mClipVertices[vertexIndex] = modelViewProjectionMatrix * math::Vector<4, float>{ vertex.x, vertex.y, vertex.z, 1.0f };
+			}
+
+			for (size_t triangleIndex = 0; triangleIndex < triangleCount; ++triangleIndex)
+			{
+				const size_t vertexIndex0 = (indices != nullptr) ? indices[triangleIndex * 3 + 0] : triangleIndex * 3 + 0;
+				const size_t vertexIndex1 = (indices != nullptr) ? indices[triangleIndex * 3 + 1] : triangleIndex * 3 + 1;
+				const size_t vertexIndex2 = (indices != nullptr) ? indices[triangleIndex * 3 + 2] : triangleIndex * 3 + 2;
+				SetupTriangle(mClipVertices[vertexIndex0], mClipVertices[vertexIndex1], mClipVertices[vertexIndex2]);
+			}
+		}
+
+		/// <summary>
+		/// Draw binned occluders and build depth pyramid
+		/// Each tile is drawn by one thread
+		/// </summary>
+		void Rasterize()
+		{
+			math::ParallelFor(mTileBins.size(), mThreadCount, [this](size_t begin, size_t end, unsigned int)
+			{
+				for (size_t tileIndex = begin; tileIndex < end; ++tileIndex)
+				{
+					RasterizeTile(tileIndex);
+				}
+			});
+
+			BuildHierarchy();
+		}
+
+		/// <summary>
+		/// Test box with depth pyramid
+		/// Box crossing near plane is visible. Box outside of screen is not visible
+		/// </summary>
+		/// <returns>true if any part of box may be visible</returns>
+		[[nodiscard]] bool TestAABB(const AABB& aabb, const math::Matrix<4, 4, float>& viewProjectionMatrix) const noexcept
+		{
+			float minNdcX = math::infinity<float>();
+			float minNdcY = math::infinity<float>();
+			float maxNdcX = math::negativeInfinity<float>();
+			float maxNdcY = math::negativeInfinity<float>();
+			float nearestDepth = 0.0f;
+
+			for (unsigned int cornerIndex = 0; cornerIndex < 8; ++cornerIndex)
+			{
+				const math::Vector<4, float> clipPosition = viewProjectionMatrix * math::Vector<4, float>
+				{
+					(cornerIndex & 1) ? aabb.maximum.x : aabb.minimum.x,
+					(cornerIndex & 2) ? aabb.maximum.y : aabb.minimum.y,
+					(cornerIndex & 4) ? aabb.maximum.z : aabb.minimum.z,
+					1.0f
+				};
+				if (clipPosition.w <= OCCLUSION_NEAR_CLIP_W)
+				{
+					return true;
+				}
+
+				const float inverseW = 1.0f / clipPosition.w;
+				minNdcX = math::Min(minNdcX, clipPosition.x * inverseW);
+				minNdcY = math::Min(minNdcY, clipPosition.y * inverseW);
+				maxNdcX = math::Max(maxNdcX, clipPosition.x * inverseW);
+				maxNdcY = math::Max(maxNdcY, clipPosition.y * inverseW);
+				nearestDepth = math::Max(nearestDepth, inverseW);
+			}
+
+			return IsNdcRectVisible(minNdcX, minNdcY, maxNdcX, maxNdcY, nearestDepth);
+		}
+
+		/// <summary>
+		/// Test every box with depth pyramid
+		/// Corners of 8 boxes are projected at once. Boxes are split to threads
+		/// </summary>
+		/// <param name="outVisibleFlags">1 when box may be visible, 0 when occluded or outside of screen. at least boxes.count elements</param>
+		/// <returns>visible box count</returns>
+		size_t TestAABBs(const AABBArraySoA& boxes, const math::Matrix<4, 4, float>& viewProjectionMatrix, unsigned char* outVisibleFlags) const
+		{
+			std::vector<size_t> rangeVisibleCounts(mThreadCount, 0);
+			math::ParallelFor(boxes.count, mThreadCount, [&](size_t begin, size_t end, unsigned int rangeIndex)
+			{
+				rangeVisibleCounts[rangeIndex] = TestAABBRange(boxes, begin, end, viewProjectionMatrix, outVisibleFlags);
+			});
+
+			size_t visibleCount = 0;
+			for (const size_t rangeVisibleCount : rangeVisibleCounts)
+			{
+				visibleCount += rangeVisibleCount;
+			}
+			return visibleCount;
+		}
+
+	private:
+
+		/// <summary>
+		/// Signed distance of clip space position to clip plane. 0 : near ( w = OCCLUSION_NEAR_CLIP_W ), 1 ~ 4 : guard band
+		/// </summary>
+		[[nodiscard]] static FORCE_INLINE float GetClipPlaneDistance(const math::Vector<4, float>& clipPosition, size_t planeIndex) noexcept
+		{
+			switch (planeIndex)
+			{
+			case 0:
+				return clipPosition.w - OCCLUSION_NEAR_CLIP_W;
+			case 1:
+				return clipPosition.w * OCCLUSION_GUARD_BAND_SCALE + clipPosition.x;
+			case 2:
+				return clipPosition.w * OCCLUSION_GUARD_BAND_SCALE - clipPosition.x;
+			case 3:
+				return clipPosition.w * OCCLUSION_GUARD_BAND_SCALE + clipPosition.y;
+			default:
+				return clipPosition.w * OCCLUSION_GUARD_BAND_SCALE - clipPosition.y;
+			}
+		}
+
+		/// <summary>
+		/// Clip triangle with near plane and guard band in clip space and set up clipped polygon as triangle fan
+		/// Triangle crossing near plane is clipped, not dropped, so large occluders around camera still occlude
+		/// </summary>
+		void SetupTriangle(const math::Vector<4, float>& clip0, const math::Vector<4, float>& clip1, const math::Vector<4, float>& clip2)
+		{
+			bool isInside = true;
+			for (size_t planeIndex = 0; planeIndex < 5; ++planeIndex)
+			{
+				isInside &= GetClipPlaneDistance(clip0, planeIndex) >= 0.0f && GetClipPlaneDistance(clip1, planeIndex) >= 0.0f && GetClipPlaneDistance(clip2, planeIndex) >= 0.0f;
+			}
+			if (isInside == true)
+			{
+				SetupClippedTriangle(clip0, clip1, clip2);
+				return;
+			}
+
+			math::Vector<4, float> polygons[2][OCCLUSION_MAX_CLIPPED_VERTEX_COUNT]{ { clip0, clip1, clip2 } };
+			size_t vertexCount = 3;
+			size_t current = 0;
+
+			for (size_t planeIndex = 0; planeIndex < 5; ++planeIndex)
+			{
+				const math::Vector<4, float>* polygon = polygons[current];
+				math::Vector<4, float>* outPolygon = polygons[current ^ 1];
+				size_t outVertexCount = 0;
+
+				const math::Vector<4, float>* previous = &polygon[vertexCount - 1];
+				float previousDistance = GetClipPlaneDistance(*previous, planeIndex);
+				bool isAllInside = true;
+				for (size_t vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex)
+				{
+					const math::Vector<4, float>* vertex = &polygon[vertexIndex];
+					const float distance = GetClipPlaneDistance(*vertex, planeIndex);
+					isAllInside &= (distance >= 0.0f);
+
+					if ((distance >= 0.0f) != (previousDistance >= 0.0f))
+					{
+						// interpolate from inside vertex to outside vertex, so shared edges are clipped to same point
+						const bool isVertexInside = distance >= 0.0f;
+						const math::Vector<4, float>& inside = isVertexInside ? *vertex : *previous;
+						const math::Vector<4, float>& outside = isVertexInside ? *previous : *vertex;
+						const float insideDistance = isVertexInside ? distance : previousDistance;
+						const float outsideDistance = isVertexInside ? previousDistance : distance;
+						outPolygon[outVertexCount++] = inside + (outside - inside) * (insideDistance / (insideDistance - outsideDistance));
+					}
+					if (distance >= 0.0f)
+					{
+						outPolygon[outVertexCount++] = *vertex;
+					}
+
+					previous = vertex;
+					previousDistance = distance;
+				}
+
+				if (isAllInside == true)
+				{
+					continue;
+				}
+				if (outVertexCount < 3)
+				{
+					return;
+				}
+				vertexCount = outVertexCount;
+				current ^= 1;
+			}
+
+			for (size_t vertexIndex = 2; vertexIndex < vertexCount; ++vertexIndex)
+			{
+				SetupClippedTriangle(polygons[current][0], polygons[current][vertexIndex - 1], polygons[current][vertexIndex]);
+			}
+		}
+
+		/// <summary>
+		/// Make screen space edge and depth equations and add triangle to bins of overlapped tiles
+		/// Every vertex should be inside of near plane and guard band
+		/// </summary>
+		void SetupClippedTriangle(const math::Vector<4, float>& clip0, const math::Vector<4, float>& clip1, const math::Vector<4, float>& clip2)
+		{
+			const math::Vector<4, float>* clipPositions[3]{ &clip0, &clip1, &clip2 };
+			float screenX[3];
+			float screenY[3];
+			float depth[3];
+			for (size_t vertexIndex = 0; vertexIndex < 3; ++vertexIndex)
+			{
+				const math::Vector<4, float>& clipPosition = *clipPositions[vertexIndex];
+				depth[vertexIndex] = 1.0f / clipPosition.w;
+				screenX[vertexIndex] = (clipPosition.x * depth[vertexIndex] * 0.5f + 0.5f) * static_cast<float>(mWidth);
+				screenY[vertexIndex] = (clipPosition.y * depth[vertexIndex] * 0.5f + 0.5f) * static_cast<float>(mHeight);
+			}
+
+			const float area = (screenX[1] - screenX[0]) * (screenY[2] - screenY[0]) - (screenX[2] - screenX[0]) * (screenY[1] - screenY[0]);
+			if (area == 0.0f)
+			{
+				return;
+			}
+
+			// reject and clamp in float before converting to int. out of range float to int conversion is undefined
+			const float lastX = static_cast<float>(mWidth - 1);
+			const float lastY = static_cast<float>(mHeight - 1);
+			const float minScreenX = std::floor(math::Min(screenX[0], math::Min(screenX[1], screenX[2])));
+			const float minScreenY = std::floor(math::Min(screenY[0], math::Min(screenY[1], screenY[2])));
+			const float maxScreenX = std::ceil(math::Max(screenX[0], math::Max(screenX[1], screenX[2])));
+			const float maxScreenY = std::ceil(math::Max(screenY[0], math::Max(screenY[1], screenY[2])));
+			if ((minScreenX <= lastX && maxScreenX >= 0.0f && minScreenY <= lastY && maxScreenY >= 0.0f) == false)
+			{
+				return;
+			}
+
+			const int minX = static_cast<int>(math::Max(minScreenX, 0.0f));
+			const int minY = static_cast<int>(math::Max(minScreenY, 0.0f));
+			const int maxX = static_cast<int>(math::Min(maxScreenX, lastX));
+			const int maxY = static_cast<int>(math::Min(maxScreenY, lastY));
+
+			// both faces are drawn. flip edges of clockwise triangle
+			const float orientation = (area > 0.0f) ? 1.0f : -1.0f;
+			const float inverseArea = 1.0f / math::abs(area);
+
+			detail::OcclusionTriangle triangle;
+			triangle.depthA = 0.0f;
+			triangle.depthB = 0.0f;
+			triangle.depthC = 0.0f;
+			for (size_t edgeIndex = 0; edgeIndex < 3; ++edgeIndex)
+			{
+				// edge i is opposite to vertex i
+				const size_t begin = (edgeIndex + 1) % 3;
+				const size_t end = (edgeIndex + 2) % 3;
+				const float edgeX = screenX[end] - screenX[begin];
+				const float edgeY = screenY[end] - screenY[begin];
+				triangle.edgeA[edgeIndex] = -edgeY * orientation;
+				triangle.edgeB[edgeIndex] = edgeX * orientation;
+				triangle.edgeC[edgeIndex] = (edgeY * screenX[begin] - edgeX * screenY[begin]) * orientation;
+
+				// depth is interpolated with barycentric coordinates
+				triangle.depthA += triangle.edgeA[edgeIndex] * inverseArea * depth[edgeIndex];
+				triangle.depthB += triangle.edgeB[edgeIndex] * inverseArea * depth[edgeIndex];
+				triangle.depthC += triangle.edgeC[edgeIndex] * inverseArea * depth[edgeIndex];
+			}
+			triangle.minX = minX;
+			triangle.minY = minY;
+			triangle.maxX = maxX;
+			triangle.maxY = maxY;
+
+			const unsigned int triangleIndex = static_cast<unsigned int>(mTriangles.size());
+			mTriangles.push_back(triangle);
+
+			for (size_t tileY = static_cast<size_t>(minY) / OCCLUSION_TILE_SIZE; tileY <= static_cast<size_t>(maxY) / OCCLUSION_TILE_SIZE; ++tileY)
+			{
+				for (size_t tileX = static_cast<size_t>(minX) / OCCLUSION_TILE_SIZE; tileX <= static_cast<size_t>(maxX) / OCCLUSION_TILE_SIZE; ++tileX)
+				{
+					mTileBins[tileY * mTileCountX + tileX].push_back(triangleIndex);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Draw triangles of a tile. Only depth buffer pixels of the tile are written
+		/// </summary>
+		void RasterizeTile(size_t tileIndex) noexcept
+		{
+			const int tileMinX = static_cast<int>((tileIndex % mTileCountX) * OCCLUSION_TILE_SIZE);
+			const int tileMinY = static_cast<int>((tileIndex / mTileCountX) * OCCLUSION_TILE_SIZE);
+			const int tileMaxX = tileMinX + static_cast<int>(OCCLUSION_TILE_SIZE) - 1;
+			const int tileMaxY = tileMinY + static_cast<int>(OCCLUSION_TILE_SIZE) - 1;
+			float* depthBuffer = mMinDepths[0].data();
+
+			for (const unsigned int triangleIndex : mTileBins[tileIndex])
+			{
+				const detail::OcclusionTriangle& triangle = mTriangles[triangleIndex];
+
+				// 8 pixel spans are aligned to 8, so they never cross tile
+				const int minX = math::Max(triangle.minX, tileMinX) & ~7;
+				const int maxX = math::Min(triangle.maxX, tileMaxX);
+				const int minY = math::Max(triangle.minY, tileMinY);
+				const int maxY = math::Min(triangle.maxY, tileMaxY);
+
+				for (int y = minY; y <= maxY; ++y)
+				{
+					const float pixelY = static_cast<float>(y) + 0.5f;
+					const float rowEdge0 = triangle.edgeB[0] * pixelY + triangle.edgeC[0];
+					const float rowEdge1 = triangle.edgeB[1] * pixelY + triangle.edgeC[1];
+					const float rowEdge2 = triangle.edgeB[2] * pixelY + triangle.edgeC[2];
+					const float rowDepth = triangle.depthB * pixelY + triangle.depthC;
+					float* depthRow = depthBuffer + static_cast<size_t>(y) * mWidth;
+
+#ifdef SIMD_ENABLED
+					const M256F laneOffset = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+					const M256F zero = _mm256_setzero_ps();
+
+					for (int x = minX; x <= maxX; x += 8)
+					{
+						const M256F pixelX = M256F_ADD(_mm256_set1_ps(static_cast<float>(x)), laneOffset);
+						const M256F edge0 = M256F_MUL_AND_ADD(_mm256_set1_ps(triangle.edgeA[0]), pixelX, _mm256_set1_ps(rowEdge0));
+						const M256F edge1 = M256F_MUL_AND_ADD(_mm256_set1_ps(triangle.edgeA[1]), pixelX, _mm256_set1_ps(rowEdge1));
+						const M256F edge2 = M256F_MUL_AND_ADD(_mm256_set1_ps(triangle.edgeA[2]), pixelX, _mm256_set1_ps(rowEdge2));
+						const M256F isInside = _mm256_and_ps
+						(
+							_mm256_cmp_ps(edge0, zero, _CMP_GE_OQ),
+							_mm256_and_ps(_mm256_cmp_ps(edge1, zero, _CMP_GE_OQ), _mm256_cmp_ps(edge2, zero, _CMP_GE_OQ))
+						);
+						if (_mm256_movemask_ps(isInside) == 0)
+						{
+							continue;
+						}
+
+						const M256F depth = M256F_MUL_AND_ADD(_mm256_set1_ps(triangle.depthA), pixelX, _mm256_set1_ps(rowDepth));
+						const M256F oldDepth = _mm256_loadu_ps(depthRow + x);
+						_mm256_storeu_ps(depthRow + x, _mm256_blendv_ps(oldDepth, _mm256_max_ps(oldDepth, depth), isInside));
+					}
+#else
+					for (int x = minX; x <= maxX; ++x)
+					{
+						const float pixelX = static_cast<float>(x) + 0.5f;
+						if (triangle.edgeA[0] * pixelX + rowEdge0 >= 0.0f && triangle.edgeA[1] * pixelX + rowEdge1 >= 0.0f && triangle.edgeA[2] * pixelX + rowEdge2 >= 0.0f)
+						{
+							depthRow[x] = math::Max(depthRow[x], triangle.depthA * pixelX + rowDepth);
+						}
+					}
+#endif
+				}
+			}
+		}
+
+		/// <summary>
+		/// Each texel of level keeps farthest ( min ) and closest ( max ) depth of 2x2 texels of previous level
+		/// </summary>
+		void BuildHierarchy()
+		{
+			for (size_t level = 1; level < OCCLUSION_HIERARCHY_LEVEL_COUNT; ++level)
+			{
+				const size_t levelWidth = mWidth >> level;
+				const size_t levelHeight = mHeight >> level;
+				const size_t previousWidth = levelWidth * 2;
+				const float* previousMinDepths = mMinDepths[level - 1].data();
+				const float* previousMaxDepths = (level == 1) ? mMinDepths[0].data() : mMaxDepths[level - 1].data();
+				float* minDepths = mMinDepths[level].data();
+				float* maxDepths = mMaxDepths[level].data();
+
+				math::ParallelFor(levelHeight, mThreadCount, [=](size_t begin, size_t end, unsigned int)
+				{
+					for (size_t y = begin; y < end; ++y)
+					{
+						const size_t previousRow0 = (y * 2) * previousWidth;
+						const size_t previousRow1 = previousRow0 + previousWidth;
+						for (size_t x = 0; x < levelWidth; ++x)
+						{
+							const size_t previousX = x * 2;
+							minDepths[y * levelWidth + x] = math::Min
+							(
+								math::Min(previousMinDepths[previousRow0 + previousX], previousMinDepths[previousRow0 + previousX + 1]),
+								math::Min(previousMinDepths[previousRow1 + previousX], previousMinDepths[previousRow1 + previousX + 1])
+							);
+							maxDepths[y * levelWidth + x] = math::Max
+							(
+								math::Max(previousMaxDepths[previousRow0 + previousX], previousMaxDepths[previousRow0 + previousX + 1]),
+								math::Max(previousMaxDepths[previousRow1 + previousX], previousMaxDepths[previousRow1 + previousX + 1])
+							);
+						}
+					}
+				});
+			}
+		}
+
+		[[nodiscard]] FORCE_INLINE const float* GetMaxDepths(size_t level) const noexcept
+		{
+			return (level == 0) ? mMinDepths[0].data() : mMaxDepths[level].data();
+		}
+
+		/// <summary>
+		/// Test texels [minX, maxX] x [minY, maxY] of level. Coarse texels which can't decide are refined to children
+		/// </summary>
+		/// <param name="minX">pixel rect of occludee is [minX << level, ...]</param>
+		[[nodiscard]] bool IsTexelRectVisible(size_t level, int minX, int minY, int maxX, int maxY, int pixelMinX, int pixelMinY, int pixelMaxX, int pixelMaxY, float nearestDepth) const noexcept
+		{
+			const size_t levelWidth = mWidth >> level;
+			const float* minDepths = mMinDepths[level].data();
+			const float* maxDepths = GetMaxDepths(level);
+
+			for (int y = minY; y <= maxY; ++y)
+			{
+				for (int x = minX; x <= maxX; ++x)
+				{
+					const size_t texelIndex = static_cast<size_t>(y) * levelWidth + static_cast<size_t>(x);
+
+					// behind farthest occluder of texel
+					if (nearestDepth < minDepths[texelIndex])
+					{
+						continue;
+					}
+					// in front of every occluder of texel, or can't be refined
+					if (level == 0 || nearestDepth > maxDepths[texelIndex])
+					{
+						return true;
+					}
+
+					const size_t childLevel = level - 1;
+					const int childMinX = math::Max(x * 2, pixelMinX >> childLevel);
+					const int childMinY = math::Max(y * 2, pixelMinY >> childLevel);
+					const int childMaxX = math::Min(x * 2 + 1, pixelMaxX >> childLevel);
+					const int childMaxY = math::Min(y * 2 + 1, pixelMaxY >> childLevel);
+					if (IsTexelRectVisible(childLevel, childMinX, childMinY, childMaxX, childMaxY, pixelMinX, pixelMinY, pixelMaxX, pixelMaxY, nearestDepth) == true)
+					{
+						return true;
+					}
+				}
+			}
+			return false;
+		}
+
+		[[nodiscard]] bool IsNdcRectVisible(float minNdcX, float minNdcY, float maxNdcX, float maxNdcY, float nearestDepth) const noexcept
+		{
+			const float width = static_cast<float>(mWidth);
+			const float height = static_cast<float>(mHeight);
+			const float minScreenX = math::Max((minNdcX * 0.5f + 0.5f) * width, 0.0f);
+			const float minScreenY = math::Max((minNdcY * 0.5f + 0.5f) * height, 0.0f);
+			const float maxScreenX = math::Min((maxNdcX * 0.5f + 0.5f) * width, width - 1.0f);
+			const float maxScreenY = math::Min((maxNdcY * 0.5f + 0.5f) * height, height - 1.0f);
+			if (minScreenX > maxScreenX || minScreenY > maxScreenY)
+			{
+				return false;
+			}
+
+			const int pixelMinX = static_cast<int>(minScreenX);
+			const int pixelMinY = static_cast<int>(minScreenY);
+			const int pixelMaxX = static_cast<int>(maxScreenX);
+			const int pixelMaxY = static_cast<int>(maxScreenY);
+
+			// start from level where rect covers at most 2x2 texels
+			size_t level = 0;
+			while (level + 1 < OCCLUSION_HIERARCHY_LEVEL_COUNT && ((pixelMaxX >> level) - (pixelMinX >> level) > 1 || (pixelMaxY >> level) - (pixelMinY >> level) > 1))
+			{
+				++level;
+			}
+
+			return IsTexelRectVisible(level, pixelMinX >> level, pixelMinY >> level, pixelMaxX >> level, pixelMaxY >> level, pixelMinX, pixelMinY, pixelMaxX, pixelMaxY, nearestDepth);
+		}
+
+		size_t TestAABBRange(const AABBArraySoA& boxes, size_t begin, size_t end, const math::Matrix<4, 4, float>& viewProjectionMatrix, unsigned char* outVisibleFlags) const noexcept
+		{
+			size_t visibleCount = 0;
+			size_t boxIndex = begin;
+
+#ifdef SIMD_ENABLED
+			// rows of view projection matrix
+			M256F rows[3][4];
+			const size_t rowIndices[3]{ 0, 1, 3 };
+			for (size_t rowIndex = 0; rowIndex < 3; ++rowIndex)
+			{
+				for (size_t columnIndex = 0; columnIndex < 4; ++columnIndex)
+				{
+					rows[rowIndex][columnIndex] = _mm256_set1_ps(viewProjectionMatrix.columns[columnIndex][rowIndices[rowIndex]]);
+				}
+			}
+
+			for (; boxIndex + 8 <= end; boxIndex += 8)
+			{
+				const M256F minimum[3]{ _mm256_loadu_ps(boxes.minX + boxIndex), _mm256_loadu_ps(boxes.minY + boxIndex), _mm256_loadu_ps(boxes.minZ + boxIndex) };
+				const M256F maximum[3]{ _mm256_loadu_ps(boxes.maxX + boxIndex), _mm256_loadu_ps(boxes.maxY + boxIndex), _mm256_loadu_ps(boxes.maxZ + boxIndex) };
+
+				M256F minNdcX = _mm256_set1_ps(math::infinity<float>());
+				M256F minNdcY = minNdcX;
+				M256F maxNdcX = _mm256_set1_ps(math::negativeInfinity<float>());
+				M256F maxNdcY = maxNdcX;
+				M256F minW = minNdcX;
+				M256F nearestDepth = _mm256_setzero_ps();
+
+				for (unsigned int cornerIndex = 0; cornerIndex < 8; ++cornerIndex)
+				{
+					const M256F cornerX = (cornerIndex & 1) ? maximum[0] : minimum[0];
+					const M256F cornerY = (cornerIndex & 2) ? maximum[1] : minimum[1];
+					const M256F cornerZ = (cornerIndex & 4) ? maximum[2] : minimum[2];
+
+					M256F clip[3];
+					for (size_t rowIndex = 0; rowIndex < 3; ++rowIndex)
+					{
+						clip[rowIndex] = M256F_MUL_AND_ADD(rows[rowIndex][0], cornerX, rows[rowIndex][3]);
+						clip[rowIndex] = M256F_MUL_AND_ADD(rows[rowIndex][1], cornerY, clip[rowIndex]);
+						clip[rowIndex] = M256F_MUL_AND_ADD(rows[rowIndex][2], cornerZ, clip[rowIndex]);
+					}
+
+					const M256F inverseW = M256F_DIV(_mm256_set1_ps(1.0f), clip[2]);
+					const M256F ndcX = M256F_MUL(clip[0], inverseW);
+					const M256F ndcY = M256F_MUL(clip[1], inverseW);
+					minNdcX = _mm256_min_ps(minNdcX, ndcX);
+					minNdcY = _mm256_min_ps(minNdcY, ndcY);
+					maxNdcX = _mm256_max_ps(maxNdcX, ndcX);
+					maxNdcY = _mm256_max_ps(maxNdcY, ndcY);
+					minW = _mm256_min_ps(minW, clip[2]);
+					nearestDepth = _mm256_max_ps(nearestDepth, inverseW);
+				}
+
+				const unsigned int crossingNearMask = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(minW, _mm256_set1_ps(OCCLUSION_NEAR_CLIP_W), _CMP_LE_OQ)));
+
+				alignas(32) float laneValues[5][8];
+				_mm256_store_ps(laneValues[0], minNdcX);
+				_mm256_store_ps(laneValues[1], minNdcY);
+				_mm256_store_ps(laneValues[2], maxNdcX);
+				_mm256_store_ps(laneValues[3], maxNdcY);
+				_mm256_store_ps(laneValues[4], nearestDepth);
+
+				for (size_t lane = 0; lane < 8; ++lane)
+				{
+					const bool isVisible = ((crossingNearMask >> lane) & 1) != 0 ||
+						IsNdcRectVisible(laneValues[0][lane], laneValues[1][lane], laneValues[2][lane], laneValues[3][lane], laneValues[4][lane]) == true;
+					outVisibleFlags[boxIndex + lane] = (isVisible == true) ? 1 : 0;
+					visibleCount += (isVisible == true) ? 1 : 0;
+				}
+			}
+#endif
+
+			for (; boxIndex < end; ++boxIndex)
+			{
+				const AABB aabb
+				{
+					math::Vector<3, float>{ boxes.minX[boxIndex], boxes.minY[boxIndex], boxes.minZ[boxIndex] },
+					math::Vector<3, float>{ boxes.maxX[boxIndex], boxes.maxY[boxIndex], boxes.maxZ[boxIndex] }
+				};
+				const bool isVisible = TestAABB(aabb, viewProjectionMatrix);
+				outVisibleFlags[boxIndex] = (isVisible == true) ? 1 : 0;
+				visibleCount += (isVisible == true) ? 1 : 0;
+			}
+
+			return visibleCount;
+		}
+
+		size_t mWidth;
+		size_t mHeight;
+		size_t mTileCountX;
+		size_t mTileCountY;
+		unsigned int mThreadCount;
+
+		/// <summary>
+		/// level 0 is depth buffer. mMaxDepths[0] is not used
+		/// </summary>
+		std::vector<float> mMinDepths[OCCLUSION_HIERARCHY_LEVEL_COUNT];
+		std::vector<float> mMaxDepths[OCCLUSION_HIERARCHY_LEVEL_COUNT];
+
+		std::vector<detail::OcclusionTriangle> mTriangles;
+
+		/// <summary>
+		/// indices of mTriangles overlapping each tile
+		/// </summary>
+		std::vector<std::vector<unsigned int>> mTileBins;
+
+		/// <summary>
+		/// scratch of AddOccluder
+		/// </summary>
+		std::vector<math::Vector<4, float>> mClipVertices;
+	};
+}
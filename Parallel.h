@@ -0,0 +1,63 @@
+#pragma once
+
+#include <thread>
+#include <vector>
+
+#include "LMath_Core.h"
+
+namespace math
+{
+	/// <summary>
+	/// Return thread count for parallel functions. At least 1
+	/// </summary>
+	inline unsigned int GetDefaultThreadCount() noexcept
+	{
+		const unsigned int hardwareThreadCount = std::thread::hardware_concurrency();
+		return hardwareThreadCount > 0 ? hardwareThreadCount : 1;
+	}
+
+	/// <summary>
+	/// Split [0, count) to threadCount continuous ranges and call function(begin, end, rangeIndex) for each range in parallel
+	///
+	/// Range of rangeIndex is decided only by count and threadCount,
+	/// so results stored per rangeIndex can be merged in deterministic order
+	/// Range 0 is processed on calling thread
+	/// </summary>
+	/// <param name="function">void(size_t begin, size_t end, unsigned int rangeIndex)</param>
+	template <typename Function>
+	inline void ParallelFor(size_t count, unsigned int threadCount, const Function& function)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+
+		if (threadCount <= 1 || count == 1)
+		{
+			function(static_cast<size_t>(0), count, 0u);
+			return;
+		}
+
+		const size_t rangeSize = (count + threadCount - 1) / threadCount;
+
+		std::vector<std::thread> threads;
+		threads.reserve(threadCount - 1);
+		for (unsigned int rangeIndex = 1; rangeIndex < threadCount; ++rangeIndex)
+		{
+			const size_t begin = rangeSize * rangeIndex;
+			if (begin >= count)
+			{
+				break;
+			}
+			const size_t end = (begin + rangeSize < count) ? begin + rangeSize : count;
+			threads.emplace_back([&function, begin, end, rangeIndex]() { function(begin, end, rangeIndex); });
+		}
+
+		function(static_cast<size_t>(0), (rangeSize < count) ? rangeSize : count, 0u);
+
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+}
@@ -0,0 +1,331 @@
+#pragma once
+
+#include "LMath_Core.h"
+#include "Utility.h"
+#include "Vector3.h"
+#include "Collision.h"
+
+#include "SIMD_Core.h"
+
+namespace math
+{
+	inline constexpr unsigned int RAY_INVALID_INDEX = static_cast<unsigned int>(-1);
+
+	/// <summary>
+	/// Ray with precomputed inverse direction for slab test
+	/// Direction doesn't need to be normalized. Distance along ray is measured in length of direction
+	/// </summary>
+	struct Ray
+	{
+		math::Vector<3, float> origin;
+		math::Vector<3, float> direction;
+		math::Vector<3, float> inverseDirection;
+
+		Ray() noexcept = default;
+
+		FORCE_INLINE Ray(const math::Vector<3, float>& originValue, const math::Vector<3, float>& directionValue) noexcept
+			: origin{ originValue }, direction{ directionValue }, inverseDirection{ 1.0f / directionValue.x, 1.0f / directionValue.y, 1.0f / directionValue.z }
+		{
+		}
+
+		[[nodiscard]] FORCE_INLINE math::Vector<3, float> GetPoint(float distance) const noexcept
+		{
+			return origin + direction * distance;
+		}
+	};
+
+	/// <summary>
+	/// 8 coherent rays stored as structure of arrays
+	/// Lanes whose maxDistance is negative are inactive and never hit
+	/// </summary>
+	struct alignas(32) RayPacket8
+	{
+		float originX[8];
+		float originY[8];
+		float originZ[8];
+		float directionX[8];
+		float directionY[8];
+		float directionZ[8];
+		float inverseDirectionX[8];
+		float inverseDirectionY[8];
+		float inverseDirectionZ[8];
+		float maxDistance[8];
+
+		RayPacket8() noexcept = default;
+
+		/// <param name="rayCount">up to 8. remained lanes are inactive zero rays. rays can be nullptr when it's 0</param>
+		RayPacket8(const Ray* rays, size_t rayCount, float maxDistanceValue) noexcept
+		{
+			assert(rayCount <= 8);
+			const Ray inactiveRay{};
+			for (size_t lane = 0; lane < 8; ++lane)
+			{
+				if (lane < rayCount)
+				{
+					SetRay(lane, rays[lane], maxDistanceValue);
+				}
+				else
+				{
+					SetRay(lane, inactiveRay, -1.0f);
+				}
+			}
+		}
+
+		FORCE_INLINE void SetRay(size_t lane, const Ray& ray, float maxDistanceValue) noexcept
+		{
+			originX[lane] = ray.origin.x;
+			originY[lane] = ray.origin.y;
+			originZ[lane] = ray.origin.z;
+			directionX[lane] = ray.direction.x;
+			directionY[lane] = ray.direction.y;
+			directionZ[lane] = ray.direction.z;
+			inverseDirectionX[lane] = ray.inverseDirection.x;
+			inverseDirectionY[lane] = ray.inverseDirection.y;
+			inverseDirectionZ[lane] = ray.inverseDirection.z;
+			maxDistance[lane] = maxDistanceValue;
+		}
+
+		[[nodiscard]] FORCE_INLINE Ray GetRay(size_t lane) const noexcept
+		{
+			return Ray{ math::Vector<3, float>{ originX[lane], originY[lane], originZ[lane] }, math::Vector<3, float>{ directionX[lane], directionY[lane], directionZ[lane] } };
+		}
+
+		/// <returns>bit mask of lanes whose maxDistance isn't negative</returns>
+		[[nodiscard]] FORCE_INLINE unsigned int GetActiveMask() const noexcept
+		{
+			unsigned int mask = 0;
+			for (unsigned int lane = 0; lane < 8; ++lane)
+			{
+				if (maxDistance[lane] >= 0.0f)
+				{
+					mask |= 1u << lane;
+				}
+			}
+			return mask;
+		}
+	};
+
+	/// <summary>
+	/// Slab test
+	/// </summary>
+	/// <param name="outDistance">when not nullptr, distance to entry point is written. 0 when origin is inside of box</param>
+	[[nodiscard]] inline bool IsRayHitAABB(const Ray& ray, float maxDistance, const AABB& aabb, float* outDistance = nullptr) noexcept
+	{
+		float tMin = 0.0f;
+		float tMax = maxDistance;
+		for (unsigned int axis = 0; axis < 3; ++axis)
+		{
+			const float t1 = (aabb.minimum[axis] - ray.origin[axis]) * ray.inverseDirection[axis];
+			const float t2 = (aabb.maximum[axis] - ray.origin[axis]) * ray.inverseDirection[axis];
+			tMin = math::Max(tMin, math::Min(t1, t2));
+			tMax = math::Min(tMax, math::Max(t1, t2));
+		}
+
+		if (tMin <= tMax)
+		{
+			if (outDistance != nullptr)
+			{
+				*outDistance = tMin;
+			}
+			return true;
+		}
+		return false;
+	}
+
+	namespace detail
+	{
+#ifdef SIMD_ENABLED
+		/// <summary>
+		/// Slab test of 8 lanes. Every argument is 8 wide
+		/// Hit is decided by mask, not by distance, so maxDistance can be infinity
+		/// </summary>
+		/// <param name="outDistance">entry distance. Only valid on lanes set in returned mask</param>
+		/// <returns>mask of lanes hitting box ( tMin <= tMax )</returns>
+		FORCE_INLINE M256F IntersectRaySlab8(
+			const M256F& originX, const M256F& originY, const M256F& originZ,
+			const M256F& inverseDirectionX, const M256F& inverseDirectionY, const M256F& inverseDirectionZ,
+			const M256F& maxDistance,
+			const M256F& minX, const M256F& minY, const M256F& minZ,
+			const M256F& maxX, const M256F& maxY, const M256F& maxZ,
+			M256F& outDistance
+		)
+		{
+			const M256F t1X = M256F_MUL(M256F_SUB(minX, originX), inverseDirectionX);
+			const M256F t2X = M256F_MUL(M256F_SUB(maxX, originX), inverseDirectionX);
+			const M256F t1Y = M256F_MUL(M256F_SUB(minY, originY), inverseDirectionY);
+			const M256F t2Y = M256F_MUL(M256F_SUB(maxY, originY), inverseDirectionY);
+			const M256F t1Z = M256F_MUL(M256F_SUB(minZ, originZ), inverseDirectionZ);
+			const M256F t2Z = M256F_MUL(M256F_SUB(maxZ, originZ), inverseDirectionZ);
+
+			M256F tMin = _mm256_max_ps(_mm256_min_ps(t1X, t2X), _mm256_setzero_ps());
+			tMin = _mm256_max_ps(tMin, _mm256_min_ps(t1Y, t2Y));
+			tMin = _mm256_max_ps(tMin, _mm256_min_ps(t1Z, t2Z));
+
+			M256F tMax = _mm256_min_ps(_mm256_max_ps(t1X, t2X), maxDistance);
+			tMax = _mm256_min_ps(tMax, _mm256_max_ps(t1Y, t2Y));
+			tMax = _mm256_min_ps(tMax, _mm256_max_ps(t1Z, t2Z));
+
+			outDistance = tMin;
+			return _mm256_cmp_ps(tMin, tMax, _CMP_LE_OQ);
+		}
+#endif
+	}
+
+	/// <summary>
+	/// Find every box hit by ray within maxDistance
+	/// 8 boxes are tested at once
+	/// </summary>
+	/// <param name="outBoxIndices">caller provided buffer</param>
+	/// <returns>count of hit boxes. When it's larger than maxBoxCount, only maxBoxCount indices are written</returns>
+	inline size_t FindRayAABBHits(const Ray& ray, float maxDistance, const AABBArraySoA& boxes, unsigned int* outBoxIndices, size_t maxBoxCount)
+	{
+		size_t hitCount = 0;
+		size_t boxIndex = 0;
+
+#ifdef SIMD_ENABLED
+		const M256F originX = _mm256_set1_ps(ray.origin.x);
+		const M256F originY = _mm256_set1_ps(ray.origin.y);
+		const M256F originZ = _mm256_set1_ps(ray.origin.z);
+		const M256F inverseDirectionX = _mm256_set1_ps(ray.inverseDirection.x);
+		const M256F inverseDirectionY = _mm256_set1_ps(ray.inverseDirection.y);
+		const M256F inverseDirectionZ = _mm256_set1_ps(ray.inverseDirection.z);
+		const M256F m256f_maxDistance = _mm256_set1_ps(maxDistance);
+
+		for (; boxIndex + 8 <= boxes.count; boxIndex += 8)
+		{
+			M256F distance;
+			const M256F isHit = detail::IntersectRaySlab8(
+				originX, originY, originZ, inverseDirectionX, inverseDirectionY, inverseDirectionZ, m256f_maxDistance,
+				_mm256_loadu_ps(boxes.minX + boxIndex), _mm256_loadu_ps(boxes.minY + boxIndex), _mm256_loadu_ps(boxes.minZ + boxIndex),
+				_mm256_loadu_ps(boxes.maxX + boxIndex), _mm256_loadu_ps(boxes.maxY + boxIndex), _mm256_loadu_ps(boxes.maxZ + boxIndex),
+				distance
+			);
+
+			unsigned int hitMask = static_cast<unsigned int>(_mm256_movemask_ps(isHit));
+			while (hitMask != 0)
+			{
+				const unsigned int lane = math::countTrailingZero(hitMask);
+				hitMask &= hitMask - 1;
+				if (hitCount < maxBoxCount)
+				{
+					outBoxIndices[hitCount] = static_cast<unsigned int>(boxIndex + lane);
+				}
+				++hitCount;
+			}
+		}
+#endif
+
+		for (; boxIndex < boxes.count; ++boxIndex)
+		{
+			const AABB aabb{ math::Vector<3, float>{ boxes.minX[boxIndex], boxes.minY[boxIndex], boxes.minZ[boxIndex] }, math::Vector<3, float>{ boxes.maxX[boxIndex], boxes.maxY[boxIndex], boxes.maxZ[boxIndex] } };
+			if (IsRayHitAABB(ray, maxDistance, aabb) == true)
+			{
+				if (hitCount < maxBoxCount)
+				{
+					outBoxIndices[hitCount] = static_cast<unsigned int>(boxIndex);
+				}
+				++hitCount;
+			}
+		}
+
+		return hitCount;
+	}
+
+	/// <summary>
+	/// Find box whose entry point is closest to ray origin
+	/// </summary>
+	/// <returns>index of closest box. RAY_INVALID_INDEX if no box is hit</returns>
+	inline unsigned int FindClosestRayAABBHit(const Ray& ray, float maxDistance, const AABBArraySoA& boxes, float* outDistance = nullptr)
+	{
+		float closestDistance = maxDistance;
+		unsigned int closestBoxIndex = RAY_INVALID_INDEX;
+		size_t boxIndex = 0;
+
+#ifdef SIMD_ENABLED
+		const M256F originX = _mm256_set1_ps(ray.origin.x);
+		const M256F originY = _mm256_set1_ps(ray.origin.y);
+		const M256F originZ = _mm256_set1_ps(ray.origin.z);
+		const M256F inverseDirectionX = _mm256_set1_ps(ray.inverseDirection.x);
+		const M256F inverseDirectionY = _mm256_set1_ps(ray.inverseDirection.y);
+		const M256F inverseDirectionZ = _mm256_set1_ps(ray.inverseDirection.z);
+
+		for (; boxIndex + 8 <= boxes.count; boxIndex += 8)
+		{
+			// shrink range by closest hit so far
+			const M256F m256f_closestDistance = _mm256_set1_ps(closestDistance);
+			M256F distance;
+			const M256F isHit = detail::IntersectRaySlab8(
+				originX, originY, originZ, inverseDirectionX, inverseDirectionY, inverseDirectionZ, m256f_closestDistance,
+				_mm256_loadu_ps(boxes.minX + boxIndex), _mm256_loadu_ps(boxes.minY + boxIndex), _mm256_loadu_ps(boxes.minZ + boxIndex),
+				_mm256_loadu_ps(boxes.maxX + boxIndex), _mm256_loadu_ps(boxes.maxY + boxIndex), _mm256_loadu_ps(boxes.maxZ + boxIndex),
+				distance
+			);
+
+			unsigned int hitMask = static_cast<unsigned int>(_mm256_movemask_ps(isHit));
+			if (hitMask != 0)
+			{
+				alignas(32) float distances[8];
+				_mm256_store_ps(distances, distance);
+				while (hitMask != 0)
+				{
+					const unsigned int lane = math::countTrailingZero(hitMask);
+					hitMask &= hitMask - 1;
+					if (closestBoxIndex == RAY_INVALID_INDEX || distances[lane] < closestDistance)
+					{
+						closestDistance = distances[lane];
+						closestBoxIndex = static_cast<unsigned int>(boxIndex + lane);
+					}
+				}
+			}
+		}
+#endif
+
+		for (; boxIndex < boxes.count; ++boxIndex)
+		{
+			const AABB aabb{ math::Vector<3, float>{ boxes.minX[boxIndex], boxes.minY[boxIndex], boxes.minZ[boxIndex] }, math::Vector<3, float>{ boxes.maxX[boxIndex], boxes.maxY[boxIndex], boxes.maxZ[boxIndex] } };
+			float distance;
+			if (IsRayHitAABB(ray, closestDistance, aabb, &distance) == true && (closestBoxIndex == RAY_INVALID_INDEX || distance < closestDistance))
+			{
+				closestDistance = distance;
+				closestBoxIndex = static_cast<unsigned int>(boxIndex);
+			}
+		}
+
+		if (outDistance != nullptr && closestBoxIndex != RAY_INVALID_INDEX)
+		{
+			*outDistance = closestDistance;
+		}
+		return closestBoxIndex;
+	}
+
+	/// <summary>
+	/// Test 8 rays of packet with a box at once
+	/// </summary>
+	/// <returns>bit mask of rays hitting box</returns>
+	[[nodiscard]] inline unsigned int TestRayPacketWithAABB(const RayPacket8& rayPacket, const AABB& aabb) noexcept
+	{
+#ifdef SIMD_ENABLED
+		const M256F maxDistance = _mm256_load_ps(rayPacket.maxDistance);
+		M256F distance;
+		const M256F isHit = detail::IntersectRaySlab8(
+			_mm256_load_ps(rayPacket.originX), _mm256_load_ps(rayPacket.originY), _mm256_load_ps(rayPacket.originZ),
+			_mm256_load_ps(rayPacket.inverseDirectionX), _mm256_load_ps(rayPacket.inverseDirectionY), _mm256_load_ps(rayPacket.inverseDirectionZ),
+			maxDistance,
+			_mm256_set1_ps(aabb.minimum.x), _mm256_set1_ps(aabb.minimum.y), _mm256_set1_ps(aabb.minimum.z),
+			_mm256_set1_ps(aabb.maximum.x), _mm256_set1_ps(aabb.maximum.y), _mm256_set1_ps(aabb.maximum.z),
+			distance
+		);
+		return static_cast<unsigned int>(_mm256_movemask_ps(isHit));
+#else
+		unsigned int mask = 0;
+		for (unsigned int lane = 0; lane < 8; ++lane)
+		{
+			if (IsRayHitAABB(rayPacket.GetRay(lane), rayPacket.maxDistance[lane], aabb) == true)
+			{
+				mask |= 1u << lane;
+			}
+		}
+		return mask;
+#endif
+	}
+}
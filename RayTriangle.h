@@ -0,0 +1,374 @@
+#pragma once
+
+#include "LMath_Core.h"
+#include "Utility.h"
+#include "Vector3.h"
+#include "Ray.h"
+
+#include "SIMD_Core.h"
+
+namespace math
+{
+	/// <summary>
+	/// Ray parallel to triangle ( |determinant| is smaller than this ) is treated as miss
+	/// </summary>
+	inline constexpr float RAY_TRIANGLE_DETERMINANT_EPSILON = 1e-8f;
+
+	/// <summary>
+	/// 8 triangles stored as structure of arrays with precomputed edges
+	/// edge1 = vertex1 - vertex0, edge2 = vertex2 - vertex0
+	/// Unused lanes have zero edges and never hit
+	/// </summary>
+	struct alignas(32) TriangleBlock8
+	{
+		float vertex0X[8];
+		float vertex0Y[8];
+		float vertex0Z[8];
+		float edge1X[8];
+		float edge1Y[8];
+		float edge1Z[8];
+		float edge2X[8];
+		float edge2Y[8];
+		float edge2Z[8];
+		unsigned int triangleIndex[8];
+
+		FORCE_INLINE void SetTriangle(size_t lane, const math::Vector<3, float>& vertex0, const math::Vector<3, float>& vertex1, const math::Vector<3, float>& vertex2, unsigned int triangleIndexValue) noexcept
+		{
+			const math::Vector<3, float> edge1 = vertex1 - vertex0;
+			const math::Vector<3, float> edge2 = vertex2 - vertex0;
+			vertex0X[lane] = vertex0.x;
+			vertex0Y[lane] = vertex0.y;
+			vertex0Z[lane] = vertex0.z;
+			edge1X[lane] = edge1.x;
+			edge1Y[lane] = edge1.y;
+			edge1Z[lane] = edge1.z;
+			edge2X[lane] = edge2.x;
+			edge2Y[lane] = edge2.y;
+			edge2Z[lane] = edge2.z;
+			triangleIndex[lane] = triangleIndexValue;
+		}
+
+		FORCE_INLINE void ClearTriangle(size_t lane) noexcept
+		{
+			vertex0X[lane] = vertex0Y[lane] = vertex0Z[lane] = 0.0f;
+			edge1X[lane] = edge1Y[lane] = edge1Z[lane] = 0.0f;
+			edge2X[lane] = edge2Y[lane] = edge2Z[lane] = 0.0f;
+			triangleIndex[lane] = RAY_INVALID_INDEX;
+		}
+	};
+
+	/// <summary>
+	/// Hit point is vertex0 * ( 1 - u - v ) + vertex1 * u + vertex2 * v
+	/// </summary>
+	struct RayTriangleHit
+	{
+		float distance;
+		float u;
+		float v;
+		unsigned int triangleIndex;
+	};
+
+	/// <summary>
+	/// Hits of 8 rays of RayPacket8. Lanes without hit have RAY_INVALID_INDEX as triangleIndex
+	/// </summary>
+	struct alignas(32) RayTriangleHit8
+	{
+		float distance[8];
+		float u[8];
+		float v[8];
+		unsigned int triangleIndex[8];
+
+		RayTriangleHit8() noexcept = default;
+
+		/// <summary>
+		/// distance of each lane starts from maxDistance of packet
+		/// </summary>
+		explicit RayTriangleHit8(const RayPacket8& rayPacket) noexcept
+		{
+			for (size_t lane = 0; lane < 8; ++lane)
+			{
+				distance[lane] = rayPacket.maxDistance[lane];
+				u[lane] = 0.0f;
+				v[lane] = 0.0f;
+				triangleIndex[lane] = RAY_INVALID_INDEX;
+			}
+		}
+	};
+
+	[[nodiscard]] inline size_t GetTriangleBlockCount(size_t triangleCount) noexcept
+	{
+		return (triangleCount + 7) / 8;
+	}
+
+	/// <summary>
+	/// Pack triangles to blocks
+	/// </summary>
+	/// <param name="indices">3 vertex indices per triangle. When nullptr, every 3 continuous positions make a triangle</param>
+	/// <param name="outBlocks">should have GetTriangleBlockCount(triangleCount) elements</param>
+	inline void BuildTriangleBlocks(const math::Vector<3, float>* positions, const unsigned int* indices, size_t triangleCount, TriangleBlock8* outBlocks) noexcept
+	{
+		const size_t blockCount = GetTriangleBlockCount(triangleCount);
+		for (size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+		{
+			for (size_t lane = 0; lane < 8; ++lane)
+			{
+				const size_t triangleIndex = blockIndex * 8 + lane;
+				if (triangleIndex < triangleCount)
+				{
+					const size_t i0 = (indices != nullptr) ? indices[triangleIndex * 3 + 0] : triangleIndex * 3 + 0;
+					const size_t i1 = (indices != nullptr) ? indices[triangleIndex * 3 + 1] : triangleIndex * 3 + 1;
+					const size_t i2 = (indices != nullptr) ? indices[triangleIndex * 3 + 2] : triangleIndex * 3 + 2;
+					outBlocks[blockIndex].SetTriangle(lane, positions[i0], positions[i1], positions[i2], static_cast<unsigned int>(triangleIndex));
+				}
+				else
+				{
+					outBlocks[blockIndex].ClearTriangle(lane);
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// Möller–Trumbore ray triangle intersection. Both faces are hit
+	/// </summary>
+	/// <returns>true if ray hits triangle in [0, maxDistance]</returns>
+	[[nodiscard]] inline bool IntersectRayTriangle(
+		const Ray& ray, float maxDistance,
+		const math::Vector<3, float>& vertex0, const math::Vector<3, float>& edge1, const math::Vector<3, float>& edge2,
+		float& outDistance, float& outU, float& outV
+	) noexcept
+	{
+		const math::Vector<3, float> p = math::cross(ray.direction, edge2);
+		const float determinant = math::dot(edge1, p);
+		if (math::abs(determinant) < RAY_TRIANGLE_DETERMINANT_EPSILON)
+		{
+			return false;
+		}
+
+		const float inverseDeterminant = 1.0f / determinant;
+		const math::Vector<3, float> s = ray.origin - vertex0;
+		const float u = math::dot(s, p) * inverseDeterminant;
+		if (u < 0.0f || u > 1.0f)
+		{
+			return false;
+		}
+
+		const math::Vector<3, float> q = math::cross(s, edge1);
+		const float v = math::dot(ray.direction, q) * inverseDeterminant;
+		if (v < 0.0f || u + v > 1.0f)
+		{
+			return false;
+		}
+
+		const float distance = math::dot(edge2, q) * inverseDeterminant;
+		if (distance < 0.0f || distance > maxDistance)
+		{
+			return false;
+		}
+
+		outDistance = distance;
+		outU = u;
+		outV = v;
+		return true;
+	}
+
+	namespace detail
+	{
+#ifdef SIMD_ENABLED
+		/// <summary>
+		/// Möller–Trumbore of 8 lanes. Every argument is 8 wide
+		/// </summary>
+		/// <returns>mask of lanes hit in [0, maxDistance]</returns>
+		FORCE_INLINE M256F IntersectRayTriangle8(
+			const M256F& originX, const M256F& originY, const M256F& originZ,
+			const M256F& directionX, const M256F& directionY, const M256F& directionZ,
+			const M256F& maxDistance,
+			const M256F& vertex0X, const M256F& vertex0Y, const M256F& vertex0Z,
+			const M256F& edge1X, const M256F& edge1Y, const M256F& edge1Z,
+			const M256F& edge2X, const M256F& edge2Y, const M256F& edge2Z,
+			M256F& outDistance, M256F& outU, M256F& outV
+		)
+		{
+			// p = cross(direction, edge2)
+			const M256F pX = M256F_SUB(M256F_MUL(directionY, edge2Z), M256F_MUL(edge2Y, directionZ));
+			const M256F pY = M256F_SUB(M256F_MUL(directionZ, edge2X), M256F_MUL(edge2Z, directionX));
+			const M256F pZ = M256F_SUB(M256F_MUL(directionX, edge2Y), M256F_MUL(edge2X, directionY));
+
+			const M256F determinant = M256F_MUL_AND_ADD(edge1Z, pZ, M256F_MUL_AND_ADD(edge1Y, pY, M256F_MUL(edge1X, pX)));
+			const M256F absDeterminant = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), determinant);
+			M256F isHit = _mm256_cmp_ps(absDeterminant, _mm256_set1_ps(RAY_TRIANGLE_DETERMINANT_EPSILON), _CMP_GE_OQ);
+
+			const M256F inverseDeterminant = M256F_DIV(_mm256_set1_ps(1.0f), determinant);
+
+			// s = origin - vertex0
+			const M256F sX = M256F_SUB(originX, vertex0X);
+			const M256F sY = M256F_SUB(originY, vertex0Y);
+			const M256F sZ = M256F_SUB(originZ, vertex0Z);
+
+			const M256F u = M256F_MUL(M256F_MUL_AND_ADD(sZ, pZ, M256F_MUL_AND_ADD(sY, pY, M256F_MUL(sX, pX))), inverseDeterminant);
+
+			// q = cross(s, edge1)
+			const M256F qX = M256F_SUB(M256F_MUL(sY, edge1Z), M256F_MUL(edge1Y, sZ));
+			const M256F qY = M256F_SUB(M256F_MUL(sZ, edge1X), M256F_MUL(edge1Z, sX));
+			const M256F qZ = M256F_SUB(M256F_MUL(sX, edge1Y), M256F_MUL(edge1X, sY));
+
+			const M256F v = M256F_MUL(M256F_MUL_AND_ADD(directionZ, qZ, M256F_MUL_AND_ADD(directionY, qY, M256F_MUL(directionX, qX))), inverseDeterminant);
+			const M256F distance = M256F_MUL(M256F_MUL_AND_ADD(edge2Z, qZ, M256F_MUL_AND_ADD(edge2Y, qY, M256F_MUL(edge2X, qX))), inverseDeterminant);
+
+			const M256F zero = _mm256_setzero_ps();
+			isHit = _mm256_and_ps(isHit, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+			isHit = _mm256_and_ps(isHit, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+			isHit = _mm256_and_ps(isHit, _mm256_cmp_ps(M256F_ADD(u, v), _mm256_set1_ps(1.0f), _CMP_LE_OQ));
+			isHit = _mm256_and_ps(isHit, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+			isHit = _mm256_and_ps(isHit, _mm256_cmp_ps(distance, maxDistance, _CMP_LE_OQ));
+
+			outDistance = distance;
+			outU = u;
+			outV = v;
+			return isHit;
+		}
+#endif
+	}
+
+	/// <summary>
+	/// Test a ray with 8 triangles of block at once
+	/// inOutHit is updated only when a triangle closer than inOutHit.distance is hit
+	/// </summary>
+	/// <param name="inOutHit">distance should be initialized to max distance of ray</param>
+	/// <returns>true if inOutHit is updated</returns>
+	inline bool IntersectRayTriangleBlock(const Ray& ray, const TriangleBlock8& block, RayTriangleHit& inOutHit) noexcept
+	{
+		bool isUpdated = false;
+
+#ifdef SIMD_ENABLED
+		M256F distance, u, v;
+		const M256F isHit = detail::IntersectRayTriangle8(
+			_mm256_set1_ps(ray.origin.x), _mm256_set1_ps(ray.origin.y), _mm256_set1_ps(ray.origin.z),
+			_mm256_set1_ps(ray.direction.x), _mm256_set1_ps(ray.direction.y), _mm256_set1_ps(ray.direction.z),
+			_mm256_set1_ps(inOutHit.distance),
+			_mm256_load_ps(block.vertex0X), _mm256_load_ps(block.vertex0Y), _mm256_load_ps(block.vertex0Z),
+			_mm256_load_ps(block.edge1X), _mm256_load_ps(block.edge1Y), _mm256_load_ps(block.edge1Z),
+			_mm256_load_ps(block.edge2X), _mm256_load_ps(block.edge2Y), _mm256_load_ps(block.edge2Z),
+			distance, u, v
+		);
+
+		unsigned int hitMask = static_cast<unsigned int>(_mm256_movemask_ps(isHit));
+		if (hitMask != 0)
+		{
+			alignas(32) float distances[8];
+			alignas(32) float us[8];
+			alignas(32) float vs[8];
+			_mm256_store_ps(distances, distance);
+			_mm256_store_ps(us, u);
+			_mm256_store_ps(vs, v);
+
+			while (hitMask != 0)
+			{
+				const unsigned int lane = math::countTrailingZero(hitMask);
+				hitMask &= hitMask - 1;
+				if (isUpdated == false || distances[lane] < inOutHit.distance)
+				{
+					inOutHit = RayTriangleHit{ distances[lane], us[lane], vs[lane], block.triangleIndex[lane] };
+					isUpdated = true;
+				}
+			}
+		}
+#else
+		for (size_t lane = 0; lane < 8; ++lane)
+		{
+			float distance, u, v;
+			if (
+				IntersectRayTriangle(
+					ray, inOutHit.distance,
+					math::Vector<3, float>{ block.vertex0X[lane], block.vertex0Y[lane], block.vertex0Z[lane] },
+					math::Vector<3, float>{ block.edge1X[lane], block.edge1Y[lane], block.edge1Z[lane] },
+					math::Vector<3, float>{ block.edge2X[lane], block.edge2Y[lane], block.edge2Z[lane] },
+					distance, u, v
+				) == true &&
+				(isUpdated == false || distance < inOutHit.distance)
+				)
+			{
+				inOutHit = RayTriangleHit{ distance, u, v, block.triangleIndex[lane] };
+				isUpdated = true;
+			}
+		}
+#endif
+
+		return isUpdated;
+	}
+
+	/// <summary>
+	/// Find nearest triangle hit by ray
+	/// </summary>
+	/// <returns>true if a triangle is hit in [0, maxDistance]</returns>
+	inline bool IntersectRayTriangleBlocks(const Ray& ray, float maxDistance, const TriangleBlock8* blocks, size_t blockCount, RayTriangleHit& outHit) noexcept
+	{
+		RayTriangleHit hit{ maxDistance, 0.0f, 0.0f, RAY_INVALID_INDEX };
+		for (size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+		{
+			IntersectRayTriangleBlock(ray, blocks[blockIndex], hit);
+		}
+
+		if (hit.triangleIndex != RAY_INVALID_INDEX)
+		{
+			outHit = hit;
+			return true;
+		}
+		return false;
+	}
+
+	/// <summary>
+	/// Test 8 rays of packet with a triangle at once
+	/// Lanes of inOutHits are updated only when triangle is closer than inOutHits.distance
+	/// </summary>
+	/// <param name="inOutHits">initialize with RayTriangleHit8(rayPacket)</param>
+	/// <returns>bit mask of updated lanes</returns>
+	inline unsigned int IntersectRayPacketTriangle(
+		const RayPacket8& rayPacket,
+		const math::Vector<3, float>& vertex0, const math::Vector<3, float>& vertex1, const math::Vector<3, float>& vertex2, unsigned int triangleIndex,
+		RayTriangleHit8& inOutHits
+	) noexcept
+	{
+		const math::Vector<3, float> edge1 = vertex1 - vertex0;
+		const math::Vector<3, float> edge2 = vertex2 - vertex0;
+
+#ifdef SIMD_ENABLED
+		M256F distance, u, v;
+		const M256F isHit = detail::IntersectRayTriangle8(
+			_mm256_load_ps(rayPacket.originX), _mm256_load_ps(rayPacket.originY), _mm256_load_ps(rayPacket.originZ),
+			_mm256_load_ps(rayPacket.directionX), _mm256_load_ps(rayPacket.directionY), _mm256_load_ps(rayPacket.directionZ),
+			_mm256_load_ps(inOutHits.distance),
+			_mm256_set1_ps(vertex0.x), _mm256_set1_ps(vertex0.y), _mm256_set1_ps(vertex0.z),
+			_mm256_set1_ps(edge1.x), _mm256_set1_ps(edge1.y), _mm256_set1_ps(edge1.z),
+			_mm256_set1_ps(edge2.x), _mm256_set1_ps(edge2.y), _mm256_set1_ps(edge2.z),
+			distance, u, v
+		);
+
+		_mm256_store_ps(inOutHits.distance, _mm256_blendv_ps(_mm256_load_ps(inOutHits.distance), distance, isHit));
+		_mm256_store_ps(inOutHits.u, _mm256_blendv_ps(_mm256_load_ps(inOutHits.u), u, isHit));
+		_mm256_store_ps(inOutHits.v, _mm256_blendv_ps(_mm256_load_ps(inOutHits.v), v, isHit));
+
+		const unsigned int hitMask = static_cast<unsigned int>(_mm256_movemask_ps(isHit));
+		for (unsigned int mask = hitMask; mask != 0; mask &= mask - 1)
+		{
+			inOutHits.triangleIndex[math::countTrailingZero(mask)] = triangleIndex;
+		}
+		return hitMask;
+#else
+		unsigned int hitMask = 0;
+		for (unsigned int lane = 0; lane < 8; ++lane)
+		{
+			float distance, u, v;
+			if (IntersectRayTriangle(rayPacket.GetRay(lane), inOutHits.distance[lane], vertex0, edge1, edge2, distance, u, v) == true)
+			{
+				inOutHits.distance[lane] = distance;
+				inOutHits.u[lane] = u;
+				inOutHits.v[lane] = v;
+				inOutHits.triangleIndex[lane] = triangleIndex;
+				hitMask |= 1u << lane;
+			}
+		}
+		return hitMask;
+#endif
+	}
+}
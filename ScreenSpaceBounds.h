@@ -0,0 +1,225 @@
+#pragma once
+
+#include <cmath>
+
+#include "LMath_Core.h"
+#include "Utility.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix4x4.h"
+#include "Culling.h"
+
+#include "SIMD_Core.h"
+
+namespace math
+{
+	/// <summary>
+	/// Screen space bounds of 8 projected spheres stored as structure of arrays
+	/// Rect is in NDC and clamped to [-1, 1]. Sphere out of screen has empty rect ( min == max on clamped axis )
+	/// Radius is projected radius in NDC y unit ( 1 is half of screen height )
+	/// </summary>
+	struct alignas(32) ProjectedSphereBlock8
+	{
+		float minX[8];
+		float minY[8];
+		float maxX[8];
+		float maxY[8];
+		float radius[8];
+	};
+
+	/// <summary>
+	/// Screen space bounds of projected sphere
+	/// </summary>
+	struct ProjectedSphereBounds
+	{
+		float minX;
+		float minY;
+		float maxX;
+		float maxY;
+		float radius;
+
+		/// <summary>
+		/// Fraction of screen covered by rect. 1 is full screen
+		/// </summary>
+		[[nodiscard]] FORCE_INLINE float GetScreenCoverage() const noexcept
+		{
+			return (maxX - minX) * (maxY - minY) * 0.25f;
+		}
+	};
+
+	/// <summary>
+	/// Tight NDC rect of view space sphere projected by symmetric perspective matrix ( made by perspective, perspectiveFov )
+	///
+	/// Bound of each axis is where tangent line from eye touches sphere.
+	/// With depth d, coordinate x and radius r, slope of tangent lines is ( x * d -+ r * sqrt(x^2 + d^2 - r^2) ) / ( d^2 - r^2 )
+	/// Projected radius is r / sqrt(d^2 - r^2), tangent of half angle sphere covers, scaled by projection
+	///
+	/// Sphere containing eye or crossing eye plane covers full screen and has infinite radius
+	/// Sphere completely behind eye has empty rect at origin and 0 radius, so it gets coarsest LOD
+	/// Near plane isn't clipped, so rect is conservative when sphere crosses near plane
+	///
+	/// reference : 2D Polyhedral Bounds of a Clipped, Perspective-Projected 3D Sphere, M. Mara, M. McGuire
+	/// </summary>
+	[[nodiscard]] inline ProjectedSphereBounds ComputeProjectedSphereBounds(const math::Vector<3, float>& viewCenter, float radius, const math::Matrix<4, 4, float>& projectionMatrix) noexcept
+	{
+		// clip w = forwardSign * view z. -1 for right handed projection
+		const float depth = projectionMatrix.columns[2][3] * viewCenter.z;
+		if (depth < -radius)
+		{
+			return ProjectedSphereBounds{ 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+		}
+		if (depth <= radius)
+		{
+			return ProjectedSphereBounds{ -1.0f, -1.0f, 1.0f, 1.0f, math::infinity<float>() };
+		}
+
+		const float scaleX = projectionMatrix.columns[0][0];
+		const float scaleY = projectionMatrix.columns[1][1];
+		const float sqrDepthMinusRadius = depth * depth - radius * radius;
+		const float inverseDenominator = 1.0f / sqrDepthMinusRadius;
+		const float tangentX = radius * std::sqrt(viewCenter.x * viewCenter.x + sqrDepthMinusRadius);
+		const float tangentY = radius * std::sqrt(viewCenter.y * viewCenter.y + sqrDepthMinusRadius);
+
+		ProjectedSphereBounds bounds;
+		bounds.minX = math::clamp(scaleX * (viewCenter.x * depth - tangentX) * inverseDenominator, -1.0f, 1.0f);
+		bounds.maxX = math::clamp(scaleX * (viewCenter.x * depth + tangentX) * inverseDenominator, -1.0f, 1.0f);
+		bounds.minY = math::clamp(scaleY * (viewCenter.y * depth - tangentY) * inverseDenominator, -1.0f, 1.0f);
+		bounds.maxY = math::clamp(scaleY * (viewCenter.y * depth + tangentY) * inverseDenominator, -1.0f, 1.0f);
+		bounds.radius = scaleY * radius / std::sqrt(sqrDepthMinusRadius);
+		return bounds;
+	}
+
+	/// <summary>
+	/// LOD index of projected radius
+	/// lodThresholds should be sorted in descending order. Returned LOD is count of thresholds larger than projectedRadius,
+	/// so LOD 0 is for largest spheres and LOD lodThresholdCount is for smallest spheres
+	/// </summary>
+	[[nodiscard]] FORCE_INLINE unsigned int SelectLOD(float projectedRadius, const float* lodThresholds, size_t lodThresholdCount) noexcept
+	{
+		unsigned int lod = 0;
+		for (size_t thresholdIndex = 0; thresholdIndex < lodThresholdCount; ++thresholdIndex)
+		{
+			lod += (projectedRadius < lodThresholds[thresholdIndex]) ? 1u : 0u;
+		}
+		return lod;
+	}
+
+	/// <summary>
+	/// Project world space spheres to screen and select LOD of each sphere. 8 spheres are projected at once
+	/// Result is same with ComputeProjectedSphereBounds and SelectLOD of each sphere
+	/// </summary>
+	/// <param name="viewMatrix">world space to view space</param>
+	/// <param name="projectionMatrix">symmetric perspective matrix ( made by perspective, perspectiveFov )</param>
+	/// <param name="blocks">should have GetSphereBlockCount(sphereCount) blocks</param>
+	/// <param name="lodThresholds">projected radius thresholds sorted in descending order</param>
+	/// <param name="outLODs">should have at least sphereCount elements</param>
+	/// <param name="outBounds">nullable. should have GetSphereBlockCount(sphereCount) blocks</param>
+	inline void ComputeSphereLODs(const math::Matrix<4, 4, float>& viewMatrix, const math::Matrix<4, 4, float>& projectionMatrix, const SphereBlock8* blocks, size_t sphereCount, const float* lodThresholds, size_t lodThresholdCount, unsigned char* outLODs, ProjectedSphereBlock8* outBounds = nullptr) noexcept
+	{
+		assert(lodThresholdCount < 256);
+
+		size_t sphereIndex = 0;
+
+#ifdef SIMD_ENABLED
+		const float forwardSign = projectionMatrix.columns[2][3];
+		const M256F scaleX = _mm256_set1_ps(projectionMatrix.columns[0][0]);
+		const M256F scaleY = _mm256_set1_ps(projectionMatrix.columns[1][1]);
+		const M256F one = _mm256_set1_ps(1.0f);
+		const M256F negativeOne = _mm256_set1_ps(-1.0f);
+		const M256F infinity = _mm256_set1_ps(math::infinity<float>());
+		const M256F zero = _mm256_setzero_ps();
+
+		// rows of view matrix. forward sign is folded to row 2 to get depth directly
+		M256F viewRows[3][4];
+		for (size_t row = 0; row < 3; ++row)
+		{
+			const float rowScale = (row == 2) ? forwardSign : 1.0f;
+			for (size_t column = 0; column < 4; ++column)
+			{
+				viewRows[row][column] = _mm256_set1_ps(viewMatrix.columns[column][row] * rowScale);
+			}
+		}
+
+		for (; sphereIndex + 8 <= sphereCount; sphereIndex += 8)
+		{
+			const SphereBlock8& block = blocks[sphereIndex / 8];
+			const M256F worldX = _mm256_load_ps(block.centerX);
+			const M256F worldY = _mm256_load_ps(block.centerY);
+			const M256F worldZ = _mm256_load_ps(block.centerZ);
+			const M256F radius = _mm256_load_ps(block.radius);
+
+			M256F view[3];
+			for (size_t row = 0; row < 3; ++row)
+			{
+				view[row] = M256F_MUL_AND_ADD(viewRows[row][2], worldZ, M256F_MUL_AND_ADD(viewRows[row][1], worldY, M256F_MUL_AND_ADD(viewRows[row][0], worldX, viewRows[row][3])));
+			}
+			const M256F depth = view[2];
+
+			const M256F sqrDepthMinusRadius = M256F_SUB(M256F_MUL(depth, depth), M256F_MUL(radius, radius));
+			const M256F inverseDenominator = M256F_DIV(one, sqrDepthMinusRadius);
+			const M256F tangentX = M256F_MUL(radius, _mm256_sqrt_ps(M256F_MUL_AND_ADD(view[0], view[0], sqrDepthMinusRadius)));
+			const M256F tangentY = M256F_MUL(radius, _mm256_sqrt_ps(M256F_MUL_AND_ADD(view[1], view[1], sqrDepthMinusRadius)));
+			const M256F centerX = M256F_MUL(view[0], depth);
+			const M256F centerY = M256F_MUL(view[1], depth);
+			const M256F ndcScaleX = M256F_MUL(scaleX, inverseDenominator);
+			const M256F ndcScaleY = M256F_MUL(scaleY, inverseDenominator);
+
+			// sphere containing eye or crossing eye plane covers full screen. sphere behind eye covers nothing
+			const M256F isBehind = _mm256_cmp_ps(depth, M256F_SUB(zero, radius), _CMP_LT_OQ);
+			const M256F isFullScreen = _mm256_andnot_ps(isBehind, _mm256_cmp_ps(depth, radius, _CMP_LE_OQ));
+			const M256F projectedRadius = _mm256_blendv_ps(_mm256_blendv_ps(M256F_DIV(M256F_MUL(scaleY, radius), _mm256_sqrt_ps(sqrDepthMinusRadius)), infinity, isFullScreen), zero, isBehind);
+
+			M256F lod = _mm256_setzero_ps();
+			for (size_t thresholdIndex = 0; thresholdIndex < lodThresholdCount; ++thresholdIndex)
+			{
+				lod = M256F_ADD(lod, _mm256_and_ps(_mm256_cmp_ps(projectedRadius, _mm256_set1_ps(lodThresholds[thresholdIndex]), _CMP_LT_OQ), one));
+			}
+			alignas(32) int lods[8];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(lods), _mm256_cvttps_epi32(lod));
+			for (size_t lane = 0; lane < 8; ++lane)
+			{
+				outLODs[sphereIndex + lane] = static_cast<unsigned char>(lods[lane]);
+			}
+
+			if (outBounds != nullptr)
+			{
+				ProjectedSphereBlock8& bounds = outBounds[sphereIndex / 8];
+				const M256F minX = _mm256_blendv_ps(M256F_MUL(M256F_SUB(centerX, tangentX), ndcScaleX), negativeOne, isFullScreen);
+				const M256F maxX = _mm256_blendv_ps(M256F_MUL(M256F_ADD(centerX, tangentX), ndcScaleX), one, isFullScreen);
+				const M256F minY = _mm256_blendv_ps(M256F_MUL(M256F_SUB(centerY, tangentY), ndcScaleY), negativeOne, isFullScreen);
+				const M256F maxY = _mm256_blendv_ps(M256F_MUL(M256F_ADD(centerY, tangentY), ndcScaleY), one, isFullScreen);
+				_mm256_store_ps(bounds.minX, _mm256_blendv_ps(_mm256_min_ps(_mm256_max_ps(minX, negativeOne), one), zero, isBehind));
+				_mm256_store_ps(bounds.maxX, _mm256_blendv_ps(_mm256_min_ps(_mm256_max_ps(maxX, negativeOne), one), zero, isBehind));
+				_mm256_store_ps(bounds.minY, _mm256_blendv_ps(_mm256_min_ps(_mm256_max_ps(minY, negativeOne), one), zero, isBehind));
+				_mm256_store_ps(bounds.maxY, _mm256_blendv_ps(_mm256_min_ps(_mm256_max_ps(maxY, negativeOne), one), zero, isBehind));
+				_mm256_store_ps(bounds.radius, projectedRadius);
+			}
+		}
+#endif
+
+		for (; sphereIndex < sphereCount; ++sphereIndex)
+		{
+			const SphereBlock8& block = blocks[sphereIndex / 8];
+			const size_t lane = sphereIndex % 8;
+
+			math::Vector<3, float> viewCenter;
+			for (size_t row = 0; row < 3; ++row)
+			{
+				viewCenter[row] = viewMatrix.columns[0][row] * block.centerX[lane] + viewMatrix.columns[1][row] * block.centerY[lane] + viewMatrix.columns[2][row] * block.centerZ[lane] + viewMatrix.columns[3][row];
+			}
+
+			const ProjectedSphereBounds sphereBounds = ComputeProjectedSphereBounds(viewCenter, block.radius[lane], projectionMatrix);
+			outLODs[sphereIndex] = static_cast<unsigned char>(SelectLOD(sphereBounds.radius, lodThresholds, lodThresholdCount));
+
+			if (outBounds != nullptr)
+			{
+				ProjectedSphereBlock8& bounds = outBounds[sphereIndex / 8];
+				bounds.minX[lane] = sphereBounds.minX;
+				bounds.minY[lane] = sphereBounds.minY;
+				bounds.maxX[lane] = sphereBounds.maxX;
+				bounds.maxY[lane] = sphereBounds.maxY;
+				bounds.radius[lane] = sphereBounds.radius;
+			}
+		}
+	}
+}
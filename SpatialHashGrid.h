@@ -0,0 +1,370 @@
+#pragma once
+
+#include <vector>
+
+#include "LMath_Core.h"
+#include "Utility.h"
+#include "Vector3.h"
+#include "Collision.h"
+#include "Parallel.h"
+
+namespace math
+{
+	/// <summary>
+	/// Uniform grid of infinite size. Cells are mapped to fixed size hash table
+	///
+	/// Each item is stored in every cell its sphere's bounding box overlaps, so queries visit only cells overlapped by the query sphere.
+	/// Large item costs more entries at Build, but doesn't slow down queries around it.
+	/// cellSize should be about typical item diameter
+	/// Item found in several cells is reported only at the first cell of intersection of item and query bounds
+	///
+	/// Build is parallel counting sort of items by hash bucket.
+	/// Items of a bucket are stored continuously, so no memory is allocated per cell
+	///
+	/// reference : Optimized Spatial Hashing for Collision Detection of Deformable Objects, Teschner et al.
+	/// </summary>
+	class SpatialHashGrid
+	{
+	public:
+
+		/// <param name="hashTableSize">rounded up to power of two. When 0, twice of item count is used at Build</param>
+		explicit SpatialHashGrid(float cellSize, size_t hashTableSize = 0)
+			: mCellSize{ cellSize }, mInverseCellSize{ 1.0f / cellSize }, mRequestedHashTableSize{ hashTableSize }
+		{
+			assert(cellSize > 0.0f);
+		}
+
+		[[nodiscard]] FORCE_INLINE float GetCellSize() const noexcept
+		{
+			return mCellSize;
+		}
+
+		[[nodiscard]] FORCE_INLINE size_t GetItemCount() const noexcept
+		{
+			return mPositions.size();
+		}
+
+		/// <summary>
+		/// Count of ( item, cell ) entries. Item is counted once per cell it overlaps
+		/// </summary>
+		[[nodiscard]] FORCE_INLINE size_t GetEntryCount() const noexcept
+		{
+			return mSortedItemIndices.size();
+		}
+
+		[[nodiscard]] FORCE_INLINE math::Vector<3, int> ToCellCoordinate(const math::Vector<3, float>& position) const noexcept
+		{
+			return math::Vector<3, int>
+			{
+				static_cast<int>(std::floor(position.x * mInverseCellSize)),
+				static_cast<int>(std::floor(position.y * mInverseCellSize)),
+				static_cast<int>(std::floor(position.z * mInverseCellSize))
+			};
+		}
+
+		/// <summary>
+		/// Rebuild grid
+		/// Item index used in queries is index of positions
+		/// </summary>
+		/// <param name="radii">can be nullptr. then every item is treated as point</param>
+		/// <param name="threadCount">thread count used for counting sort</param>
+		void Build(const math::Vector<3, float>* positions, const float* radii, size_t itemCount, unsigned int threadCount = 1)
+		{
+			if (threadCount == 0)
+			{
+				threadCount = 1;
+			}
+
+			mPositions.assign(positions, positions + itemCount);
+			mRadii.resize(itemCount);
+			mItemMinimumCells.resize(itemCount);
+			mItemMaximumCells.resize(itemCount);
+
+			// 1. cell range and entry count of each item
+			std::vector<size_t> threadEntryCounts(threadCount, 0);
+			math::ParallelFor(itemCount, threadCount, [&](size_t begin, size_t end, unsigned int rangeIndex)
+			{
+				size_t entryCount = 0;
+				for (size_t itemIndex = begin; itemIndex < end; ++itemIndex)
+				{
+					const float radius = (radii != nullptr) ? radii[itemIndex] : 0.0f;
+					mRadii[itemIndex] = radius;
+					mItemMinimumCells[itemIndex] = ToCellCoordinate(positions[itemIndex] - radius);
+					mItemMaximumCells[itemIndex] = ToCellCoordinate(positions[itemIndex] + radius);
+
+					const math::Vector<3, int> cellCount = mItemMaximumCells[itemIndex] - mItemMinimumCells[itemIndex] + 1;
+					entryCount += static_cast<size_t>(cellCount.x) * static_cast<size_t>(cellCount.y) * static_cast<size_t>(cellCount.z);
+				}
+				threadEntryCounts[rangeIndex] = entryCount;
+			});
+
+			size_t entryCount = 0;
+			for (const size_t threadEntryCount : threadEntryCounts)
+			{
+				entryCount += threadEntryCount;
+			}
+
+			size_t hashTableSize = 1;
+			const size_t requiredHashTableSize = (mRequestedHashTableSize > 0) ? mRequestedHashTableSize : math::Max(entryCount * 2, static_cast<size_t>(1));
+			while (hashTableSize < requiredHashTableSize)
+			{
+				hashTableSize <<= 1;
+			}
+			mHashMask = static_cast<unsigned int>(hashTableSize - 1);
+
+			mBucketStart.assign(hashTableSize + 1, 0);
+			mSortedItemIndices.resize(entryCount);
+			mSortedCellCoordinates.resize(entryCount);
+
+			mThreadBucketOffsets.assign(static_cast<size_t>(threadCount) * hashTableSize, 0);
+
+			// 2. histogram per thread
+			math::ParallelFor(itemCount, threadCount, [&](size_t begin, size_t end, unsigned int rangeIndex)
+			{
+				unsigned int* histogram = mThreadBucketOffsets.data() + static_cast<size_t>(rangeIndex) * hashTableSize;
+				for (size_t itemIndex = begin; itemIndex < end; ++itemIndex)
+				{
+					ForEachItemCell(itemIndex, [&](const math::Vector<3, int>& cell)
+					{
+						++histogram[HashCellCoordinate(cell)];
+					});
+				}
+			});
+
+			// 3. exclusive prefix sum. Order is bucket first, then thread. So sort is stable
+			// buckets are split to per thread blocks. Each block reads histogram rows of its buckets continuously
+			// mBucketStart[bucket + 1] holds bucket's count, then its running offset, and ends as start of next bucket
+			std::vector<unsigned int> blockEntryCounts(threadCount, 0);
+			math::ParallelFor(hashTableSize, threadCount, [&](size_t begin, size_t end, unsigned int rangeIndex)
+			{
+				for (unsigned int threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+				{
+					const unsigned int* histogram = mThreadBucketOffsets.data() + static_cast<size_t>(threadIndex) * hashTableSize;
+					for (size_t bucket = begin; bucket < end; ++bucket)
+					{
+						mBucketStart[bucket + 1] += histogram[bucket];
+					}
+				}
+
+				unsigned int blockEntryCount = 0;
+				for (size_t bucket = begin; bucket < end; ++bucket)
+				{
+					blockEntryCount += mBucketStart[bucket + 1];
+				}
+				blockEntryCounts[rangeIndex] = blockEntryCount;
+			});
+
+			unsigned int blockOffset = 0;
+			for (unsigned int& blockEntryCount : blockEntryCounts)
+			{
+				const unsigned int count = blockEntryCount;
+				blockEntryCount = blockOffset;
+				blockOffset += count;
+			}
+
+			math::ParallelFor(hashTableSize, threadCount, [&](size_t begin, size_t end, unsigned int rangeIndex)
+			{
+				unsigned int offset = blockEntryCounts[rangeIndex];
+				for (size_t bucket = begin; bucket < end; ++bucket)
+				{
+					const unsigned int bucketCount = mBucketStart[bucket + 1];
+					mBucketStart[bucket + 1] = offset;
+					offset += bucketCount;
+				}
+
+				for (unsigned int threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+				{
+					unsigned int* bucketOffsets = mThreadBucketOffsets.data() + static_cast<size_t>(threadIndex) * hashTableSize;
+					for (size_t bucket = begin; bucket < end; ++bucket)
+					{
+						const unsigned int bucketCount = bucketOffsets[bucket];
+						bucketOffsets[bucket] = mBucketStart[bucket + 1];
+						mBucketStart[bucket + 1] += bucketCount;
+					}
+				}
+			});
+
+			// 4. scatter
+			math::ParallelFor(itemCount, threadCount, [&](size_t begin, size_t end, unsigned int rangeIndex)
+			{
+				unsigned int* bucketOffsets = mThreadBucketOffsets.data() + static_cast<size_t>(rangeIndex) * hashTableSize;
+				for (size_t itemIndex = begin; itemIndex < end; ++itemIndex)
+				{
+					ForEachItemCell(itemIndex, [&](const math::Vector<3, int>& cell)
+					{
+						const unsigned int sortedIndex = bucketOffsets[HashCellCoordinate(cell)]++;
+						mSortedItemIndices[sortedIndex] = static_cast<unsigned int>(itemIndex);
+						mSortedCellCoordinates[sortedIndex] = cell;
+					});
+				}
+			});
+		}
+
+		/// <summary>
+		/// Find items overlapped with a sphere
+		/// </summary>
+		/// <param name="outItemIndices">caller provided buffer</param>
+		/// <returns>count of found items. When it's larger than maxItemCount, only maxItemCount indices are written</returns>
+		size_t QueryRadius(const math::Vector<3, float>& center, float radius, unsigned int* outItemIndices, size_t maxItemCount) const
+		{
+			size_t itemCount = 0;
+			ForEachOverlappedItem(center, radius, [&](unsigned int itemIndex)
+			{
+				if (itemCount < maxItemCount)
+				{
+					outItemIndices[itemCount] = itemIndex;
+				}
+				++itemCount;
+			});
+			return itemCount;
+		}
+
+		/// <summary>
+		/// Batched version of QueryRadius. Queries are processed serially
+		/// Queries are independent and grid isn't modified, so caller can split queries to ranges and call this on different threads with different outPairs
+		/// </summary>
+		/// <param name="outPairs">indexA is index of query, indexB is index of item</param>
+		/// <returns>count of found pairs. When it's larger than maxPairCount, only maxPairCount pairs are written</returns>
+		size_t QueryRadius(const math::Vector<3, float>* centers, const float* radii, size_t queryCount, OverlapPair* outPairs, size_t maxPairCount) const
+		{
+			size_t pairCount = 0;
+			for (size_t queryIndex = 0; queryIndex < queryCount; ++queryIndex)
+			{
+				ForEachOverlappedItem(centers[queryIndex], radii[queryIndex], [&](unsigned int itemIndex)
+				{
+					detail::PushOverlapPair(outPairs, maxPairCount, pairCount, queryIndex, itemIndex);
+				});
+			}
+			return pairCount;
+		}
+
+		/// <summary>
+		/// Find every overlapped item pair in grid
+		/// Each pair is reported once and indexA is always smaller than indexB
+		/// </summary>
+		/// <returns>count of found pairs. When it's larger than maxPairCount, only maxPairCount pairs are written</returns>
+		size_t FindNeighbourPairs(OverlapPair* outPairs, size_t maxPairCount) const
+		{
+			size_t pairCount = 0;
+			const size_t itemCount = mPositions.size();
+			for (size_t itemIndexA = 0; itemIndexA < itemCount; ++itemIndexA)
+			{
+				ForEachOverlappedItem(mPositions[itemIndexA], mRadii[itemIndexA], [&](unsigned int itemIndexB)
+				{
+					if (itemIndexA < itemIndexB)
+					{
+						detail::PushOverlapPair(outPairs, maxPairCount, pairCount, itemIndexA, itemIndexB);
+					}
+				});
+			}
+			return pairCount;
+		}
+
+	private:
+
+		/// <summary>
+		/// Teschner et al. hash function
+		/// </summary>
+		[[nodiscard]] FORCE_INLINE unsigned int HashCellCoordinate(const math::Vector<3, int>& cellCoordinate) const noexcept
+		{
+			return (
+				(static_cast<unsigned int>(cellCoordinate.x) * 73856093u) ^
+				(static_cast<unsigned int>(cellCoordinate.y) * 19349663u) ^
+				(static_cast<unsigned int>(cellCoordinate.z) * 83492791u)
+				) & mHashMask;
+		}
+
+		/// <summary>
+		/// Call function(cell) for every cell overlapped by bounds of item
+		/// </summary>
+		template <typename Function>
+		FORCE_INLINE void ForEachItemCell(size_t itemIndex, const Function& function) const
+		{
+			const math::Vector<3, int>& minimumCell = mItemMinimumCells[itemIndex];
+			const math::Vector<3, int>& maximumCell = mItemMaximumCells[itemIndex];
+
+			math::Vector<3, int> cell;
+			for (cell.z = minimumCell.z; cell.z <= maximumCell.z; ++cell.z)
+			{
+				for (cell.y = minimumCell.y; cell.y <= maximumCell.y; ++cell.y)
+				{
+					for (cell.x = minimumCell.x; cell.x <= maximumCell.x; ++cell.x)
+					{
+						function(cell);
+					}
+				}
+			}
+		}
+
+		/// <summary>
+		/// Call function(itemIndex) once for every item overlapped with the sphere
+		/// Narrow phase is IsSphereOverlap
+		/// </summary>
+		template <typename Function>
+		void ForEachOverlappedItem(const math::Vector<3, float>& center, float radius, const Function& function) const
+		{
+			if (mSortedItemIndices.empty() == true)
+			{
+				return;
+			}
+
+			const math::Vector<3, int> minimumCell = ToCellCoordinate(center - radius);
+			const math::Vector<3, int> maximumCell = ToCellCoordinate(center + radius);
+
+			math::Vector<3, int> cell;
+			for (cell.z = minimumCell.z; cell.z <= maximumCell.z; ++cell.z)
+			{
+				for (cell.y = minimumCell.y; cell.y <= maximumCell.y; ++cell.y)
+				{
+					for (cell.x = minimumCell.x; cell.x <= maximumCell.x; ++cell.x)
+					{
+						const unsigned int hash = HashCellCoordinate(cell);
+						const unsigned int bucketEnd = mBucketStart[hash + 1];
+						for (unsigned int sortedIndex = mBucketStart[hash]; sortedIndex < bucketEnd; ++sortedIndex)
+						{
+							// different cells can share a bucket
+							if (mSortedCellCoordinates[sortedIndex] != cell)
+							{
+								continue;
+							}
+
+							// overlapped spheres have overlapped bounds. Report item only at first cell of the overlap, which both visit
+							const unsigned int itemIndex = mSortedItemIndices[sortedIndex];
+							const math::Vector<3, int>& itemMinimumCell = mItemMinimumCells[itemIndex];
+							const bool isFirstCell =
+								cell.x == math::Max(minimumCell.x, itemMinimumCell.x) &&
+								cell.y == math::Max(minimumCell.y, itemMinimumCell.y) &&
+								cell.z == math::Max(minimumCell.z, itemMinimumCell.z);
+							if (isFirstCell == true && math::IsSphereOverlap(center, radius, mPositions[itemIndex], mRadii[itemIndex]))
+							{
+								function(itemIndex);
+							}
+						}
+					}
+				}
+			}
+		}
+
+		float mCellSize;
+		float mInverseCellSize;
+		size_t mRequestedHashTableSize;
+		unsigned int mHashMask = 0;
+
+		/// <summary>
+		/// indexed by item index
+		/// </summary>
+		std::vector<math::Vector<3, float>> mPositions;
+		std::vector<float> mRadii;
+		std::vector<math::Vector<3, int>> mItemMinimumCells;
+		std::vector<math::Vector<3, int>> mItemMaximumCells;
+
+		std::vector<unsigned int> mThreadBucketOffsets;
+
+		/// <summary>
+		/// entries of bucket i is mBucketStart[i] ~ mBucketStart[i + 1] - 1 of sorted arrays
+		/// </summary>
+		std::vector<unsigned int> mBucketStart;
+		std::vector<unsigned int> mSortedItemIndices;
+		std::vector<math::Vector<3, int>> mSortedCellCoordinates;
+	};
+}
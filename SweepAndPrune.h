@@ -0,0 +1,454 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "LMath_Core.h"
+#include "Vector3.h"
+#include "Collision.h"
+
+#include "SIMD_Core.h"
+
+namespace math
+{
+	/// <summary>
+	/// Sweep and prune broadphase over AABBs
+	///
+	/// Bodies are sorted by minimum of sort axis with insertion sort.
+	/// Bodies move a little between frames, so sorted order of last frame is almost sorted and insertion sort is nearly O(n)
+	/// Bodies added since last Update are sorted separately and merged, so bulk add doesn't hit O(n^2) insertion sort
+	/// Sort axis is the axis having maximum variance of body centers, with hysteresis ( SORT_AXIS_CHANGE_VARIANCE_RATIO )
+	///
+	/// After Update, overlapped pairs and pairs added / removed compared with last Update can be read
+	/// OverlapPair::indexA is always smaller than OverlapPair::indexB
+	///
+	/// references :
+	/// http://www.codercorner.com/SAP.pdf
+	/// Real-Time Collision Detection, Christer Ericson, 7.5.2 Sort and Sweep
+	/// </summary>
+	class SweepAndPrune
+	{
+	public:
+
+		using BodyID = unsigned int;
+
+		inline static constexpr BodyID INVALID_BODY_ID = static_cast<BodyID>(-1);
+
+		/// <summary>
+		/// Sort axis is changed only when variance of new axis is larger than this times variance of current axis
+		/// Changing axis needs full sort, so axes with similar variance shouldn't flip every frame
+		/// </summary>
+		inline static constexpr double SORT_AXIS_CHANGE_VARIANCE_RATIO = 1.25;
+
+		SweepAndPrune() = default;
+
+		/// <returns>id of added body. Id of removed body can be reused after next Update</returns>
+		BodyID AddBody(const AABB& bounds)
+		{
+			BodyID bodyID;
+			if (mFreeBodyIDs.empty() == false)
+			{
+				bodyID = mFreeBodyIDs.back();
+				mFreeBodyIDs.pop_back();
+				mBodyBounds[bodyID] = bounds;
+				mIsBodyAlive[bodyID] = true;
+			}
+			else
+			{
+				bodyID = static_cast<BodyID>(mBodyBounds.size());
+				mBodyBounds.push_back(bounds);
+				mIsBodyAlive.push_back(true);
+			}
+
+			// New body is merged to proper position at next Update
+			mAddedEndPoints.push_back(EndPoint{ bounds.minimum[mSortAxis], bodyID });
+			++mAliveBodyCount;
+
+			return bodyID;
+		}
+
+		/// <summary>
+		/// Pairs of removed body will be reported as removed pair at next Update
+		/// </summary>
+		void RemoveBody(BodyID bodyID)
+		{
+			assert(bodyID < mBodyBounds.size() && mIsBodyAlive[bodyID] == true);
+
+			mIsBodyAlive[bodyID] = false;
+			mPendingFreeBodyIDs.push_back(bodyID);
+			--mAliveBodyCount;
+		}
+
+		FORCE_INLINE void UpdateBody(BodyID bodyID, const AABB& bounds)
+		{
+			assert(bodyID < mBodyBounds.size() && mIsBodyAlive[bodyID] == true);
+
+			mBodyBounds[bodyID] = bounds;
+		}
+
+		[[nodiscard]] FORCE_INLINE const AABB& GetBodyBounds(BodyID bodyID) const
+		{
+			return mBodyBounds[bodyID];
+		}
+
+		[[nodiscard]] FORCE_INLINE size_t GetBodyCount() const noexcept
+		{
+			return mAliveBodyCount;
+		}
+
+		/// <returns>0 : x, 1 : y, 2 : z</returns>
+		[[nodiscard]] FORCE_INLINE unsigned int GetSortAxis() const noexcept
+		{
+			return mSortAxis;
+		}
+
+		/// <summary>
+		/// Every overlapped pairs found at last Update. sorted by indexA, indexB
+		/// </summary>
+		[[nodiscard]] FORCE_INLINE const std::vector<OverlapPair>& GetOverlapPairs() const noexcept
+		{
+			return mOverlapPairs;
+		}
+
+		/// <summary>
+		/// Pairs which start overlapping at last Update
+		/// </summary>
+		[[nodiscard]] FORCE_INLINE const std::vector<OverlapPair>& GetAddedPairs() const noexcept
+		{
+			return mAddedPairs;
+		}
+
+		/// <summary>
+		/// Pairs which stop overlapping ( or one of body is removed ) at last Update
+		/// </summary>
+		[[nodiscard]] FORCE_INLINE const std::vector<OverlapPair>& GetRemovedPairs() const noexcept
+		{
+			return mRemovedPairs;
+		}
+
+		/// <summary>
+		/// Sort bodies, find overlapped pairs and build added / removed pair events
+		/// </summary>
+		void Update()
+		{
+			RemoveDeadEndPoints();
+			SortEndPoints();
+			GatherSortedBounds();
+			Sweep();
+			BuildPairEvents();
+
+			mFreeBodyIDs.insert(mFreeBodyIDs.end(), mPendingFreeBodyIDs.begin(), mPendingFreeBodyIDs.end());
+			mPendingFreeBodyIDs.clear();
+		}
+
+	private:
+
+		struct EndPoint
+		{
+			float value;
+			BodyID bodyID;
+		};
+
+		FORCE_INLINE static std::uint64_t MakePairKey(BodyID bodyIDA, BodyID bodyIDB) noexcept
+		{
+			return (bodyIDA < bodyIDB) ?
+				((static_cast<std::uint64_t>(bodyIDA) << 32) | bodyIDB) :
+				((static_cast<std::uint64_t>(bodyIDB) << 32) | bodyIDA);
+		}
+
+		FORCE_INLINE static OverlapPair PairKeyToOverlapPair(std::uint64_t pairKey) noexcept
+		{
+			return OverlapPair{ static_cast<unsigned int>(pairKey >> 32), static_cast<unsigned int>(pairKey & 0xFFFFFFFF) };
+		}
+
+		void RemoveDeadEndPoints()
+		{
+			if (mPendingFreeBodyIDs.empty() == false)
+			{
+				// remove_if is stable, so sorted order is kept
+				const auto isDead = [this](const EndPoint& endPoint) { return mIsBodyAlive[endPoint.bodyID] == false; };
+				mEndPoints.erase(std::remove_if(mEndPoints.begin(), mEndPoints.end(), isDead), mEndPoints.end());
+				mAddedEndPoints.erase(std::remove_if(mAddedEndPoints.begin(), mAddedEndPoints.end(), isDead), mAddedEndPoints.end());
+			}
+		}
+
+		void SortEndPoints()
+		{
+			const unsigned int sortAxis = mSortAxis;
+
+			const auto isLess = [](const EndPoint& a, const EndPoint& b) { return a.value < b.value; };
+
+			for (EndPoint& endPoint : mEndPoints)
+			{
+				endPoint.value = mBodyBounds[endPoint.bodyID].minimum[sortAxis];
+			}
+			for (EndPoint& endPoint : mAddedEndPoints)
+			{
+				endPoint.value = mBodyBounds[endPoint.bodyID].minimum[sortAxis];
+			}
+
+			if (mIsSortAxisChanged == true)
+			{
+				// order of last frame is useless for new axis
+				mEndPoints.insert(mEndPoints.end(), mAddedEndPoints.begin(), mAddedEndPoints.end());
+				mAddedEndPoints.clear();
+				std::sort(mEndPoints.begin(), mEndPoints.end(), isLess);
+				mIsSortAxisChanged = false;
+			}
+			else
+			{
+				// insertion sort. bodies move a little between frames, so this is almost O(n)
+				const size_t endPointCount = mEndPoints.size();
+				for (size_t i = 1; i < endPointCount; ++i)
+				{
+					const EndPoint endPoint = mEndPoints[i];
+					size_t j = i;
+					while (j > 0 && mEndPoints[j - 1].value > endPoint.value)
+					{
+						mEndPoints[j] = mEndPoints[j - 1];
+						--j;
+					}
+					mEndPoints[j] = endPoint;
+				}
+
+				// added bodies have no order of last frame. sort them and merge, O(n + k log k)
+				if (mAddedEndPoints.empty() == false)
+				{
+					std::sort(mAddedEndPoints.begin(), mAddedEndPoints.end(), isLess);
+					const size_t sortedEndPointCount = mEndPoints.size();
+					mEndPoints.insert(mEndPoints.end(), mAddedEndPoints.begin(), mAddedEndPoints.end());
+					mAddedEndPoints.clear();
+					std::inplace_merge(mEndPoints.begin(), mEndPoints.begin() + sortedEndPointCount, mEndPoints.end(), isLess);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Copy bounds to SoA arrays in sorted order for SIMD sweep
+		/// And choose sort axis of next Update
+		/// </summary>
+		void GatherSortedBounds()
+		{
+			const size_t endPointCount = mEndPoints.size();
+			for (std::vector<float>& sortedBounds : mSortedBounds)
+			{
+				sortedBounds.resize(endPointCount);
+			}
+
+			const unsigned int sortAxis = mSortAxis;
+			const unsigned int otherAxis1 = (sortAxis + 1) % 3;
+			const unsigned int otherAxis2 = (sortAxis + 2) % 3;
+
+			// centers are shifted by center of first body before accumulation, so variance doesn't lose precision at large world coordinates
+			double centerShift[3]{ 0.0, 0.0, 0.0 };
+			if (endPointCount > 0)
+			{
+				const AABB& firstBounds = mBodyBounds[mEndPoints[0].bodyID];
+				for (unsigned int axis = 0; axis < 3; ++axis)
+				{
+					centerShift[axis] = (static_cast<double>(firstBounds.minimum[axis]) + static_cast<double>(firstBounds.maximum[axis])) * 0.5;
+				}
+			}
+			double centerSum[3]{ 0.0, 0.0, 0.0 };
+			double centerSqrSum[3]{ 0.0, 0.0, 0.0 };
+
+			for (size_t i = 0; i < endPointCount; ++i)
+			{
+				const AABB& bounds = mBodyBounds[mEndPoints[i].bodyID];
+				mSortedBounds[SORT_AXIS_MIN][i] = bounds.minimum[sortAxis];
+				mSortedBounds[SORT_AXIS_MAX][i] = bounds.maximum[sortAxis];
+				mSortedBounds[OTHER_AXIS1_MIN][i] = bounds.minimum[otherAxis1];
+				mSortedBounds[OTHER_AXIS1_MAX][i] = bounds.maximum[otherAxis1];
+				mSortedBounds[OTHER_AXIS2_MIN][i] = bounds.minimum[otherAxis2];
+				mSortedBounds[OTHER_AXIS2_MAX][i] = bounds.maximum[otherAxis2];
+
+				for (unsigned int axis = 0; axis < 3; ++axis)
+				{
+					const double center = (static_cast<double>(bounds.minimum[axis]) + static_cast<double>(bounds.maximum[axis])) * 0.5 - centerShift[axis];
+					centerSum[axis] += center;
+					centerSqrSum[axis] += center * center;
+				}
+			}
+
+			if (endPointCount > 0)
+			{
+				// variance = E[X^2] - E[X]^2. shift doesn't change variance
+				double variances[3];
+				for (unsigned int axis = 0; axis < 3; ++axis)
+				{
+					const double mean = centerSum[axis] / static_cast<double>(endPointCount);
+					variances[axis] = centerSqrSum[axis] / static_cast<double>(endPointCount) - mean * mean;
+				}
+
+				unsigned int maxVarianceAxis = sortAxis;
+				for (unsigned int axis = 0; axis < 3; ++axis)
+				{
+					if (variances[axis] > variances[maxVarianceAxis])
+					{
+						maxVarianceAxis = axis;
+					}
+				}
+
+				if (maxVarianceAxis != sortAxis && variances[maxVarianceAxis] > variances[sortAxis] * SORT_AXIS_CHANGE_VARIANCE_RATIO)
+				{
+					mSortAxis = maxVarianceAxis;
+					mIsSortAxisChanged = true;
+				}
+			}
+		}
+
+		void Sweep()
+		{
+			mPairKeys.clear();
+
+			const size_t endPointCount = mEndPoints.size();
+			const float* sortAxisMin = mSortedBounds[SORT_AXIS_MIN].data();
+			const float* sortAxisMax = mSortedBounds[SORT_AXIS_MAX].data();
+			const float* otherAxis1Min = mSortedBounds[OTHER_AXIS1_MIN].data();
+			const float* otherAxis1Max = mSortedBounds[OTHER_AXIS1_MAX].data();
+			const float* otherAxis2Min = mSortedBounds[OTHER_AXIS2_MIN].data();
+			const float* otherAxis2Max = mSortedBounds[OTHER_AXIS2_MAX].data();
+
+			for (size_t i = 0; i < endPointCount; ++i)
+			{
+				const BodyID bodyID = mEndPoints[i].bodyID;
+				const float maxOfSortAxis = sortAxisMax[i];
+
+				size_t j = i + 1;
+				bool isSweepEnd = false;
+
+#ifdef SIMD_ENABLED
+				const M256F m256f_maxOfSortAxis = _mm256_set1_ps(maxOfSortAxis);
+				const M256F m256f_otherAxis1Min = _mm256_set1_ps(otherAxis1Min[i]);
+				const M256F m256f_otherAxis1Max = _mm256_set1_ps(otherAxis1Max[i]);
+				const M256F m256f_otherAxis2Min = _mm256_set1_ps(otherAxis2Min[i]);
+				const M256F m256f_otherAxis2Max = _mm256_set1_ps(otherAxis2Max[i]);
+
+				for (; j + 8 <= endPointCount; j += 8)
+				{
+					const M256F isInSweepRange = _mm256_cmp_ps(_mm256_loadu_ps(sortAxisMin + j), m256f_maxOfSortAxis, _CMP_LE_OQ);
+					const int sweepRangeMask = _mm256_movemask_ps(isInSweepRange);
+					if (sweepRangeMask != 0xFF)
+					{
+						// bodies are sorted, so every body after this can't overlap
+						isSweepEnd = true;
+					}
+					if (sweepRangeMask == 0)
+					{
+						break;
+					}
+
+					M256F isOverlap = _mm256_and_ps(isInSweepRange, _mm256_cmp_ps(_mm256_loadu_ps(otherAxis1Min + j), m256f_otherAxis1Max, _CMP_LE_OQ));
+					isOverlap = _mm256_and_ps(isOverlap, _mm256_cmp_ps(_mm256_loadu_ps(otherAxis1Max + j), m256f_otherAxis1Min, _CMP_GE_OQ));
+					isOverlap = _mm256_and_ps(isOverlap, _mm256_cmp_ps(_mm256_loadu_ps(otherAxis2Min + j), m256f_otherAxis2Max, _CMP_LE_OQ));
+					isOverlap = _mm256_and_ps(isOverlap, _mm256_cmp_ps(_mm256_loadu_ps(otherAxis2Max + j), m256f_otherAxis2Min, _CMP_GE_OQ));
+
+					unsigned int overlapMask = static_cast<unsigned int>(_mm256_movemask_ps(isOverlap));
+					while (overlapMask != 0)
+					{
+						const unsigned int lane = math::countTrailingZero(overlapMask);
+						overlapMask &= overlapMask - 1;
+						mPairKeys.push_back(MakePairKey(bodyID, mEndPoints[j + lane].bodyID));
+					}
+
+					if (isSweepEnd == true)
+					{
+						break;
+					}
+				}
+#endif
+
+				if (isSweepEnd == false)
+				{
+					for (; j < endPointCount && sortAxisMin[j] <= maxOfSortAxis; ++j)
+					{
+						if (
+							otherAxis1Min[j] <= otherAxis1Max[i] && otherAxis1Max[j] >= otherAxis1Min[i] &&
+							otherAxis2Min[j] <= otherAxis2Max[i] && otherAxis2Max[j] >= otherAxis2Min[i]
+							)
+						{
+							mPairKeys.push_back(MakePairKey(bodyID, mEndPoints[j].bodyID));
+						}
+					}
+				}
+			}
+
+			std::sort(mPairKeys.begin(), mPairKeys.end());
+		}
+
+		void BuildPairEvents()
+		{
+			mOverlapPairs.clear();
+			mAddedPairs.clear();
+			mRemovedPairs.clear();
+
+			mOverlapPairs.reserve(mPairKeys.size());
+			for (const std::uint64_t pairKey : mPairKeys)
+			{
+				mOverlapPairs.push_back(PairKeyToOverlapPair(pairKey));
+			}
+
+			// both are sorted. merge them
+			size_t currentIndex = 0;
+			size_t previousIndex = 0;
+			while (currentIndex < mPairKeys.size() || previousIndex < mPreviousPairKeys.size())
+			{
+				if (previousIndex == mPreviousPairKeys.size() || (currentIndex < mPairKeys.size() && mPairKeys[currentIndex] < mPreviousPairKeys[previousIndex]))
+				{
+					mAddedPairs.push_back(PairKeyToOverlapPair(mPairKeys[currentIndex]));
+					++currentIndex;
+				}
+				else if (currentIndex == mPairKeys.size() || mPreviousPairKeys[previousIndex] < mPairKeys[currentIndex])
+				{
+					mRemovedPairs.push_back(PairKeyToOverlapPair(mPreviousPairKeys[previousIndex]));
+					++previousIndex;
+				}
+				else
+				{
+					++currentIndex;
+					++previousIndex;
+				}
+			}
+
+			std::swap(mPairKeys, mPreviousPairKeys);
+		}
+
+		enum SortedBoundsIndex : unsigned int
+		{
+			SORT_AXIS_MIN = 0,
+			SORT_AXIS_MAX,
+			OTHER_AXIS1_MIN,
+			OTHER_AXIS1_MAX,
+			OTHER_AXIS2_MIN,
+			OTHER_AXIS2_MAX,
+			SORTED_BOUNDS_COUNT
+		};
+
+		std::vector<AABB> mBodyBounds;
+		std::vector<bool> mIsBodyAlive;
+		std::vector<BodyID> mFreeBodyIDs;
+		std::vector<BodyID> mPendingFreeBodyIDs;
+		size_t mAliveBodyCount = 0;
+
+		/// <summary>
+		/// minimum of sort axis of bodies. sorted
+		/// </summary>
+		std::vector<EndPoint> mEndPoints;
+		/// <summary>
+		/// bodies added after last Update. not sorted
+		/// </summary>
+		std::vector<EndPoint> mAddedEndPoints;
+		std::vector<float> mSortedBounds[SORTED_BOUNDS_COUNT];
+
+		unsigned int mSortAxis = 0;
+		bool mIsSortAxisChanged = false;
+
+		std::vector<std::uint64_t> mPairKeys;
+		std::vector<std::uint64_t> mPreviousPairKeys;
+
+		std::vector<OverlapPair> mOverlapPairs;
+		std::vector<OverlapPair> mAddedPairs;
+		std::vector<OverlapPair> mRemovedPairs;
+	};
+}
@@ -4,6 +4,10 @@
 
 #include "LMath_Core.h"
 
+#if defined(COMPILER_MSVC)
+#include <intrin.h>
+#endif
+
 namespace math
 {
 	inline constexpr float PI = 3.14159265358979323846f;
@@ -184,6 +188,34 @@ namespace math
 	{
 		return Equal(a, static_cast<double>(b));
 	}
+
+	/// <summary>
+	/// Return index of lowest set bit
+	/// value shouldn't be zero
+	/// </summary>
+	inline unsigned int countTrailingZero(unsigned int value)
+	{
+		assert(value != 0);
+#if defined(COMPILER_MSVC)
+		unsigned long index;
+		_BitScanForward(&index, value);
+		return static_cast<unsigned int>(index);
+#else
+		return static_cast<unsigned int>(__builtin_ctz(value));
+#endif
+	}
+
+	/// <summary>
+	/// Return count of set bits
+	/// </summary>
+	inline unsigned int countBits(unsigned int value)
+	{
+#if defined(COMPILER_MSVC)
+		return static_cast<unsigned int>(__popcnt(value));
+#else
+		return static_cast<unsigned int>(__builtin_popcount(value));
+#endif
+	}
 	/////
 
 
@@ -1,6 +1,8 @@
 #pragma once
 #include "Vector.h"
 
+#include "SIMD_Core.h"
+
 
 namespace math
 {
@@ -507,5 +509,65 @@ namespace math
 
 	using Vector3 = Vector<3, float>;
 
+#ifdef SIMD_ENABLED
+	namespace detail
+	{
+		/// <summary>
+		/// Load 8 points ( 24 floats ) and transpose them to x, y, z lanes
+		/// </summary>
+		FORCE_INLINE void LoadPoints8(const math::Vector<3, float>* points, M256F& outX, M256F& outY, M256F& outZ)
+		{
+			const float* data = &(points->x);
+
+			// x0 y0 z0 x1 | x4 y4 z4 x5
+			M256F m03 = _mm256_castps128_ps256(_mm_loadu_ps(data + 0));
+			// y1 z1 x2 y2 | y5 z5 x6 y6
+			M256F m14 = _mm256_castps128_ps256(_mm_loadu_ps(data + 4));
+			// z2 x3 y3 z3 | z6 x7 y7 z7
+			M256F m25 = _mm256_castps128_ps256(_mm_loadu_ps(data + 8));
+			m03 = _mm256_insertf128_ps(m03, _mm_loadu_ps(data + 12), 1);
+			m14 = _mm256_insertf128_ps(m14, _mm_loadu_ps(data + 16), 1);
+			m25 = _mm256_insertf128_ps(m25, _mm_loadu_ps(data + 20), 1);
+
+			// x2 y2 x3 y3
+			const M256F xy = _mm256_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2));
+			// y0 z0 y1 z1
+			const M256F yz = _mm256_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1));
+			outX = _mm256_shuffle_ps(m03, xy, _MM_SHUFFLE(2, 0, 3, 0));
+			outY = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+			outZ = _mm256_shuffle_ps(yz, m25, _MM_SHUFFLE(3, 0, 3, 1));
+		}
+
+		/// <summary>
+		/// Transpose x, y, z lanes to 8 points ( 24 floats ) and store them. Inverse of LoadPoints8
+		/// </summary>
+		FORCE_INLINE void StorePoints8(M256F x, M256F y, M256F z, math::Vector<3, float>* outPoints)
+		{
+			float* data = &(outPoints->x);
+
+			// x0 x2 y0 y2
+			const M256F xy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+			// y1 y3 z1 z3
+			const M256F yz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+			// z0 z2 x1 x3
+			const M256F zx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+
+			// x0 y0 z0 x1 | x4 y4 z4 x5
+			const M256F m03 = _mm256_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));
+			// y1 z1 x2 y2 | y5 z5 x6 y6
+			const M256F m14 = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+			// z2 x3 y3 z3 | z6 x7 y7 z7
+			const M256F m25 = _mm256_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));
+
+			_mm_storeu_ps(data + 0, _mm256_castps256_ps128(m03));
+			_mm_storeu_ps(data + 4, _mm256_castps256_ps128(m14));
+			_mm_storeu_ps(data + 8, _mm256_castps256_ps128(m25));
+			_mm_storeu_ps(data + 12, _mm256_extractf128_ps(m03, 1));
+			_mm_storeu_ps(data + 16, _mm256_extractf128_ps(m14, 1));
+			_mm_storeu_ps(data + 20, _mm256_extractf128_ps(m25, 1));
+		}
+	}
+#endif
+
 	extern template struct math::Vector<3, float>;
 }
\ No newline at end of file
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "LMath_Core.h"
+#include "Utility.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix4x4.h"
+
+#include "SIMD_Core.h"
+
+namespace math
+{
+	/// <summary>
+	/// Outcode bits of clip space vertex. Bit is set when vertex is outside of the plane
+	/// Triangle is trivially rejected when AND of its outcodes isn't 0 and trivially accepted when OR of its outcodes is 0
+	/// </summary>
+	inline constexpr unsigned char VERTEX_OUTCODE_LEFT = 1 << 0; // x < -w
+	inline constexpr unsigned char VERTEX_OUTCODE_RIGHT = 1 << 1; // x > w
+	inline constexpr unsigned char VERTEX_OUTCODE_BOTTOM = 1 << 2; // y < -w
+	inline constexpr unsigned char VERTEX_OUTCODE_TOP = 1 << 3; // y > w
+	inline constexpr unsigned char VERTEX_OUTCODE_NEAR = 1 << 4; // z < -w ( z < 0 when ClipRange::ZeroToOne )
+	inline constexpr unsigned char VERTEX_OUTCODE_FAR = 1 << 5; // z > w
+
+	/// <summary>
+	/// Output of TransformVertices stored as structure of arrays
+	/// Every non null array should have at least count elements. arrays don't need to be aligned
+	/// </summary>
+	struct TransformedVertexArraySoA
+	{
+		/// <summary>
+		/// nullable
+		/// </summary>
+		float* clipX;
+		float* clipY;
+		float* clipZ;
+		float* clipW;
+
+		/// <summary>
+		/// nullable
+		/// </summary>
+		float* ndcX;
+		float* ndcY;
+		float* ndcZ;
+
+		/// <summary>
+		/// window coordinate, same with project. Depth follows clip range of policy
+		/// </summary>
+		float* windowX;
+		float* windowY;
+		float* windowZ;
+
+		/// <summary>
+		/// 1 / clip w. Used for perspective correct interpolation
+		/// </summary>
+		float* inverseW;
+
+		unsigned char* outcodes;
+		size_t count;
+	};
+
+	/// <summary>
+	/// Vertex stage of software rasterizer
+	/// Transform positions to clip space, compute outcodes, divide by w and map NDC to viewport in one pass. 8 vertices are processed at once
+	///
+	/// Vertex behind eye ( clip w <= 0 ) of perspective projection always has VERTEX_OUTCODE_NEAR,
+	/// its NDC and window coordinate are meaningless and triangles using it should be clipped in clip space
+	/// Near plane and depth range follow clip range of Policy
+	/// </summary>
+	/// <param name="mvp">model-view-projection matrix</param>
+	/// <param name="viewport">x, y, width, height. same with project</param>
+	/// <param name="positions">should have at least outVertices.count elements</param>
+	template<typename Policy = CurrentClipSpace, std::enable_if_t<CHECK_IS_CLIP_SPACE_POLICY(Policy), bool> = true>
+	inline void TransformVertices(const math::Matrix<4, 4, float>& mvp, const math::Vector<4, float>& viewport, const math::Vector<3, float>* positions, const TransformedVertexArraySoA& outVertices) noexcept
+	{
+		constexpr bool isZeroToOne = (Policy::clipRange == ClipRange::ZeroToOne);
+		constexpr float nearClipScale = isZeroToOne ? 0.0f : -1.0f;
+		constexpr float depthScale = isZeroToOne ? 1.0f : 0.5f;
+		constexpr float depthOffset = isZeroToOne ? 0.0f : 0.5f;
+		// ndc -> window
+		const float windowScale[3]{ viewport[2] * 0.5f, viewport[3] * 0.5f, depthScale };
+		const float windowOffset[3]{ viewport[0] + viewport[2] * 0.5f, viewport[1] + viewport[3] * 0.5f, depthOffset };
+
+		float* const clip[4]{ outVertices.clipX, outVertices.clipY, outVertices.clipZ, outVertices.clipW };
+		float* const ndc[3]{ outVertices.ndcX, outVertices.ndcY, outVertices.ndcZ };
+		float* const window[3]{ outVertices.windowX, outVertices.windowY, outVertices.windowZ };
+
+		size_t vertexIndex = 0;
+
+#ifdef SIMD_ENABLED
+		M256F elements[4][4];
+		for (size_t column = 0; column < 4; ++column)
+		{
+			for (size_t row = 0; row < 4; ++row)
+			{
+				elements[column][row] = _mm256_set1_ps(mvp.columns[column][row]);
+			}
+		}
+		const M256F one = _mm256_set1_ps(1.0f);
+		const M256F zero = _mm256_setzero_ps();
+		const M256F m256f_nearClipScale = _mm256_set1_ps(nearClipScale);
+		const M256F scale[3]{ _mm256_set1_ps(windowScale[0]), _mm256_set1_ps(windowScale[1]), _mm256_set1_ps(windowScale[2]) };
+		const M256F offset[3]{ _mm256_set1_ps(windowOffset[0]), _mm256_set1_ps(windowOffset[1]), _mm256_set1_ps(windowOffset[2]) };
+		M256F outcodeBits[6];
+		for (size_t planeIndex = 0; planeIndex < 6; ++planeIndex)
+		{
+			outcodeBits[planeIndex] = _mm256_castsi256_ps(_mm256_set1_epi32(1 << planeIndex));
+		}
+
+		for (; vertexIndex + 8 <= outVertices.count; vertexIndex += 8)
+		{
+			M256F x, y, z;
+			detail::LoadPoints8(positions + vertexIndex, x, y, z);
+
+			M256F clipPosition[4];
+			for (size_t row = 0; row < 4; ++row)
+			{
+				clipPosition[row] = M256F_MUL_AND_ADD(elements[2][row], z, M256F_MUL_AND_ADD(elements[1][row], y, M256F_MUL_AND_ADD(elements[0][row], x, elements[3][row])));
+				if (clip[row] != nullptr)
+				{
+					_mm256_storeu_ps(clip[row] + vertexIndex, clipPosition[row]);
+				}
+			}
+
+			const M256F w = clipPosition[3];
+			const M256F negativeW = M256F_SUB(zero, w);
+			const M256F isOutside[6]{
+				_mm256_cmp_ps(clipPosition[0], negativeW, _CMP_LT_OQ),
+				_mm256_cmp_ps(clipPosition[0], w, _CMP_GT_OQ),
+				_mm256_cmp_ps(clipPosition[1], negativeW, _CMP_LT_OQ),
+				_mm256_cmp_ps(clipPosition[1], w, _CMP_GT_OQ),
+				_mm256_cmp_ps(clipPosition[2], M256F_MUL(m256f_nearClipScale, w), _CMP_LT_OQ),
+				_mm256_cmp_ps(clipPosition[2], w, _CMP_GT_OQ) };
+			M256F outcode = zero;
+			for (size_t planeIndex = 0; planeIndex < 6; ++planeIndex)
+			{
+				outcode = _mm256_or_ps(outcode, _mm256_and_ps(isOutside[planeIndex], outcodeBits[planeIndex]));
+			}
+			alignas(32) int laneOutcodes[8];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(laneOutcodes), _mm256_castps_si256(outcode));
+			for (size_t lane = 0; lane < 8; ++lane)
+			{
+				outVertices.outcodes[vertexIndex + lane] = static_cast<unsigned char>(laneOutcodes[lane]);
+			}
+
+			const M256F inverseW = M256F_DIV(one, w);
+			_mm256_storeu_ps(outVertices.inverseW + vertexIndex, inverseW);
+
+			for (size_t component = 0; component < 3; ++component)
+			{
+				const M256F ndcPosition = M256F_MUL(clipPosition[component], inverseW);
+				if (ndc[component] != nullptr)
+				{
+					_mm256_storeu_ps(ndc[component] + vertexIndex, ndcPosition);
+				}
+				_mm256_storeu_ps(window[component] + vertexIndex, M256F_MUL_AND_ADD(ndcPosition, scale[component], offset[component]));
+			}
+		}
+#endif
+
+		for (; vertexIndex < outVertices.count; ++vertexIndex)
+		{
+			const math::Vector<3, float>& position = positions[vertexIndex];
+			float clipPosition[4];
+			for (size_t row = 0; row < 4; ++row)
+			{
+				clipPosition[row] = mvp.columns[0][row] * position.x + mvp.columns[1][row] * position.y + mvp.columns[2][row] * position.z + mvp.columns[3][row];
+				if (clip[row] != nullptr)
+				{
+					clip[row][vertexIndex] = clipPosition[row];
+				}
+			}
+			const float w = clipPosition[3];
+
+			unsigned char outcode = 0;
+			outcode |= (clipPosition[0] < -w) ? VERTEX_OUTCODE_LEFT : 0;
+			outcode |= (clipPosition[0] > w) ? VERTEX_OUTCODE_RIGHT : 0;
+			outcode |= (clipPosition[1] < -w) ? VERTEX_OUTCODE_BOTTOM : 0;
+			outcode |= (clipPosition[1] > w) ? VERTEX_OUTCODE_TOP : 0;
+			outcode |= (clipPosition[2] < nearClipScale * w) ? VERTEX_OUTCODE_NEAR : 0;
+			outcode |= (clipPosition[2] > w) ? VERTEX_OUTCODE_FAR : 0;
+			outVertices.outcodes[vertexIndex] = outcode;
+
+			const float inverseW = 1.0f / w;
+			outVertices.inverseW[vertexIndex] = inverseW;
+
+			for (size_t component = 0; component < 3; ++component)
+			{
+				const float ndcPosition = clipPosition[component] * inverseW;
+				if (ndc[component] != nullptr)
+				{
+					ndc[component][vertexIndex] = ndcPosition;
+				}
+				window[component][vertexIndex] = ndcPosition * windowScale[component] + windowOffset[component];
+			}
+		}
+	}
+}
@@ -9,6 +9,23 @@
 
 #include "../Quaternion.h"
 
+#include "../Ray.h"
+#include "../BVH.h"
+#include "../SweepAndPrune.h"
+#include "../ScreenSpaceBounds.h"
+#include "../OcclusionCulling.h"
+#include "../SpatialHashGrid.h"
+#include "../OBB.h"
+#include "../GJK.h"
+#include "../ContinuousCollision.h"
+#include "../BoundingVolume.h"
+#include "../Culling.h"
+
+#include <cmath>
+#include <random>
+#include <set>
+#include <utility>
+
 #include <thread>
 #include <mutex>
 
@@ -25,8 +42,1002 @@ void print(int i)
 }
 
 
+/// <summary>
+/// Ray missing every box with infinite max distance should hit nothing
+/// </summary>
+void TestRayMissWithInfiniteDistance()
+{
+	float minX[8], minY[8], minZ[8], maxX[8], maxY[8], maxZ[8];
+	math::AABB bounds[8];
+	for (size_t boxIndex = 0; boxIndex < 8; ++boxIndex)
+	{
+		// boxes above ray along x axis
+		minX[boxIndex] = static_cast<float>(boxIndex) * 2.0f;
+		minY[boxIndex] = 1.0f;
+		minZ[boxIndex] = -1.0f;
+		maxX[boxIndex] = minX[boxIndex] + 1.0f;
+		maxY[boxIndex] = 2.0f;
+		maxZ[boxIndex] = 1.0f;
+		bounds[boxIndex] = math::AABB{ math::Vector<3, float>{ minX[boxIndex], minY[boxIndex], minZ[boxIndex] }, math::Vector<3, float>{ maxX[boxIndex], maxY[boxIndex], maxZ[boxIndex] } };
+	}
+	const math::AABBArraySoA boxes{ minX, minY, minZ, maxX, maxY, maxZ, 8 };
+	const math::Ray ray{ math::Vector<3, float>{ -1.0f, 0.0f, 0.0f }, math::Vector<3, float>{ 1.0f, 0.0f, 0.0f } };
+	const float maxDistance = math::infinity<float>();
+
+	unsigned int boxIndices[8];
+	assert(math::FindRayAABBHits(ray, maxDistance, boxes, boxIndices, 8) == 0);
+	assert(math::FindClosestRayAABBHit(ray, maxDistance, boxes) == math::RAY_INVALID_INDEX);
+
+	const math::Ray rays[1]{ ray };
+	const math::RayPacket8 rayPacket{ rays, 1, maxDistance };
+	assert(math::TestRayPacketWithAABB(rayPacket, bounds[0]) == 0);
+
+	math::BVH bvh;
+	bvh.Build(bounds, 8);
+	math::OverlapPair pairs[8];
+	assert(bvh.QueryRay(ray, maxDistance, boxIndices, 8) == 0);
+	assert(bvh.QueryRay(ray.origin, ray.direction, maxDistance, boxIndices, 8) == 0);
+	assert(bvh.QueryClosestRay(ray, maxDistance) == math::BVH_INVALID_INDEX);
+	assert(bvh.QueryRayPacket(rayPacket, pairs, 8) == 0);
+}
+
+std::set<std::pair<unsigned int, unsigned int>> ToPairSet(const std::vector<math::OverlapPair>& pairs)
+{
+	std::set<std::pair<unsigned int, unsigned int>> pairSet;
+	for (const math::OverlapPair& pair : pairs)
+	{
+		pairSet.insert(std::make_pair(pair.indexA, pair.indexB));
+	}
+	return pairSet;
+}
+
+/// <summary>
+/// Overlap pairs and added / removed events of sweep and prune should match brute force over frames with moving, bulk added and removed bodies
+/// </summary>
+void TestSweepAndPruneEvents()
+{
+	std::mt19937 random{ 27 };
+	std::uniform_real_distribution<float> position{ -50.0f, 50.0f };
+	std::uniform_real_distribution<float> size{ 0.5f, 4.0f };
+	std::uniform_real_distribution<float> move{ -1.0f, 1.0f };
+
+	const auto makeBounds = [&](const math::Vector<3, float>& center)
+	{
+		const math::Vector<3, float> extents{ size(random), size(random), size(random) };
+		return math::AABB{ center - extents, center + extents };
+	};
+
+	math::SweepAndPrune sweepAndPrune;
+	std::vector<math::SweepAndPrune::BodyID> aliveBodyIDs;
+	std::set<std::pair<unsigned int, unsigned int>> previousPairs;
+
+	for (size_t frame = 0; frame < 8; ++frame)
+	{
+		// bulk add, move and remove bodies
+		const size_t addCount = (frame == 0) ? 2000 : 150;
+		for (size_t i = 0; i < addCount; ++i)
+		{
+			aliveBodyIDs.push_back(sweepAndPrune.AddBody(makeBounds(math::Vector<3, float>{ position(random), position(random), position(random) })));
+		}
+		for (const math::SweepAndPrune::BodyID bodyID : aliveBodyIDs)
+		{
+			const math::AABB& bounds = sweepAndPrune.GetBodyBounds(bodyID);
+			const math::Vector<3, float> offset{ move(random), move(random), move(random) };
+			sweepAndPrune.UpdateBody(bodyID, math::AABB{ bounds.minimum + offset, bounds.maximum + offset });
+		}
+		for (size_t i = 0; i < 100 && frame > 0; ++i)
+		{
+			const size_t removeIndex = random() % aliveBodyIDs.size();
+			sweepAndPrune.RemoveBody(aliveBodyIDs[removeIndex]);
+			aliveBodyIDs[removeIndex] = aliveBodyIDs.back();
+			aliveBodyIDs.pop_back();
+		}
+
+		sweepAndPrune.Update();
+
+		std::set<std::pair<unsigned int, unsigned int>> pairs;
+		for (size_t i = 0; i < aliveBodyIDs.size(); ++i)
+		{
+			for (size_t j = i + 1; j < aliveBodyIDs.size(); ++j)
+			{
+				if (math::IsAABBOverlap(sweepAndPrune.GetBodyBounds(aliveBodyIDs[i]), sweepAndPrune.GetBodyBounds(aliveBodyIDs[j])) == true)
+				{
+					pairs.insert(std::make_pair(math::Min(aliveBodyIDs[i], aliveBodyIDs[j]), math::Max(aliveBodyIDs[i], aliveBodyIDs[j])));
+				}
+			}
+		}
+
+		std::set<std::pair<unsigned int, unsigned int>> addedPairs;
+		std::set<std::pair<unsigned int, unsigned int>> removedPairs;
+		for (const std::pair<unsigned int, unsigned int>& pair : pairs)
+		{
+			if (previousPairs.count(pair) == 0)
+			{
+				addedPairs.insert(pair);
+			}
+		}
+		for (const std::pair<unsigned int, unsigned int>& pair : previousPairs)
+		{
+			if (pairs.count(pair) == 0)
+			{
+				removedPairs.insert(pair);
+			}
+		}
+
+		assert(sweepAndPrune.GetBodyCount() == aliveBodyIDs.size());
+		assert(sweepAndPrune.GetOverlapPairs().size() == pairs.size() && ToPairSet(sweepAndPrune.GetOverlapPairs()) == pairs);
+		assert(sweepAndPrune.GetAddedPairs().size() == addedPairs.size() && ToPairSet(sweepAndPrune.GetAddedPairs()) == addedPairs);
+		assert(sweepAndPrune.GetRemovedPairs().size() == removedPairs.size() && ToPairSet(sweepAndPrune.GetRemovedPairs()) == removedPairs);
+
+		previousPairs = pairs;
+	}
+}
+
+/// <summary>
+/// Sphere behind eye should have empty rect and coarsest LOD, sphere crossing eye plane should cover full screen
+/// SIMD blocks and scalar tail should agree
+/// </summary>
+void TestProjectedSphereBehindEye()
+{
+	const math::Matrix<4, 4, float> projectionMatrix = math::perspectiveRH_NO(1.0f, 1.5f, 0.5f, 100.0f);
+	const float lodThresholds[2]{ 0.2f, 0.05f };
+
+	const math::ProjectedSphereBounds behindBounds = math::ComputeProjectedSphereBounds(math::Vector<3, float>{ 0.0f, 0.0f, 50.0f }, 1.0f, projectionMatrix);
+	assert(behindBounds.radius == 0.0f && behindBounds.GetScreenCoverage() == 0.0f);
+	assert(math::ComputeProjectedSphereBounds(math::Vector<3, float>{ 0.0f, 0.0f, 0.5f }, 1.0f, projectionMatrix).radius == math::infinity<float>());
+
+	// behind, in front, crossing eye plane
+	const float viewZ[3]{ 50.0f, -20.0f, 0.3f };
+	const unsigned char expectedLODs[3]{ 2, 1, 0 };
+	const size_t sphereCount = 13;
+	math::SphereBlock8 blocks[2];
+	for (size_t sphereIndex = 0; sphereIndex < 16; ++sphereIndex)
+	{
+		blocks[sphereIndex / 8].SetSphere(sphereIndex % 8, math::Vector<3, float>{ 0.0f, 0.0f, viewZ[sphereIndex % 3] }, 1.0f);
+	}
+
+	unsigned char lods[sphereCount];
+	math::ProjectedSphereBlock8 bounds[2];
+	math::ComputeSphereLODs(math::Matrix<4, 4, float>(1.0f), projectionMatrix, blocks, sphereCount, lodThresholds, 2, lods, bounds);
+	for (size_t sphereIndex = 0; sphereIndex < sphereCount; ++sphereIndex)
+	{
+		assert(lods[sphereIndex] == expectedLODs[sphereIndex % 3]);
+		if (sphereIndex % 3 == 0)
+		{
+			const math::ProjectedSphereBlock8& block = bounds[sphereIndex / 8];
+			const size_t lane = sphereIndex % 8;
+			assert(block.radius[lane] == 0.0f && block.minX[lane] == block.maxX[lane] && block.minY[lane] == block.maxY[lane]);
+		}
+	}
+}
+
+/// <summary>
+/// Large occluder extending behind camera should be clipped at near plane and still occlude
+/// </summary>
+void TestOccluderCrossingNearPlane()
+{
+	const float yaw = 0.26f;
+	const math::Matrix<4, 4, float> viewProjectionMatrix =
+		math::perspectiveRH_NO(1.2f, 1.6f, 0.5f, 1000.0f) *
+		math::lookAtRH(math::Vector<3, float>{ 0.0f, 0.0f, 0.0f }, math::Vector<3, float>{ std::sin(yaw), 0.0f, -std::cos(yaw) }, math::Vector<3, float>{ 0.0f, 1.0f, 0.0f });
+
+	// left side of wall is behind camera
+	const math::Vector<3, float> wall[4]{ { -200.0f, -200.0f, -33.0f }, { 200.0f, -200.0f, -33.0f }, { 200.0f, 200.0f, -33.0f }, { -200.0f, 200.0f, -33.0f } };
+	const unsigned int indices[6]{ 0, 1, 2, 0, 2, 3 };
+	assert((viewProjectionMatrix * math::Vector<4, float>{ wall[0].x, wall[0].y, wall[0].z, 1.0f }).w < 0.0f);
+
+	math::OcclusionBuffer occlusionBuffer{ 256, 160, 2 };
+	occlusionBuffer.Clear();
+	occlusionBuffer.AddOccluder(wall, 4, indices, 2, viewProjectionMatrix);
+	occlusionBuffer.Rasterize();
+
+	for (const float depth : occlusionBuffer.GetDepthBuffer())
+	{
+		assert(depth > 0.0f);
+	}
+	assert(occlusionBuffer.TestAABB(math::AABB{ math::Vector<3, float>{ -3.0f, -3.0f, -60.0f }, math::Vector<3, float>{ 3.0f, 3.0f, -50.0f } }, viewProjectionMatrix) == false);
+	assert(occlusionBuffer.TestAABB(math::AABB{ math::Vector<3, float>{ -3.0f, -3.0f, -20.0f }, math::Vector<3, float>{ 3.0f, 3.0f, -10.0f } }, viewProjectionMatrix) == true);
+}
+
+std::vector<math::AABB> MakeRandomAABBs(std::mt19937& random, size_t count, float positionRange, float maxExtent)
+{
+	std::uniform_real_distribution<float> position{ -positionRange, positionRange };
+	std::uniform_real_distribution<float> extent{ 0.1f, maxExtent };
+
+	std::vector<math::AABB> bounds(count);
+	for (math::AABB& aabb : bounds)
+	{
+		const math::Vector<3, float> center{ position(random), position(random), position(random) };
+		const math::Vector<3, float> extents{ extent(random), extent(random), extent(random) };
+		aabb = math::AABB{ center - extents, center + extents };
+	}
+	return bounds;
+}
+
+math::Quaternion MakeRandomRotation(std::mt19937& random)
+{
+	std::normal_distribution<float> component{ 0.0f, 1.0f };
+	const float x = component(random);
+	const float y = component(random);
+	const float z = component(random);
+	const float w = component(random);
+	const float length = std::sqrt(x * x + y * y + z * z + w * w);
+	return math::Quaternion{ x / length, y / length, z / length, w / length };
+}
+
+std::set<unsigned int> ToIndexSet(const unsigned int* indices, size_t count)
+{
+	return std::set<unsigned int>(indices, indices + count);
+}
+
+float GetDistanceToAABB(const math::Vector<3, float>& point, const math::AABB& aabb)
+{
+	const math::Vector<3, float> closestPoint = math::Min(math::Max(point, aabb.minimum), aabb.maximum);
+	return std::sqrt((closestPoint - point).sqrMagnitude());
+}
+
+/// <summary>
+/// Every primitive should be in one leaf, and queries should find same primitives as linear scan
+/// </summary>
+void CheckBVHQueries(const math::BVH& bvh, const std::vector<math::AABB>& bounds, std::mt19937& random)
+{
+	std::uniform_real_distribution<float> position{ -100.0f, 100.0f };
+	std::uniform_real_distribution<float> direction{ -1.0f, 1.0f };
+	const size_t primitiveCount = bounds.size();
+
+	std::vector<unsigned int> leafCounts(primitiveCount, 0);
+	bvh.Traverse([](const math::BVHNode& node) { return node.GetValidChildMask(); }, [&](unsigned int primitiveIndex) { ++leafCounts[primitiveIndex]; });
+	for (const unsigned int leafCount : leafCounts)
+	{
+		assert(leafCount == 1);
+	}
+
+	std::vector<unsigned int> primitiveIndices(primitiveCount);
+	for (size_t queryIndex = 0; queryIndex < 8; ++queryIndex)
+	{
+		const math::Vector<3, float> center{ position(random), position(random), position(random) };
+		const float radius = 25.0f;
+		const math::AABB queryBounds{ center - radius, center + radius };
+		const math::Ray ray{ center, math::Vector<3, float>{ direction(random), direction(random), direction(random) } };
+		const float maxDistance = 150.0f;
+
+		std::set<unsigned int> aabbHits;
+		std::set<unsigned int> sphereHits;
+		std::set<unsigned int> rayHits;
+		float closestDistance = math::infinity<float>();
+		for (unsigned int primitiveIndex = 0; primitiveIndex < primitiveCount; ++primitiveIndex)
+		{
+			const math::AABB& aabb = bounds[primitiveIndex];
+			if (math::IsAABBOverlap(aabb, queryBounds) == true)
+			{
+				aabbHits.insert(primitiveIndex);
+			}
+			if (math::BVH::IsAABBOverlapWithSphere(aabb, center, radius) == true)
+			{
+				sphereHits.insert(primitiveIndex);
+			}
+			float distance;
+			if (math::IsRayHitAABB(ray, maxDistance, aabb, &distance) == true)
+			{
+				rayHits.insert(primitiveIndex);
+				closestDistance = math::Min(closestDistance, distance);
+			}
+		}
+
+		size_t hitCount = bvh.QueryAABB(queryBounds, primitiveIndices.data(), primitiveCount);
+		assert(hitCount == aabbHits.size() && ToIndexSet(primitiveIndices.data(), hitCount) == aabbHits);
+		hitCount = bvh.QuerySphere(center, radius, primitiveIndices.data(), primitiveCount);
+		assert(hitCount == sphereHits.size() && ToIndexSet(primitiveIndices.data(), hitCount) == sphereHits);
+		hitCount = bvh.QueryRay(ray, maxDistance, primitiveIndices.data(), primitiveCount);
+		assert(hitCount == rayHits.size() && ToIndexSet(primitiveIndices.data(), hitCount) == rayHits);
+
+		float distance;
+		const unsigned int closestPrimitiveIndex = bvh.QueryClosestRay(ray, maxDistance, &distance);
+		assert((closestPrimitiveIndex == math::BVH_INVALID_INDEX) == rayHits.empty());
+		assert(rayHits.empty() == true || (rayHits.count(closestPrimitiveIndex) == 1 && distance == closestDistance));
+	}
+}
+
+/// <summary>
+/// BVH queries should match linear scan after Build with any thread count, after Refit with and without rotations,
+/// and after rebuild caused by SAH cost drift
+/// </summary>
+void TestBVHMatchesLinearScan()
+{
+	std::mt19937 random{ 29 };
+	std::uniform_real_distribution<float> velocity{ -3.0f, 3.0f };
+
+	std::vector<math::AABB> bounds = MakeRandomAABBs(random, 5003, 100.0f, 4.0f);
+	// duplicated primitives can't be split by position
+	for (size_t primitiveIndex = 0; primitiveIndex < 40; ++primitiveIndex)
+	{
+		bounds[primitiveIndex] = math::AABB{ math::Vector<3, float>{ 1.0f, 1.0f, 1.0f }, math::Vector<3, float>{ 2.0f, 2.0f, 2.0f } };
+	}
+
+	for (const unsigned int threadCount : { 1u, 4u })
+	{
+		math::BVH bvh;
+		bvh.Build(bounds.data(), bounds.size(), threadCount);
+		CheckBVHQueries(bvh, bounds, random);
+	}
+
+	std::vector<math::Vector<3, float>> velocities(bounds.size());
+	for (math::Vector<3, float>& primitiveVelocity : velocities)
+	{
+		primitiveVelocity = math::Vector<3, float>{ velocity(random), velocity(random), velocity(random) };
+	}
+
+	for (const bool rotate : { false, true })
+	{
+		std::vector<math::AABB> movedBounds = bounds;
+		math::BVH bvh;
+		bvh.Build(movedBounds.data(), movedBounds.size());
+		for (size_t frame = 0; frame < 12; ++frame)
+		{
+			// a third of primitives move each frame
+			for (size_t primitiveIndex = frame % 3; primitiveIndex < movedBounds.size(); primitiveIndex += 3)
+			{
+				movedBounds[primitiveIndex].minimum += velocities[primitiveIndex];
+				movedBounds[primitiveIndex].maximum += velocities[primitiveIndex];
+			}
+			bvh.Refit(movedBounds.data(), movedBounds.size(), rotate);
+			CheckBVHQueries(bvh, movedBounds, random);
+		}
+	}
+
+	// scattering every primitive makes leaves huge, so SAH cost drifts over ratio and tree is rebuilt
+	math::BVH bvh;
+	bvh.Build(bounds.data(), bounds.size());
+	const std::vector<math::AABB> scatteredBounds = MakeRandomAABBs(random, bounds.size(), 100.0f, 4.0f);
+	assert(bvh.Refit(scatteredBounds.data(), scatteredBounds.size()) == true);
+	assert(bvh.GetSAHCost() == bvh.GetBuildSAHCost());
+	CheckBVHQueries(bvh, scatteredBounds, random);
+}
+
+/// <summary>
+/// Items spanning several cells should be reported once per pair and per query, with any thread count and with colliding hash buckets
+/// </summary>
+void TestSpatialHashGridMatchesBruteForce()
+{
+	std::mt19937 random{ 28 };
+	std::uniform_real_distribution<float> position{ -40.0f, 40.0f };
+	std::uniform_real_distribution<float> radius{ 0.1f, 3.0f };
+
+	const size_t itemCount = 3001;
+	std::vector<math::Vector<3, float>> positions(itemCount);
+	std::vector<float> radii(itemCount);
+	for (size_t itemIndex = 0; itemIndex < itemCount; ++itemIndex)
+	{
+		positions[itemIndex] = math::Vector<3, float>{ position(random), position(random), position(random) };
+		radii[itemIndex] = radius(random);
+	}
+
+	std::set<std::pair<unsigned int, unsigned int>> expectedPairs;
+	for (unsigned int itemIndexA = 0; itemIndexA < itemCount; ++itemIndexA)
+	{
+		for (unsigned int itemIndexB = itemIndexA + 1; itemIndexB < itemCount; ++itemIndexB)
+		{
+			if (math::IsSphereOverlap(positions[itemIndexA], radii[itemIndexA], positions[itemIndexB], radii[itemIndexB]) == true)
+			{
+				expectedPairs.insert(std::make_pair(itemIndexA, itemIndexB));
+			}
+		}
+	}
+
+	const math::Vector<3, float> queryCenters[3]{ { 1.0f, 2.0f, 3.0f }, { -20.0f, 15.0f, -7.0f }, { 38.0f, -38.0f, 0.0f } };
+	const float queryRadii[3]{ 6.0f, 2.5f, 9.0f };
+
+	std::vector<unsigned int> itemIndices(itemCount);
+	for (const size_t hashTableSize : { static_cast<size_t>(0), static_cast<size_t>(64) })
+	{
+		for (const unsigned int threadCount : { 1u, 3u, 8u })
+		{
+			math::SpatialHashGrid grid{ 2.0f, hashTableSize };
+			grid.Build(positions.data(), radii.data(), itemCount, threadCount);
+
+			std::vector<math::OverlapPair> pairs(grid.FindNeighbourPairs(nullptr, 0));
+			assert(grid.FindNeighbourPairs(pairs.data(), pairs.size()) == pairs.size());
+			assert(pairs.size() == expectedPairs.size() && ToPairSet(pairs) == expectedPairs);
+
+			for (size_t queryIndex = 0; queryIndex < 3; ++queryIndex)
+			{
+				std::set<unsigned int> expectedItemIndices;
+				for (unsigned int itemIndex = 0; itemIndex < itemCount; ++itemIndex)
+				{
+					if (math::IsSphereOverlap(queryCenters[queryIndex], queryRadii[queryIndex], positions[itemIndex], radii[itemIndex]) == true)
+					{
+						expectedItemIndices.insert(itemIndex);
+					}
+				}
+
+				const size_t foundCount = grid.QueryRadius(queryCenters[queryIndex], queryRadii[queryIndex], itemIndices.data(), itemCount);
+				assert(foundCount == expectedItemIndices.size() && ToIndexSet(itemIndices.data(), foundCount) == expectedItemIndices);
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Smallest overlap of projections of two OBBs over all separating axis candidates. Negative when they are separated
+/// </summary>
+float GetOBBSeparatingAxisMargin(const math::OBB& obbA, const math::OBB& obbB)
+{
+	math::Vector<3, float> axes[15];
+	size_t axisCount = 0;
+	for (size_t axisIndex = 0; axisIndex < 3; ++axisIndex)
+	{
+		axes[axisCount++] = obbA.axis(axisIndex);
+		axes[axisCount++] = obbB.axis(axisIndex);
+	}
+	for (size_t axisIndexA = 0; axisIndexA < 3; ++axisIndexA)
+	{
+		for (size_t axisIndexB = 0; axisIndexB < 3; ++axisIndexB)
+		{
+			// parallel edges don't give new axis
+			const math::Vector<3, float> axis = math::cross(obbA.axis(axisIndexA), obbB.axis(axisIndexB));
+			if (math::dot(axis, axis) > 1e-6f)
+			{
+				axes[axisCount++] = axis;
+			}
+		}
+	}
+
+	float margin = math::infinity<float>();
+	for (size_t axisIndex = 0; axisIndex < axisCount; ++axisIndex)
+	{
+		const math::Vector<3, float>& axis = axes[axisIndex];
+		float projectedRadius = 0.0f;
+		for (size_t boxAxisIndex = 0; boxAxisIndex < 3; ++boxAxisIndex)
+		{
+			projectedRadius += std::fabs(math::dot(axis, obbA.axis(boxAxisIndex))) * obbA.halfExtents[boxAxisIndex];
+			projectedRadius += std::fabs(math::dot(axis, obbB.axis(boxAxisIndex))) * obbB.halfExtents[boxAxisIndex];
+		}
+		const float projectedDistance = std::fabs(math::dot(axis, obbB.center - obbA.center));
+		margin = math::Min(margin, (projectedRadius - projectedDistance) / std::sqrt(math::dot(axis, axis)));
+	}
+	return margin;
+}
+
+/// <summary>
+/// OBB overlap should match explicit 15 axis SAT, and batched SIMD test should match scalar test
+/// </summary>
+void TestOBBOverlapMatchesSeparatingAxes()
+{
+	std::mt19937 random{ 33 };
+	std::uniform_real_distribution<float> position{ -6.0f, 6.0f };
+	std::uniform_real_distribution<float> extent{ 0.1f, 1.5f };
+
+	const size_t obbCount = 203;
+	std::vector<math::OBB> obbs(obbCount);
+	std::vector<float> components[15];
+	for (std::vector<float>& component : components)
+	{
+		component.resize(obbCount);
+	}
+	for (size_t obbIndex = 0; obbIndex < obbCount; ++obbIndex)
+	{
+		const math::OBB obb{ math::Vector<3, float>{ position(random), position(random), position(random) }, MakeRandomRotation(random), math::Vector<3, float>{ extent(random), extent(random), extent(random) } };
+		obbs[obbIndex] = obb;
+		for (size_t componentIndex = 0; componentIndex < 3; ++componentIndex)
+		{
+			components[componentIndex][obbIndex] = obb.center[componentIndex];
+			components[3 + componentIndex][obbIndex] = obb.axis(0)[componentIndex];
+			components[6 + componentIndex][obbIndex] = obb.axis(1)[componentIndex];
+			components[9 + componentIndex][obbIndex] = obb.axis(2)[componentIndex];
+			components[12 + componentIndex][obbIndex] = obb.halfExtents[componentIndex];
+		}
+	}
+	const math::OBBArraySoA obbArray{
+		components[0].data(), components[1].data(), components[2].data(),
+		components[3].data(), components[4].data(), components[5].data(),
+		components[6].data(), components[7].data(), components[8].data(),
+		components[9].data(), components[10].data(), components[11].data(),
+		components[12].data(), components[13].data(), components[14].data(),
+		obbCount };
+
+	std::vector<unsigned int> obbIndices(obbCount);
+	for (size_t queryIndex = 0; queryIndex < 40; ++queryIndex)
+	{
+		const math::OBB& obb = obbs[queryIndex];
+		std::set<unsigned int> overlappedIndices;
+		for (unsigned int obbIndex = 0; obbIndex < obbCount; ++obbIndex)
+		{
+			const bool isOverlapped = math::IsOBBOverlap(obb, obbs[obbIndex]);
+			const float margin = GetOBBSeparatingAxisMargin(obb, obbs[obbIndex]);
+			// touching boxes can go either way
+			assert(std::fabs(margin) < 1e-3f || isOverlapped == (margin > 0.0f));
+			if (isOverlapped == true)
+			{
+				overlappedIndices.insert(obbIndex);
+			}
+		}
+
+		const size_t overlappedCount = math::FindOBBOverlaps(obb, obbArray, obbIndices.data(), obbCount);
+		assert(overlappedCount == overlappedIndices.size() && ToIndexSet(obbIndices.data(), overlappedCount) == overlappedIndices);
+	}
+}
+
+/// <summary>
+/// Corners of box centered at origin
+/// </summary>
+struct BoxVertices
+{
+	float x[8];
+	float y[8];
+	float z[8];
+};
+
+BoxVertices MakeBoxVertices(const math::Vector<3, float>& halfExtents)
+{
+	BoxVertices vertices;
+	for (size_t vertexIndex = 0; vertexIndex < 8; ++vertexIndex)
+	{
+		vertices.x[vertexIndex] = ((vertexIndex & 1) != 0) ? halfExtents.x : -halfExtents.x;
+		vertices.y[vertexIndex] = ((vertexIndex & 2) != 0) ? halfExtents.y : -halfExtents.y;
+		vertices.z[vertexIndex] = ((vertexIndex & 4) != 0) ? halfExtents.z : -halfExtents.z;
+	}
+	return vertices;
+}
+
+/// <summary>
+/// GJK distance and EPA penetration of boxes should match closed form for axis aligned boxes, and SAT for rotated boxes
+/// SIMD support vertex search should match scalar scan
+/// </summary>
+void TestConvexHullDistanceAndPenetration()
+{
+	std::mt19937 random{ 34 };
+	std::uniform_real_distribution<float> unit{ -1.0f, 1.0f };
+	std::uniform_real_distribution<float> extent{ 0.2f, 1.2f };
+
+	std::vector<float> x(1001);
+	std::vector<float> y(1001);
+	std::vector<float> z(1001);
+	for (size_t vertexIndex = 0; vertexIndex < x.size(); ++vertexIndex)
+	{
+		x[vertexIndex] = unit(random);
+		y[vertexIndex] = unit(random);
+		z[vertexIndex] = unit(random);
+	}
+	for (size_t vertexCount = 1; vertexCount <= x.size(); vertexCount += 37)
+	{
+		const math::Vector<3, float> direction{ unit(random), unit(random), unit(random) };
+		size_t supportVertexIndex = 0;
+		for (size_t vertexIndex = 1; vertexIndex < vertexCount; ++vertexIndex)
+		{
+			if (x[vertexIndex] * direction.x + y[vertexIndex] * direction.y + z[vertexIndex] * direction.z > x[supportVertexIndex] * direction.x + y[supportVertexIndex] * direction.y + z[supportVertexIndex] * direction.z)
+			{
+				supportVertexIndex = vertexIndex;
+			}
+		}
+		assert(math::FindSupportVertex(x.data(), y.data(), z.data(), vertexCount, direction) == supportVertexIndex);
+	}
+
+	math::GJKCache cache;
+	for (size_t pairIndex = 0; pairIndex < 1000; ++pairIndex)
+	{
+		const math::Vector<3, float> halfExtentsA{ extent(random), extent(random), extent(random) };
+		const math::Vector<3, float> halfExtentsB{ extent(random), extent(random), extent(random) };
+		const math::Vector<3, float> centerA{ unit(random) * 2.0f, unit(random) * 2.0f, unit(random) * 2.0f };
+		const math::Vector<3, float> centerB{ unit(random) * 2.0f, unit(random) * 2.0f, unit(random) * 2.0f };
+		const BoxVertices verticesA = MakeBoxVertices(halfExtentsA);
+		const BoxVertices verticesB = MakeBoxVertices(halfExtentsB);
+
+		// axis aligned boxes. gaps along axes give distance, smallest overlap gives penetration
+		const math::ConvexHull hullA{ verticesA.x, verticesA.y, verticesA.z, 8, math::Matrix<3, 3, float>{ 1.0f }, centerA };
+		const math::ConvexHull hullB{ verticesB.x, verticesB.y, verticesB.z, 8, math::Matrix<3, 3, float>{ 1.0f }, centerB };
+		float squaredGap = 0.0f;
+		float penetrationDepth = math::infinity<float>();
+		for (size_t axisIndex = 0; axisIndex < 3; ++axisIndex)
+		{
+			const float gap = std::fabs(centerB[axisIndex] - centerA[axisIndex]) - halfExtentsA[axisIndex] - halfExtentsB[axisIndex];
+			squaredGap += (gap > 0.0f) ? gap * gap : 0.0f;
+			penetrationDepth = math::Min(penetrationDepth, -gap);
+		}
+
+		const math::GJKResult result = math::ComputeConvexHullPenetration(hullA, hullB);
+		if (squaredGap > 1e-6f)
+		{
+			assert(result.isIntersecting == false && std::fabs(result.distance - std::sqrt(squaredGap)) < 1e-3f);
+		}
+		else if (penetrationDepth > 1e-3f)
+		{
+			assert(result.isIntersecting == true && std::fabs(result.penetrationDepth - penetrationDepth) < 2e-3f);
+		}
+
+		// rotated boxes. penetration depth of boxes is smallest overlap over SAT axes
+		const math::Matrix<3, 3, float> orientationA = static_cast<math::Matrix<3, 3, float>>(MakeRandomRotation(random));
+		const math::Matrix<3, 3, float> orientationB = static_cast<math::Matrix<3, 3, float>>(MakeRandomRotation(random));
+		const math::ConvexHull rotatedHullA{ verticesA.x, verticesA.y, verticesA.z, 8, orientationA, centerA };
+		const math::ConvexHull rotatedHullB{ verticesB.x, verticesB.y, verticesB.z, 8, orientationB, centerB };
+		const float margin = GetOBBSeparatingAxisMargin(math::OBB{ centerA, orientationA, halfExtentsA }, math::OBB{ centerB, orientationB, halfExtentsB });
+
+		const math::GJKResult rotatedResult = math::ComputeConvexHullPenetration(rotatedHullA, rotatedHullB, &cache);
+		const math::GJKResult distanceResult = math::ComputeConvexHullDistance(rotatedHullA, rotatedHullB);
+		if (margin > 1e-3f)
+		{
+			assert(rotatedResult.isIntersecting == true && distanceResult.isIntersecting == true);
+			assert(std::fabs(rotatedResult.penetrationDepth - margin) < 2e-3f);
+		}
+		else if (margin < -1e-3f)
+		{
+			// separating axis gap is lower bound of distance
+			assert(rotatedResult.isIntersecting == false && distanceResult.isIntersecting == false);
+			assert(std::fabs(rotatedResult.distance - distanceResult.distance) < 1e-3f && distanceResult.distance > -margin - 1e-3f);
+		}
+	}
+}
+
+/// <summary>
+/// gap is distance between bodies at time, negative when they overlap
+/// Bodies should touch at time of impact and shouldn't overlap slightly before it
+/// </summary>
+template <typename GetGap>
+void CheckTimeOfImpact(bool isHit, const math::TimeOfImpact& timeOfImpact, const GetGap& getGap)
+{
+	const float tolerance = 1e-3f;
+	if (isHit == true)
+	{
+		assert(timeOfImpact.time >= 0.0f && timeOfImpact.time <= 1.0f);
+		assert(getGap(timeOfImpact.time) <= tolerance);
+		assert(timeOfImpact.time == 0.0f || getGap(math::Max(timeOfImpact.time - tolerance, 0.0f)) >= -tolerance);
+	}
+	else
+	{
+		for (size_t step = 0; step <= 256; ++step)
+		{
+			assert(getGap(static_cast<float>(step) / 256.0f) > -tolerance);
+		}
+	}
+}
+
+/// <summary>
+/// Time of impact of moving sphere and AABB should match closed form gaps along displacement
+/// Earliest hit over arrays should match smallest time of each pair on counts not multiple of 8
+/// </summary>
+void TestTimeOfImpact()
+{
+	std::mt19937 random{ 35 };
+	std::uniform_real_distribution<float> position{ -5.0f, 5.0f };
+	std::uniform_real_distribution<float> size{ 0.1f, 1.5f };
+
+	for (size_t queryIndex = 0; queryIndex < 2000; ++queryIndex)
+	{
+		const math::Vector<3, float> center{ position(random), position(random), position(random) };
+		math::Vector<3, float> displacement{ position(random) * 2.0f, position(random) * 2.0f, position(random) * 2.0f };
+		// static axis
+		if (queryIndex % 7 == 0)
+		{
+			displacement.y = 0.0f;
+		}
+		const float radius = size(random);
+		const math::Vector<3, float> otherCenter{ position(random), position(random), position(random) };
+		const float otherRadius = size(random);
+		const math::Vector<3, float> boxExtents{ size(random), size(random), size(random) };
+		const math::AABB otherAABB{ otherCenter - boxExtents, otherCenter + boxExtents };
+		const math::AABB aabb{ center - radius, center + radius };
+
+		math::TimeOfImpact timeOfImpact;
+		bool isHit = math::ComputeSphereSphereTOI(center, radius, displacement, otherCenter, otherRadius, timeOfImpact);
+		CheckTimeOfImpact(isHit, timeOfImpact, [&](float time) { return std::sqrt((center + displacement * time - otherCenter).sqrMagnitude()) - radius - otherRadius; });
+
+		isHit = math::ComputeSphereAABBTOI(center, radius, displacement, otherAABB, timeOfImpact);
+		CheckTimeOfImpact(isHit, timeOfImpact, [&](float time) { return GetDistanceToAABB(center + displacement * time, otherAABB) - radius; });
+
+		isHit = math::ComputeAABBAABBTOI(aabb, displacement, otherAABB, timeOfImpact);
+		CheckTimeOfImpact(isHit, timeOfImpact, [&](float time)
+		{
+			float gap = math::negativeInfinity<float>();
+			for (size_t axisIndex = 0; axisIndex < 3; ++axisIndex)
+			{
+				const float offset = displacement[axisIndex] * time;
+				gap = math::Max(gap, math::Max(aabb.minimum[axisIndex] + offset - otherAABB.maximum[axisIndex], otherAABB.minimum[axisIndex] - aabb.maximum[axisIndex] - offset));
+			}
+			return gap;
+		});
+	}
+
+	for (size_t count = 1; count <= 37; ++count)
+	{
+		std::vector<float> spheres[4];
+		std::vector<float> boxes[6];
+		for (std::vector<float>& component : spheres)
+		{
+			component.resize(count);
+		}
+		for (std::vector<float>& component : boxes)
+		{
+			component.resize(count);
+		}
+		for (size_t index = 0; index < count; ++index)
+		{
+			const math::Vector<3, float> otherCenter{ position(random), position(random), position(random) };
+			const math::Vector<3, float> extents{ size(random), size(random), size(random) };
+			for (size_t axisIndex = 0; axisIndex < 3; ++axisIndex)
+			{
+				spheres[axisIndex][index] = otherCenter[axisIndex];
+				boxes[axisIndex][index] = otherCenter[axisIndex] - extents[axisIndex];
+				boxes[3 + axisIndex][index] = otherCenter[axisIndex] + extents[axisIndex];
+			}
+			spheres[3][index] = size(random);
+		}
+		const math::SphereArraySoA sphereArray{ spheres[0].data(), spheres[1].data(), spheres[2].data(), spheres[3].data(), count };
+		const math::AABBArraySoA aabbArray{ boxes[0].data(), boxes[1].data(), boxes[2].data(), boxes[3].data(), boxes[4].data(), boxes[5].data(), count };
+
+		const math::Vector<3, float> center{ position(random), position(random), position(random) };
+		math::Vector<3, float> displacement{ position(random) * 2.0f, position(random) * 2.0f, position(random) * 2.0f };
+		if (count % 5 == 0)
+		{
+			displacement.x = 0.0f;
+		}
+		const float radius = size(random) * 0.5f;
+		const math::AABB aabb{ center - radius, center + radius };
+
+		bool isSphereSphereHit = false;
+		bool isSphereAABBHit = false;
+		bool isAABBAABBHit = false;
+		float sphereSphereTime = math::infinity<float>();
+		float sphereAABBTime = math::infinity<float>();
+		float aabbAABBTime = math::infinity<float>();
+		for (size_t index = 0; index < count; ++index)
+		{
+			const math::AABB otherAABB{ math::Vector<3, float>{ boxes[0][index], boxes[1][index], boxes[2][index] }, math::Vector<3, float>{ boxes[3][index], boxes[4][index], boxes[5][index] } };
+			math::TimeOfImpact timeOfImpact;
+			if (math::ComputeSphereSphereTOI(center, radius, displacement, math::Vector<3, float>{ spheres[0][index], spheres[1][index], spheres[2][index] }, spheres[3][index], timeOfImpact) == true)
+			{
+				isSphereSphereHit = true;
+				sphereSphereTime = math::Min(sphereSphereTime, timeOfImpact.time);
+			}
+			if (math::ComputeSphereAABBTOI(center, radius, displacement, otherAABB, timeOfImpact) == true)
+			{
+				isSphereAABBHit = true;
+				sphereAABBTime = math::Min(sphereAABBTime, timeOfImpact.time);
+			}
+			if (math::ComputeAABBAABBTOI(aabb, displacement, otherAABB, timeOfImpact) == true)
+			{
+				isAABBAABBHit = true;
+				aabbAABBTime = math::Min(aabbAABBTime, timeOfImpact.time);
+			}
+		}
+
+		math::TimeOfImpact timeOfImpact;
+		assert(math::FindEarliestSphereSphereTOI(center, radius, displacement, sphereArray, timeOfImpact) == isSphereSphereHit);
+		assert(isSphereSphereHit == false || std::fabs(timeOfImpact.time - sphereSphereTime) < 1e-4f);
+		assert(math::FindEarliestSphereAABBTOI(center, radius, displacement, aabbArray, timeOfImpact) == isSphereAABBHit);
+		assert(isSphereAABBHit == false || std::fabs(timeOfImpact.time - sphereAABBTime) < 1e-4f);
+		assert(math::FindEarliestAABBAABBTOI(aabb, displacement, aabbArray, timeOfImpact) == isAABBAABBHit);
+		assert(isAABBAABBHit == false || std::fabs(timeOfImpact.time - aabbAABBTime) < 1e-4f);
+	}
+}
+
+/// <summary>
+/// Bounding volumes should contain every point and shouldn't depend on thread count
+/// PCA OBB should follow longest axis of elongated cloud
+/// </summary>
+void TestBoundingVolumesContainPoints()
+{
+	std::mt19937 random{ 36 };
+	std::normal_distribution<float> normal{ 0.0f, 1.0f };
+
+	for (const size_t pointCount : { 1, 2, 7, 9, 31, 1000, 100003 })
+	{
+		const math::Matrix<3, 3, float> rotation = static_cast<math::Matrix<3, 3, float>>(MakeRandomRotation(random));
+		std::vector<math::Vector<3, float>> points(pointCount);
+		math::Vector<3, float> minimum{ math::infinity<float>() };
+		math::Vector<3, float> maximum{ math::negativeInfinity<float>() };
+		for (math::Vector<3, float>& point : points)
+		{
+			point = rotation * math::Vector<3, float>{ normal(random) * 5.0f, normal(random) * 2.0f, normal(random) * 0.5f } + math::Vector<3, float>{ 3.0f, -2.0f, 7.0f };
+			minimum = math::Min(minimum, point);
+			maximum = math::Max(maximum, point);
+		}
+
+		for (const unsigned int threadCount : { 1u, 3u, 8u })
+		{
+			const math::AABB aabb = math::ComputeAABB(points.data(), pointCount, threadCount);
+			assert(aabb.minimum == minimum && aabb.maximum == maximum);
+		}
+
+		const math::BoundingSphere sphere = math::ComputeBoundingSphere(points.data(), pointCount, 1);
+		const math::BoundingSphere parallelSphere = math::ComputeBoundingSphere(points.data(), pointCount, 5);
+		assert(parallelSphere.center == sphere.center && parallelSphere.radius == sphere.radius);
+
+		const math::OBB obb = math::ComputePCAOBB(points.data(), pointCount, 4);
+		for (const math::Vector<3, float>& point : points)
+		{
+			assert(std::sqrt((point - sphere.center).sqrMagnitude()) <= sphere.radius * (1.0f + 1e-4f) + 1e-5f);
+			for (size_t axisIndex = 0; axisIndex < 3; ++axisIndex)
+			{
+				assert(std::fabs(math::dot(point - obb.center, obb.axis(axisIndex))) <= obb.halfExtents[axisIndex] + 1e-3f);
+			}
+		}
+
+		if (pointCount >= 1000)
+		{
+			assert(std::fabs(std::fabs(math::dot(obb.axis(0), rotation * math::Vector<3, float>{ 1.0f, 0.0f, 0.0f })) - 1.0f) < 0.01f);
+		}
+	}
+}
+
+/// <summary>
+/// SIMD batch kernels should match their scalar versions on counts that aren't multiple of 8
+/// </summary>
+void TestSIMDKernelsMatchScalarOnTailCounts()
+{
+	std::mt19937 random{ 8 };
+	std::uniform_real_distribution<float> position{ -10.0f, 10.0f };
+	std::uniform_real_distribution<float> size{ 0.1f, 3.0f };
+	std::uniform_real_distribution<float> unit{ -1.0f, 1.0f };
+
+	const math::Matrix<4, 4, float> viewProjectionMatrix =
+		math::perspectiveRH_NO(1.0f, 1.5f, 0.5f, 30.0f) *
+		math::lookAtRH(math::Vector<3, float>{ 0.0f, 0.0f, 15.0f }, math::Vector<3, float>{ 0.0f, 0.0f, 0.0f }, math::Vector<3, float>{ 0.0f, 1.0f, 0.0f });
+	math::Vector<4, float> eightPlanes[8];
+	math::ExtractSIMDPlanesFromViewProjectionMatrix(viewProjectionMatrix, eightPlanes, true);
+	math::Vector<4, float> sixPlanes[6];
+	for (size_t planeIndex = 0; planeIndex < 6; ++planeIndex)
+	{
+		const size_t firstRow = (planeIndex < 4) ? 0 : 4;
+		const size_t lane = (planeIndex < 4) ? planeIndex : planeIndex - 4;
+		sixPlanes[planeIndex] = math::Vector<4, float>{ eightPlanes[firstRow][lane], eightPlanes[firstRow + 1][lane], eightPlanes[firstRow + 2][lane], eightPlanes[firstRow + 3][lane] };
+	}
+
+	// empty packet has no active lane
+	const math::RayPacket8 emptyRayPacket{ nullptr, 0, 1.0f };
+	assert(emptyRayPacket.GetActiveMask() == 0);
+
+	for (size_t count = 0; count <= 19; ++count)
+	{
+		std::vector<math::AABB> aabbs(count);
+		std::vector<float> boxes[6];
+		std::vector<float> worldBoxes[6];
+		std::vector<float> spheres[4];
+		std::vector<math::Vector<4, float>> localSpheres(count);
+		std::vector<math::Matrix<4, 4, float>> worldMatrices(count, math::Matrix<4, 4, float>(1.0f));
+		for (std::vector<float>& component : boxes)
+		{
+			component.resize(count);
+		}
+		for (std::vector<float>& component : worldBoxes)
+		{
+			component.resize(count);
+		}
+		for (std::vector<float>& component : spheres)
+		{
+			component.resize(count);
+		}
+		for (size_t index = 0; index < count; ++index)
+		{
+			const math::Vector<3, float> center{ position(random), position(random), position(random) };
+			const math::Vector<3, float> extents{ size(random), size(random), size(random) };
+			aabbs[index] = math::AABB{ center - extents, center + extents };
+			for (size_t axisIndex = 0; axisIndex < 3; ++axisIndex)
+			{
+				boxes[axisIndex][index] = aabbs[index].minimum[axisIndex];
+				boxes[3 + axisIndex][index] = aabbs[index].maximum[axisIndex];
+				spheres[axisIndex][index] = center[axisIndex];
+			}
+			spheres[3][index] = extents.x * 2.0f;
+			localSpheres[index] = math::Vector<4, float>{ center.x, center.y, center.z, extents.x };
+
+			for (size_t column = 0; column < 3; ++column)
+			{
+				for (size_t row = 0; row < 3; ++row)
+				{
+					worldMatrices[index].columns[column][row] = unit(random);
+				}
+				worldMatrices[index].columns[3][column] = position(random);
+			}
+		}
+		const math::AABBArraySoA aabbArray{ boxes[0].data(), boxes[1].data(), boxes[2].data(), boxes[3].data(), boxes[4].data(), boxes[5].data(), count };
+		const math::SphereArraySoA sphereArray{ spheres[0].data(), spheres[1].data(), spheres[2].data(), spheres[3].data(), count };
+
+		// ray vs AABBs. ray aims at center of last box, which is in scalar tail, and goes through it
+		const math::Vector<3, float> rayOrigin{ position(random), position(random), position(random) };
+		const math::Vector<3, float> rayTarget = (count > 0) ? aabbs[count - 1].center() : math::Vector<3, float>{};
+		const math::Ray ray{ rayOrigin, rayTarget - rayOrigin };
+		const float maxDistance = 3.0f;
+		std::set<unsigned int> rayHits;
+		float closestDistance = math::infinity<float>();
+		for (unsigned int index = 0; index < count; ++index)
+		{
+			float distance;
+			if (math::IsRayHitAABB(ray, maxDistance, aabbs[index], &distance) == true)
+			{
+				rayHits.insert(index);
+				closestDistance = math::Min(closestDistance, distance);
+			}
+		}
+		std::vector<unsigned int> boxIndices(count + 1);
+		const size_t hitCount = math::FindRayAABBHits(ray, maxDistance, aabbArray, boxIndices.data(), count);
+		assert(hitCount == rayHits.size() && ToIndexSet(boxIndices.data(), hitCount) == rayHits);
+		float distance;
+		const unsigned int closestIndex = math::FindClosestRayAABBHit(ray, maxDistance, aabbArray, &distance);
+		assert((closestIndex == math::RAY_INVALID_INDEX) == rayHits.empty());
+		assert(rayHits.empty() == true || (rayHits.count(closestIndex) == 1 && distance == closestDistance));
+
+		// sphere overlap pairs
+		std::set<std::pair<unsigned int, unsigned int>> expectedPairs;
+		std::set<std::pair<unsigned int, unsigned int>> expectedSelfPairs;
+		for (unsigned int indexA = 0; indexA < count; ++indexA)
+		{
+			for (unsigned int indexB = 0; indexB < count; ++indexB)
+			{
+				if (math::IsSphereOverlap(math::Vector<3, float>{ spheres[0][indexA], spheres[1][indexA], spheres[2][indexA] }, spheres[3][indexA], math::Vector<3, float>{ spheres[0][indexB], spheres[1][indexB], spheres[2][indexB] }, spheres[3][indexB]) == true)
+				{
+					expectedPairs.insert(std::make_pair(indexA, indexB));
+					if (indexA < indexB)
+					{
+						expectedSelfPairs.insert(std::make_pair(indexA, indexB));
+					}
+				}
+			}
+		}
+		std::vector<math::OverlapPair> pairs(math::FindSphereOverlapPairs(sphereArray, sphereArray, nullptr, 0));
+		math::FindSphereOverlapPairs(sphereArray, sphereArray, pairs.data(), pairs.size());
+		assert(pairs.size() == expectedPairs.size() && ToPairSet(pairs) == expectedPairs);
+		pairs.resize(math::FindSphereSelfOverlapPairs(sphereArray, nullptr, 0));
+		math::FindSphereSelfOverlapPairs(sphereArray, pairs.data(), pairs.size());
+		assert(pairs.size() == expectedSelfPairs.size() && ToPairSet(pairs) == expectedSelfPairs);
+
+		// world AABBs
+		const math::MutableAABBArraySoA worldAABBArray{ worldBoxes[0].data(), worldBoxes[1].data(), worldBoxes[2].data(), worldBoxes[3].data(), worldBoxes[4].data(), worldBoxes[5].data(), count };
+		math::TransformAABBs(worldMatrices.data(), aabbArray, worldAABBArray);
+		for (size_t index = 0; index < count; ++index)
+		{
+			const math::AABB worldAABB = math::TransformAABB(worldMatrices[index], aabbs[index]);
+			for (size_t axisIndex = 0; axisIndex < 3; ++axisIndex)
+			{
+				assert(std::fabs(worldBoxes[axisIndex][index] - worldAABB.minimum[axisIndex]) < 1e-4f);
+				assert(std::fabs(worldBoxes[3 + axisIndex][index] - worldAABB.maximum[axisIndex]) < 1e-4f);
+			}
+		}
+
+		// world spheres and frustum culling
+		std::vector<math::SphereBlock8> sphereBlocks(math::GetSphereBlockCount(count));
+		math::TransformSpheres(worldMatrices.data(), localSpheres.data(), count, sphereBlocks.data());
+		std::vector<unsigned char> visibleMasks(sphereBlocks.size());
+		const size_t visibleCount = math::CullSphereBlocks(eightPlanes, sphereBlocks.data(), sphereBlocks.size(), visibleMasks.data());
+		size_t expectedVisibleCount = 0;
+		for (size_t index = 0; index < count; ++index)
+		{
+			const math::SphereBlock8& block = sphereBlocks[index / 8];
+			const size_t lane = index % 8;
+			const math::Vector<4, float> worldCenter = worldMatrices[index] * math::Vector<4, float>{ localSpheres[index].x, localSpheres[index].y, localSpheres[index].z, 1.0f };
+			const float worldRadius = localSpheres[index].w * math::GetMaxAxisScale(worldMatrices[index]);
+			assert(std::fabs(block.centerX[lane] - worldCenter.x) < 1e-4f && std::fabs(block.centerY[lane] - worldCenter.y) < 1e-4f && std::fabs(block.centerZ[lane] - worldCenter.z) < 1e-4f);
+			assert(std::fabs(block.radius[lane] - worldRadius) < 1e-4f);
+
+			bool isVisible = true;
+			for (const math::Vector<4, float>& plane : sixPlanes)
+			{
+				if (plane.x * block.centerX[lane] + plane.y * block.centerY[lane] + plane.z * block.centerZ[lane] + plane.w < -block.radius[lane])
+				{
+					isVisible = false;
+				}
+			}
+			assert(isVisible == (((visibleMasks[index / 8] >> lane) & 1) != 0));
+			expectedVisibleCount += (isVisible == true) ? 1 : 0;
+		}
+		assert(visibleCount == expectedVisibleCount);
+		// padding lanes are never visible
+		assert(count % 8 == 0 || (visibleMasks.back() >> (count % 8)) == 0);
+	}
+}
+
 int main()
 {
+	TestRayMissWithInfiniteDistance();
+	TestSweepAndPruneEvents();
+	TestProjectedSphereBehindEye();
+	TestOccluderCrossingNearPlane();
+	TestBVHMatchesLinearScan();
+	TestSpatialHashGridMatchesBruteForce();
+	TestOBBOverlapMatchesSeparatingAxes();
+	TestConvexHullDistanceAndPenetration();
+	TestTimeOfImpact();
+	TestBoundingVolumesContainPoints();
+	TestSIMDKernelsMatchScalarOnTailCounts();
+
 	std::thread thread1{ print, 1 };
 	std::thread thread2{ print, 2 };
 